@@ -0,0 +1,287 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#include "ada.hh"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+// Number of columns read or written at once
+static const int s_blockColumns = 64;
+
+// Size of the square tiles used to transpose blocks
+static const int s_tileSize = 64;
+
+CAdaFile::CAdaFile() : m_data(), m_progressHandler() { }
+
+CAdaFile::~CAdaFile() { }
+
+cv::Mat CAdaFile::data() const
+{
+    return m_data;
+}
+
+void CAdaFile::setData(const cv::Mat& p_mat)
+{
+    m_data = p_mat;
+}
+
+int CAdaFile::storageDepth(const int p_depth)
+{
+    // Single precision floats have always been serialized as doubles (QDataStream::DoublePrecision)
+    return (p_depth == CV_32F) ? CV_64F : p_depth;
+}
+
+void CAdaFile::swapBytes(void* p_data, const size_t p_count, const size_t p_size)
+{
+    // ADA files are big-endian: this is a no-op on big-endian hosts
+    switch (p_size)
+    {
+        case 2:
+            qFromBigEndian<quint16>(p_data, static_cast<qsizetype>(p_count), p_data);
+            break;
+
+        case 4:
+            qFromBigEndian<quint32>(p_data, static_cast<qsizetype>(p_count), p_data);
+            break;
+
+        case 8:
+            qFromBigEndian<quint64>(p_data, static_cast<qsizetype>(p_count), p_data);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void CAdaFile::transposeTiles(const cv::Mat& p_src, cv::Mat& p_dst)
+{
+    // p_dst already has the transposed size: transpose each tile into its destination ROI
+    for (int r = 0; r < p_src.rows; r += s_tileSize)
+    {
+        const cv::Range srcRows(r, std::min(r + s_tileSize, p_src.rows));
+        for (int c = 0; c < p_src.cols; c += s_tileSize)
+        {
+            const cv::Range srcCols(c, std::min(c + s_tileSize, p_src.cols));
+            cv::Mat tile = p_dst(srcCols, srcRows);
+            cv::transpose(p_src(srcRows, srcCols), tile);
+        }
+    }
+}
+
+void CAdaFile::setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler)
+{
+    m_progressHandler = p_handler;
+}
+
+bool CAdaFile::readHeader(QFile& p_file, int& p_rows, int& p_cols, int& p_type)
+{
+    char header[10];
+    if (p_file.read(header, sizeof(header)) != sizeof(header))
+    {
+        qWarning() << "Can't read ADA header from:" << p_file.fileName();
+        return false;
+    }
+
+    const qint32 columns = qFromBigEndian<qint32>(header);
+    const qint32 rows    = qFromBigEndian<qint32>(header + 4);
+    const qint8 type     = static_cast<qint8>(header[8]);
+    const qint8 channels = static_cast<qint8>(header[9]);
+
+    const int depth = CV_MAT_DEPTH(type);
+    const int cn    = (channels > 0) ? channels : CV_MAT_CN(type);
+    if (rows <= 0 || columns <= 0 || cn > CV_CN_MAX)
+    {
+        qWarning() << "Invalid ADA header in:" << p_file.fileName();
+        qWarning() << "-- columns:" << columns << "rows:" << rows << "type:" << type << "channels:" << channels;
+        return false;
+    }
+
+    p_rows = rows;
+    p_cols = columns;
+    p_type = CV_MAKETYPE(depth, cn);
+    return true;
+}
+
+bool CAdaFile::probe(const QString& p_path, CMatrixInfo& p_info)
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't read matrix from:" << file.fileName();
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    int rows = 0, columns = 0, type = 0;
+    if (!readHeader(file, rows, columns, type))
+    {
+        return false;
+    }
+
+    p_info.setSize(rows, columns);
+    p_info.setType(type);
+    return true;
+}
+
+bool CAdaFile::read(const QString& p_path)
+{
+    m_data.release();
+
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't read matrix from:" << file.fileName();
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    try
+    {
+        int rows = 0, columns = 0, type = 0;
+        if (!readHeader(file, rows, columns, type))
+        {
+            return false;
+        }
+
+        const int cn          = CV_MAT_CN(type);
+        const int storageType = CV_MAKETYPE(storageDepth(CV_MAT_DEPTH(type)), cn);
+        const qint64 expected = 10 + static_cast<qint64>(rows) * columns * CV_ELEM_SIZE(storageType);
+        if (file.size() < expected)
+        {
+            qWarning() << "Can't read ADA matrix from:" << file.fileName();
+            qWarning() << "-- error: file is truncated (expected" << expected << "bytes, got" << file.size() << ")";
+            return false;
+        }
+
+        m_data.create(rows, columns, type);
+
+        // Each block row holds a whole column of the matrix
+        cv::Mat block(s_blockColumns, rows, storageType);
+        cv::Mat converted;
+        for (int c = 0; c < columns; c += s_blockColumns)
+        {
+            const int count     = std::min(s_blockColumns, columns - c);
+            cv::Mat columnBlock = block.rowRange(0, count);
+
+            const qint64 size = static_cast<qint64>(columnBlock.total() * columnBlock.elemSize());
+            if (file.read(reinterpret_cast<char*>(columnBlock.data), size) != size)
+            {
+                qWarning() << "Can't read ADA matrix from:" << file.fileName();
+                qWarning() << "-- error:" << file.errorString();
+                m_data.release();
+                return false;
+            }
+
+            swapBytes(columnBlock.data, columnBlock.total() * cn, columnBlock.elemSize1());
+
+            if (storageType != m_data.type())
+            {
+                columnBlock.convertTo(converted, m_data.type());
+                columnBlock = converted;
+            }
+
+            cv::Mat dst = m_data.colRange(c, c + count);
+            transposeTiles(columnBlock, dst);
+
+            if (m_progressHandler && !m_progressHandler(file.pos(), file.size()))
+            {
+                m_data.release();
+                return false;
+            }
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "OpenCV error while reading ADA matrix";
+        qWarning() << "file: " << p_path;
+        qWarning() << "error: " << e.what();
+        m_data.release();
+        return false;
+    }
+
+    return true;
+}
+
+bool CAdaFile::write(const QString& p_path) const
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Can't write matrix as:" << file.fileName();
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    try
+    {
+        const int columns     = m_data.cols;
+        const int rows        = m_data.rows;
+        const int cn          = m_data.channels();
+        const int storageType = CV_MAKETYPE(storageDepth(m_data.depth()), cn);
+
+        char header[10];
+        qToBigEndian<qint32>(columns, header);
+        qToBigEndian<qint32>(rows, header + 4);
+        header[8] = static_cast<char>(m_data.type());
+        header[9] = static_cast<char>(cn);
+        if (file.write(header, sizeof(header)) != sizeof(header))
+        {
+            qWarning() << "Can't write matrix as:" << file.fileName();
+            qWarning() << "-- error:" << file.errorString();
+            return false;
+        }
+
+        cv::Mat block(s_blockColumns, rows, m_data.type());
+        cv::Mat converted;
+        for (int c = 0; c < columns; c += s_blockColumns)
+        {
+            const int count     = std::min(s_blockColumns, columns - c);
+            cv::Mat columnBlock = block.rowRange(0, count);
+
+            transposeTiles(m_data.colRange(c, c + count), columnBlock);
+
+            if (storageType != m_data.type())
+            {
+                columnBlock.convertTo(converted, storageType);
+                columnBlock = converted;
+            }
+
+            // swapping back from big-endian is the same permutation as swapping to it
+            swapBytes(columnBlock.data, columnBlock.total() * cn, columnBlock.elemSize1());
+
+            const qint64 size = static_cast<qint64>(columnBlock.total() * columnBlock.elemSize());
+            if (file.write(reinterpret_cast<const char*>(columnBlock.data), size) != size)
+            {
+                qWarning() << "Can't write matrix as:" << file.fileName();
+                qWarning() << "-- error:" << file.errorString();
+                return false;
+            }
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "OpenCV error while writing ADA matrix";
+        qWarning() << "file: " << p_path;
+        qWarning() << "error: " << e.what();
+        return false;
+    }
+
+    return true;
+}
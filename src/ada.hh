@@ -0,0 +1,73 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include "matrix-info.hh"
+
+#include <QString>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+class QFile;
+
+/**
+ * @class CAdaFile
+ * @brief File format for ADA matrices
+ *
+ * An ADA file has the following content, in big-endian byte order:
+ *
+ *  \li header (int32 columns, int32 rows, int8 OpenCV type, int8 channels)
+ *  \li data   (matrix values in column-major order, channels interleaved)
+ *
+ * Values are stored with the size of their depth,
+ * except single precision floats that are stored as doubles.
+ *
+ * Values are read and written by blocks of whole columns:
+ * each block is byte-swapped at once and transposed by cache-sized tiles
+ * from/to the row-major cv::Mat.
+ */
+class CAdaFile
+{
+public:
+    CAdaFile();
+    ~CAdaFile();
+
+    cv::Mat data() const;
+    void setData(const cv::Mat& p_mat);
+
+    bool read(const QString& p_path);
+    bool write(const QString& p_path) const;
+
+    /// Reads the dimensions and type of the matrix stored in \a p_path without reading its values.
+    static bool probe(const QString& p_path, CMatrixInfo& p_info);
+
+    /// Sets the function called with the number of bytes read and the file size during read(): returning false cancels the read.
+    void setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler);
+
+private:
+    static bool readHeader(QFile& p_file, int& p_rows, int& p_cols, int& p_type);
+
+    static int storageDepth(const int p_depth);
+    static void swapBytes(void* p_data, const size_t p_count, const size_t p_size);
+    static void transposeTiles(const cv::Mat& p_src, cv::Mat& p_dst);
+
+private:
+    cv::Mat m_data;
+    std::function<bool(qint64, qint64)> m_progressHandler;
+};
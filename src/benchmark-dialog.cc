@@ -29,6 +29,7 @@
 #include <QCheckBox>
 #include <QDebug>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFormLayout>
@@ -46,7 +47,10 @@ CBenchmarkDialog::CBenchmarkDialog(QWidget *p_parent)
     , m_progressBar(new CProgressBar)
     , m_operations()
     , m_iterations(new QSpinBox)
+    , m_warmup(new QSpinBox)
+    , m_precision(new QDoubleSpinBox)
     , m_report(new QTextEdit)
+    , m_results()
     , m_savePath(QDir::homePath())
     , m_cancelRequested(false)
     , m_progress(0)
@@ -63,8 +67,24 @@ CBenchmarkDialog::CBenchmarkDialog(QWidget *p_parent)
     m_iterations->setMinimum(1);
     m_iterations->setMaximum(1000);
 
+    m_warmup->setValue(1);
+    m_warmup->setMinimum(0);
+    m_warmup->setMaximum(100);
+    m_warmup->setToolTip(tr("Number of unmeasured iterations run before the measured ones"));
+
+    m_precision->setRange(0, 50);
+    m_precision->setDecimals(1);
+    m_precision->setSingleStep(0.5);
+    m_precision->setSuffix(" %");
+    m_precision->setSpecialValueText(tr("Fixed iterations"));
+    m_precision->setValue(0);
+    m_precision->setToolTip(tr("Run iterations until the 95% confidence interval of the mean is within this percentage of the mean.\n"
+                               "The number of iterations is then a maximum."));
+
     QFormLayout *parametersLayout = new QFormLayout;
     parametersLayout->addRow(tr("Iterations:"), m_iterations);
+    parametersLayout->addRow(tr("Warmup:"), m_warmup);
+    parametersLayout->addRow(tr("Precision:"), m_precision);
 
     // Checkbox list of operations
     const QList<Operation> &benchmarkOperations = Operation::list_benchmark();
@@ -110,8 +130,13 @@ CBenchmarkDialog::CBenchmarkDialog(QWidget *p_parent)
     QPushButton *exportButton = new QPushButton(tr("&Export"));
     connect(exportButton, SIGNAL(clicked()), this, SLOT(save()));
 
+    QPushButton *compareButton = new QPushButton(tr("&Compare..."));
+    compareButton->setToolTip(tr("Compare the results with a baseline report exported in JSON"));
+    connect(compareButton, SIGNAL(clicked()), this, SLOT(compare()));
+
     QDialogButtonBox *buttons = new QDialogButtonBox;
     buttons->addButton(exportButton, QDialogButtonBox::ActionRole);
+    buttons->addButton(compareButton, QDialogButtonBox::ActionRole);
     buttons->addButton(runButton, QDialogButtonBox::ApplyRole);
 
     QBoxLayout *operationsLayout = new QVBoxLayout;
@@ -157,6 +182,8 @@ CBenchmarkDialog::~CBenchmarkDialog()
     }
 
     delete m_iterations;
+    delete m_warmup;
+    delete m_precision;
     delete m_report;
 
     delete m_progressBar;
@@ -205,6 +232,8 @@ void CBenchmarkDialog::run()
     m_report->clear();
     addHeaderInfo();
 
+    m_results.reset(m_iterations->value(), m_warmup->value(), m_precision->value() / 100.0, true);
+
     m_progress = 0;
 
     // Ensure that dataChanged is not emitted
@@ -216,6 +245,8 @@ void CBenchmarkDialog::run()
         if (!m_cancelRequested && checkBox->isChecked())
         {
             BenchmarkTask task(checkBox->text(), m_iterations->value(), model());
+            task.setWarmup(m_warmup->value());
+            task.setPrecision(m_precision->value() / 100.0);
 
             connect(&task, SIGNAL(resultReady(const BenchmarkResult &)), this, SLOT(processResult(const BenchmarkResult &)));
 
@@ -244,6 +275,8 @@ void CBenchmarkDialog::processResult(const BenchmarkResult &p_result)
     }
 
     m_report->append(p_result.timeStr());
+
+    m_results.addResult(p_result, model()->filePath(), model());
 }
 
 void CBenchmarkDialog::cancel()
@@ -325,7 +358,10 @@ void CBenchmarkDialog::addHeaderInfo()
     m_report->append(modelInfo);
 
     QString benchmarkInfo =
-        tr("Benchmark: %1 operations (%2 iterations)").arg(QString::number(countOperations())).arg(QString::number(m_iterations->value()));
+        tr("Benchmark: %1 operations (%2 iterations, %3 warmup)")
+            .arg(QString::number(countOperations()))
+            .arg(QString::number(m_iterations->value()))
+            .arg(QString::number(m_warmup->value()));
 
     m_report->append(benchmarkInfo);
 
@@ -334,7 +370,10 @@ void CBenchmarkDialog::addHeaderInfo()
 
 void CBenchmarkDialog::save()
 {
-    QString filename = QFileDialog::getSaveFileName(nullptr, tr("Save benchmark report"), m_savePath, tr("Data files (*.txt *.html)"));
+    QString filename = QFileDialog::getSaveFileName(nullptr,
+                                                    tr("Save benchmark report"),
+                                                    m_savePath,
+                                                    tr("Benchmark reports (*.json *.csv);;Data files (*.txt *.html)"));
     QFileInfo fi(filename);
     if (filename.isEmpty())
     {
@@ -342,19 +381,84 @@ void CBenchmarkDialog::save()
     }
 
     m_savePath = fi.absolutePath();
-    QFile file(filename);
-    if (file.open(QFile::WriteOnly | QFile::Truncate))
+    if (fi.suffix() == "json" || fi.suffix() == "csv")
     {
-        QTextStream out(&file);
-        if (fi.completeSuffix() == "html")
-        {
-            out << m_report->toHtml();
-        }
-        else
+        m_results.save(filename);
+    }
+    else
+    {
+        QFile file(filename);
+        if (file.open(QFile::WriteOnly | QFile::Truncate))
         {
-            out << m_report->toPlainText();
+            QTextStream out(&file);
+            if (fi.completeSuffix() == "html")
+            {
+                out << m_report->toHtml();
+            }
+            else
+            {
+                out << m_report->toPlainText();
+            }
         }
     }
 
     writeSettings(); //update savePath
 }
+
+void CBenchmarkDialog::compare()
+{
+    if (m_results.isEmpty())
+    {
+        m_report->append(tr("<b>Run the benchmark before comparing it with a baseline</b>"));
+        return;
+    }
+
+    QString filename = QFileDialog::getOpenFileName(nullptr, tr("Open baseline report"), m_savePath, tr("Benchmark reports (*.json)"));
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    CBenchmarkReport baseline;
+    if (!baseline.load(filename))
+    {
+        m_report->append(tr("<b>Invalid baseline report %1</b>").arg(filename));
+        return;
+    }
+
+    m_tabs->setCurrentIndex(1);
+
+    const QJsonObject environment = baseline.environment();
+    m_report->append(QString("-----------------------------------------------------------"));
+    m_report->append(tr("<b>Comparison with baseline %1</b>").arg(QFileInfo(filename).fileName()));
+    m_report->append(tr("Baseline: %1 %2, OpenCV %3, %4 %5 (%6), %7 threads on %8")
+                         .arg(environment["application"].toString())
+                         .arg(environment["version"].toString())
+                         .arg(environment["opencv"].toString())
+                         .arg(environment["compiler"].toString())
+                         .arg(environment["buildType"].toString())
+                         .arg(environment["compileOptions"].toString())
+                         .arg(environment["threads"].toInt())
+                         .arg(environment["host"].toString()));
+
+    const QVector<CBenchmarkReport::Comparison> comparisons = m_results.compare(baseline);
+    foreach (const CBenchmarkReport::Comparison &comparison, comparisons)
+    {
+        const QString line = comparison.toString().toHtmlEscaped();
+        switch (comparison.verdict)
+        {
+            case CBenchmarkReport::Regression:
+                m_report->append(QString("<span style=\"color:#cc0000\">%1</span>").arg(line));
+                break;
+
+            case CBenchmarkReport::Improvement:
+                m_report->append(QString("<span style=\"color:#4e9a06\">%1</span>").arg(line));
+                break;
+
+            default:
+                m_report->append(line);
+                break;
+        }
+    }
+    m_results.setComparisons(comparisons);
+}
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "benchmark-report.hh"
 #include "benchmark-result.hh"
 
 #include <QDebug>
@@ -26,6 +27,7 @@
 
 class QTabWidget;
 class QCheckBox;
+class QDoubleSpinBox;
 class QSpinBox;
 class QTextEdit;
 
@@ -60,6 +62,7 @@ public slots:
 
     void cancel();
     void save();
+    void compare();
 
     void selectAll();
     void unselectAll();
@@ -79,7 +82,10 @@ private:
     CProgressBar *m_progressBar;
     QList<QCheckBox *> m_operations;
     QSpinBox *m_iterations;
+    QSpinBox *m_warmup;
+    QDoubleSpinBox *m_precision;
     QTextEdit *m_report;
+    CBenchmarkReport m_results;
     QString m_savePath;
     bool m_cancelRequested;
     int m_progress;
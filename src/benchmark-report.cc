@@ -0,0 +1,485 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "benchmark-report.hh"
+
+#include "benchmark-result.hh"
+#include "config.hh"
+#include "matrix-model.hh"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QObject>
+#include <QPair>
+#include <QSysInfo>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+static QString csvField(const QString &p_value)
+{
+    if (!p_value.contains(',') && !p_value.contains('"') && !p_value.contains('\n'))
+    {
+        return p_value;
+    }
+
+    QString value = p_value;
+    return QString("\"%1\"").arg(value.replace("\"", "\"\""));
+}
+
+static QString durationStr(const double p_ns)
+{
+    if (p_ns > 1e9)
+    {
+        return QString("%1 s").arg(p_ns / 1e9);
+    }
+    if (p_ns > 1e6)
+    {
+        return QString("%1 ms").arg(p_ns / 1e6);
+    }
+    if (p_ns > 1e3)
+    {
+        return QString("%1 µs").arg(p_ns / 1e3);
+    }
+    return QString("%1 ns").arg(p_ns);
+}
+
+static QString matrixStr(const QJsonObject &p_result)
+{
+    return QString("%1 x %2 %3").arg(p_result["rows"].toInt()).arg(p_result["cols"].toInt()).arg(p_result["type"].toString());
+}
+
+/// Results of two reports are compared when they are about the same operation on the same kind of matrix
+static QString resultKey(const QJsonObject &p_result)
+{
+    return QString("%1|%2|%3").arg(QFileInfo(p_result["file"].toString()).fileName()).arg(matrixStr(p_result)).arg(p_result["operation"].toString());
+}
+
+static QVector<double> resultSamples(const QJsonObject &p_result)
+{
+    QVector<double> samples;
+    foreach (const QJsonValue &value, p_result["samples"].toArray())
+    {
+        samples << value.toDouble();
+    }
+    return samples;
+}
+
+double CBenchmarkReport::Comparison::change() const
+{
+    return (baselineMedian > 0) ? currentMedian / baselineMedian - 1 : 0;
+}
+
+QString CBenchmarkReport::Comparison::verdictStr() const
+{
+    switch (verdict)
+    {
+        case Unchanged:
+            return "unchanged";
+
+        case Improvement:
+            return "improvement";
+
+        case Regression:
+            return "regression";
+
+        case New:
+            return "new";
+    }
+
+    return QString();
+}
+
+QString CBenchmarkReport::Comparison::toString() const
+{
+    if (verdict == New)
+    {
+        return QObject::tr("%1 on %2 (%3): %4, not in baseline").arg(operation).arg(file).arg(matrix).arg(durationStr(currentMedian));
+    }
+
+    return QObject::tr("%1 on %2 (%3): %4 -> %5 (%6%7%), adjusted p = %8: %9")
+        .arg(operation)
+        .arg(file)
+        .arg(matrix)
+        .arg(durationStr(baselineMedian))
+        .arg(durationStr(currentMedian))
+        .arg(change() >= 0 ? "+" : "")
+        .arg(change() * 100, 0, 'f', 1)
+        .arg(adjustedPValue, 0, 'g', 3)
+        .arg(verdictStr());
+}
+
+QJsonObject CBenchmarkReport::Comparison::toJson() const
+{
+    QJsonObject comparison;
+    comparison["file"]      = file;
+    comparison["matrix"]    = matrix;
+    comparison["operation"] = operation;
+    comparison["verdict"]   = verdictStr();
+    comparison["current"]   = currentMedian;
+    if (verdict != New)
+    {
+        comparison["baseline"]       = baselineMedian;
+        comparison["change"]         = change();
+        comparison["pValue"]         = pValue;
+        comparison["adjustedPValue"] = adjustedPValue;
+    }
+    return comparison;
+}
+
+CBenchmarkReport::CBenchmarkReport() : m_environment(), m_results(), m_comparisons() { }
+
+CBenchmarkReport::~CBenchmarkReport() { }
+
+void CBenchmarkReport::reset(const int p_iterations, const int p_warmup, const double p_precision, const bool p_isCacheFlushed)
+{
+    m_environment = QJsonObject();
+    m_results     = QJsonArray();
+    m_comparisons = QJsonArray();
+
+    m_environment["application"]    = QCoreApplication::applicationName();
+    m_environment["version"]        = QCoreApplication::applicationVersion();
+    m_environment["commit"]         = QString(PROJECT_COMMIT_DESCRIBE);
+    m_environment["compiler"]       = QString(PROJECT_COMPILER);
+    m_environment["buildType"]      = QString(PROJECT_BUILD_TYPE);
+    m_environment["compileOptions"] = QString(PROJECT_COMPILE_OPTIONS);
+    m_environment["opencv"]         = QString(CV_VERSION);
+    m_environment["qt"]             = QString(qVersion());
+    m_environment["host"]           = QSysInfo::machineHostName();
+    m_environment["os"]             = QSysInfo::prettyProductName();
+    m_environment["cpu"]            = QSysInfo::currentCpuArchitecture();
+    m_environment["cpuFeatures"]    = QString::fromStdString(cv::getCPUFeaturesLine());
+    m_environment["threads"]        = cv::getNumThreads();
+    m_environment["date"]           = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    m_environment["iterations"]     = p_iterations;
+    m_environment["warmup"]         = p_warmup;
+    m_environment["precision"]      = p_precision;
+    m_environment["cacheFlush"]     = p_isCacheFlushed;
+    m_environment["unit"]           = QString("ns");
+}
+
+void CBenchmarkReport::addResult(const BenchmarkResult &p_result, const QString &p_filePath, const CMatrixModel *p_model)
+{
+    QJsonObject result;
+    result["file"]      = p_filePath;
+    result["rows"]      = p_model->rowCount();
+    result["cols"]      = p_model->columnCount();
+    result["type"]      = QString("%1C%2").arg(p_model->typeString()).arg(p_model->channels());
+    result["operation"] = p_result.title();
+    result["status"]    = p_result.statusStr();
+
+    if (p_result.status() == BenchmarkResult::Success)
+    {
+        QJsonArray samples;
+        foreach (const qint64 ns, p_result.samples())
+        {
+            samples.append(static_cast<double>(ns));
+        }
+
+        result["iterations"] = p_result.samples().size();
+        result["warmup"]     = p_result.warmup();
+        result["outliers"]   = p_result.outliers();
+        result["min"]        = p_result.nsMin();
+        result["max"]        = p_result.nsMax();
+        result["mean"]       = p_result.nsAvg();
+        result["confidence"] = p_result.nsConfidence();
+        result["stddev"]     = p_result.nsStdDev();
+        result["median"]     = p_result.nsMedian();
+        result["p90"]        = p_result.nsP90();
+        result["p99"]        = p_result.nsP99();
+        result["samples"]    = samples;
+    }
+
+    m_results.append(result);
+}
+
+bool CBenchmarkReport::isEmpty() const
+{
+    return m_results.isEmpty();
+}
+
+const QJsonObject &CBenchmarkReport::environment() const
+{
+    return m_environment;
+}
+
+const QJsonArray &CBenchmarkReport::results() const
+{
+    return m_results;
+}
+
+QByteArray CBenchmarkReport::toJson() const
+{
+    QJsonObject report = m_environment;
+    report["results"]  = m_results;
+    if (!m_comparisons.isEmpty())
+    {
+        report["comparison"] = m_comparisons;
+    }
+
+    return QJsonDocument(report).toJson(QJsonDocument::Indented);
+}
+
+QByteArray CBenchmarkReport::toCsv() const
+{
+    // one line per measured iteration, failed operations have no sample
+    QByteArray csv("file,rows,cols,type,operation,status,iteration,ns\n");
+
+    foreach (const QJsonValue &value, m_results)
+    {
+        const QJsonObject result = value.toObject();
+        const QString prefix     = QString("%1,%2,%3,%4,%5,%6")
+                                   .arg(csvField(result["file"].toString()))
+                                   .arg(result["rows"].toInt())
+                                   .arg(result["cols"].toInt())
+                                   .arg(result["type"].toString())
+                                   .arg(result["operation"].toString())
+                                   .arg(result["status"].toString());
+
+        const QJsonArray samples = result["samples"].toArray();
+        if (samples.isEmpty())
+        {
+            csv += QString("%1,,\n").arg(prefix).toUtf8();
+            continue;
+        }
+
+        for (int i = 0; i < samples.size(); ++i)
+        {
+            csv += QString("%1,%2,%3\n").arg(prefix).arg(i).arg(static_cast<qint64>(samples[i].toDouble())).toUtf8();
+        }
+    }
+
+    return csv;
+}
+
+bool CBenchmarkReport::save(const QString &p_path) const
+{
+    const QByteArray report = p_path.endsWith(".csv", Qt::CaseInsensitive) ? toCsv() : toJson();
+
+    QFile file(p_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(report) != report.size())
+    {
+        qWarning() << "Can't save benchmark report:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool CBenchmarkReport::load(const QString &p_path)
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't open benchmark report:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (!document.isObject() || !document.object()["results"].isArray())
+    {
+        qWarning() << "Invalid benchmark report:" << p_path;
+        qWarning() << "-- error:" << error.errorString();
+        return false;
+    }
+
+    m_environment = document.object();
+    m_environment.remove("results");
+    m_environment.remove("comparison");
+    m_results     = document.object()["results"].toArray();
+    m_comparisons = QJsonArray();
+
+    return true;
+}
+
+QVector<CBenchmarkReport::Comparison> CBenchmarkReport::compare(const CBenchmarkReport &p_baseline,
+                                                                const double p_alpha,
+                                                                const double p_threshold) const
+{
+    QHash<QString, QJsonObject> baseline;
+    foreach (const QJsonValue &value, p_baseline.results())
+    {
+        const QJsonObject result = value.toObject();
+        if (result["status"].toString() == "success")
+        {
+            baseline.insert(resultKey(result), result);
+        }
+    }
+
+    QVector<Comparison> comparisons;
+    QVector<double> shifts;
+    foreach (const QJsonValue &value, m_results)
+    {
+        const QJsonObject result = value.toObject();
+        if (result["status"].toString() != "success")
+        {
+            continue;
+        }
+
+        Comparison comparison;
+        comparison.file           = QFileInfo(result["file"].toString()).fileName();
+        comparison.matrix         = matrixStr(result);
+        comparison.operation      = result["operation"].toString();
+        comparison.baselineMedian = 0;
+        comparison.currentMedian  = result["median"].toDouble();
+        comparison.pValue         = 1;
+        comparison.adjustedPValue = 1;
+        comparison.verdict        = New;
+
+        double shift      = 0;
+        const QString key = resultKey(result);
+        if (baseline.contains(key))
+        {
+            const QJsonObject reference = baseline.value(key);
+
+            comparison.baselineMedian = reference["median"].toDouble();
+            comparison.pValue         = mannWhitney(resultSamples(result), resultSamples(reference), &shift);
+            comparison.verdict        = Unchanged;
+        }
+
+        comparisons << comparison;
+        shifts << shift;
+    }
+
+    // Holm-Bonferroni: the k-th smallest of the m p-values is multiplied by (m - k),
+    // keeping the adjusted p-values monotonic
+    QVector<int> tested;
+    for (int i = 0; i < comparisons.size(); ++i)
+    {
+        if (comparisons[i].verdict != New)
+        {
+            tested << i;
+        }
+    }
+    std::sort(tested.begin(),
+              tested.end(),
+              [&comparisons](const int p_first, const int p_second) { return comparisons[p_first].pValue < comparisons[p_second].pValue; });
+
+    double adjusted = 0;
+    for (int k = 0; k < tested.size(); ++k)
+    {
+        Comparison &comparison = comparisons[tested[k]];
+        adjusted               = qMax(adjusted, qMin(1.0, (tested.size() - k) * comparison.pValue));
+
+        comparison.adjustedPValue = adjusted;
+        if (adjusted >= p_alpha)
+        {
+            continue;
+        }
+
+        // significant changes are only reported when they are large enough to matter
+        if (shifts[tested[k]] > 0 && comparison.change() >= p_threshold)
+        {
+            comparison.verdict = Regression;
+        }
+        else if (shifts[tested[k]] < 0 && comparison.change() <= -p_threshold)
+        {
+            comparison.verdict = Improvement;
+        }
+    }
+
+    return comparisons;
+}
+
+void CBenchmarkReport::setComparisons(const QVector<Comparison> &p_comparisons)
+{
+    m_comparisons = QJsonArray();
+    foreach (const Comparison &comparison, p_comparisons)
+    {
+        m_comparisons.append(comparison.toJson());
+    }
+}
+
+double CBenchmarkReport::mannWhitney(const QVector<double> &p_first, const QVector<double> &p_second, double *p_shift)
+{
+    const int n1 = p_first.size();
+    const int n2 = p_second.size();
+    const int n  = n1 + n2;
+
+    if (p_shift != nullptr)
+    {
+        *p_shift = 0;
+    }
+
+    if (n1 == 0 || n2 == 0)
+    {
+        return 1;
+    }
+
+    // pool the samples, remembering the ones of the first set
+    QVector<QPair<double, bool>> pooled;
+    pooled.reserve(n);
+    foreach (const double value, p_first)
+    {
+        pooled << qMakePair(value, true);
+    }
+    foreach (const double value, p_second)
+    {
+        pooled << qMakePair(value, false);
+    }
+    std::sort(pooled.begin(), pooled.end(), [](const QPair<double, bool> &a, const QPair<double, bool> &b) { return a.first < b.first; });
+
+    // tied values share the average of their ranks
+    double rankSum = 0;
+    double ties    = 0;
+    for (int i = 0; i < n;)
+    {
+        int j = i;
+        while (j < n && pooled[j].first == pooled[i].first)
+        {
+            ++j;
+        }
+
+        const double rank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; ++k)
+        {
+            if (pooled[k].second)
+            {
+                rankSum += rank;
+            }
+        }
+
+        const double t = j - i;
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    const double u     = rankSum - n1 * (n1 + 1) / 2.0;
+    const double mean  = n1 * static_cast<double>(n2) / 2.0;
+    const double sigma = std::sqrt(n1 * static_cast<double>(n2) / 12.0 * ((n + 1) - ties / (n * static_cast<double>(n - 1))));
+
+    if (p_shift != nullptr)
+    {
+        *p_shift = u - mean;
+    }
+
+    if (sigma <= 0)
+    {
+        return 1;
+    }
+
+    const double z = qMax(0.0, std::abs(u - mean) - 0.5) / sigma;
+    return std::erfc(z / std::sqrt(2.0));
+}
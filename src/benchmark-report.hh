@@ -0,0 +1,133 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+class BenchmarkResult;
+class CMatrixModel;
+
+/*!
+  \file benchmark-report.hh
+  \class CBenchmarkReport
+  \brief CBenchmarkReport gathers benchmark results in a structured format that can be saved and compared
+
+  A report describes the environment of the run (application build, OpenCV version, CPU, threads),
+  the benchmark parameters and, for each operation, the matrix it ran on and its samples.
+  Reports are saved as JSON files (or CSV for post-processing) and a saved report
+  can be loaded as a baseline for later runs.
+
+  Comparisons with a baseline rely on a two-sided Mann-Whitney U test on the samples
+  rather than on the difference of the means, so that noise is not reported as a change.
+  The p-values are adjusted with the Holm-Bonferroni method since many operations are
+  compared at once, and changes of the median smaller than a threshold are not reported.
+*/
+class CBenchmarkReport
+{
+public:
+    enum Verdict
+    {
+        Unchanged = 0,
+        Improvement,
+        Regression,
+        New
+    };
+
+    /// Comparison of an operation on a matrix with the same operation on the same matrix in the baseline.
+    struct Comparison
+    {
+        QString file;
+        QString matrix;
+        QString operation;
+        double baselineMedian;
+        double currentMedian;
+        double pValue;
+        double adjustedPValue;
+        Verdict verdict;
+
+        /// Returns the relative change of the median duration.
+        double change() const;
+
+        QString verdictStr() const;
+        QString toString() const;
+        QJsonObject toJson() const;
+    };
+
+    /// Constructor.
+    CBenchmarkReport();
+
+    /// Destructor.
+    ~CBenchmarkReport();
+
+    /*!
+    Clears the results and describes the current environment and parameters of the run.
+  */
+    void reset(const int p_iterations, const int p_warmup, const double p_precision, const bool p_isCacheFlushed);
+
+    void addResult(const BenchmarkResult &p_result, const QString &p_filePath, const CMatrixModel *p_model);
+
+    bool isEmpty() const;
+    const QJsonObject &environment() const;
+    const QJsonArray &results() const;
+
+    QByteArray toJson() const;
+    QByteArray toCsv() const;
+
+    /*!
+    Saves the report as CSV if the extension of \a p_path is .csv, as JSON otherwise.
+  */
+    bool save(const QString &p_path) const;
+
+    /*!
+    Loads a report previously saved as JSON.
+  */
+    bool load(const QString &p_path);
+
+    /*!
+    Compares the results with the ones of \a p_baseline for the same operations on matrices
+    with the same file name, dimensions and type.
+    A change is reported when the p-value of the test, adjusted with the Holm-Bonferroni method
+    for all the compared operations, is below \a p_alpha and when the relative change of the median
+    is at least \a p_threshold.
+  */
+    QVector<Comparison> compare(const CBenchmarkReport &p_baseline, const double p_alpha = 0.05, const double p_threshold = 0.02) const;
+
+    /*!
+    Stores the comparisons with a baseline so that they are saved with the report in JSON.
+    They are ignored when the report is loaded.
+  */
+    void setComparisons(const QVector<Comparison> &p_comparisons);
+
+    /*!
+    Returns the two-sided p-value of the Mann-Whitney U test of \a p_first and \a p_second,
+    using the normal approximation with tie and continuity corrections.
+    \a p_shift is set to a positive value if \a p_first tends to be greater than \a p_second,
+    a negative value if it tends to be lower.
+  */
+    static double mannWhitney(const QVector<double> &p_first, const QVector<double> &p_second, double *p_shift = nullptr);
+
+private:
+    QJsonObject m_environment;
+    QJsonArray m_results;
+    QJsonArray m_comparisons;
+};
@@ -19,11 +19,73 @@
 #include "benchmark-result.hh"
 
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
-BenchmarkResult::BenchmarkResult() : QObject(), m_title("invalid"), m_nsMin(0), m_nsMax(0), m_nsAvg(0), m_status(Ignored) { }
+/// Number of scaled median absolute deviations from the median beyond which a sample is an outlier
+static const double s_outlierThreshold = 3.0;
 
-BenchmarkResult::BenchmarkResult(QString p_name) : QObject(), m_title(std::move(p_name)), m_nsMin(0), m_nsMax(0), m_nsAvg(0), m_status(Ignored) { }
+/// Two-sided 95% quantiles of the Student distribution for 1 to 30 degrees of freedom
+static const double s_studentQuantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                            2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                            2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+static double studentQuantile(const int p_degrees)
+{
+    const int count = sizeof(s_studentQuantiles) / sizeof(s_studentQuantiles[0]);
+    return (p_degrees <= count) ? s_studentQuantiles[qMax(1, p_degrees) - 1] : 1.96;
+}
+
+/// Linear interpolation between the closest ranks of sorted values
+static double percentile(const QVector<double>& p_sorted, const double p_rank)
+{
+    if (p_sorted.isEmpty())
+    {
+        return 0;
+    }
+
+    const double position = p_rank * (p_sorted.size() - 1);
+    const int lower       = static_cast<int>(std::floor(position));
+    const int upper       = qMin(lower + 1, p_sorted.size() - 1);
+    return p_sorted[lower] + (position - lower) * (p_sorted[upper] - p_sorted[lower]);
+}
+
+BenchmarkResult::BenchmarkResult()
+    : QObject()
+    , m_title("invalid")
+    , m_nsMin(0)
+    , m_nsMax(0)
+    , m_nsAvg(0)
+    , m_nsMedian(0)
+    , m_nsP90(0)
+    , m_nsP99(0)
+    , m_nsStdDev(0)
+    , m_nsConfidence(0)
+    , m_outliers(0)
+    , m_warmup(0)
+    , m_samples()
+    , m_status(Ignored)
+{
+}
+
+BenchmarkResult::BenchmarkResult(QString p_name)
+    : QObject()
+    , m_title(std::move(p_name))
+    , m_nsMin(0)
+    , m_nsMax(0)
+    , m_nsAvg(0)
+    , m_nsMedian(0)
+    , m_nsP90(0)
+    , m_nsP99(0)
+    , m_nsStdDev(0)
+    , m_nsConfidence(0)
+    , m_outliers(0)
+    , m_warmup(0)
+    , m_samples()
+    , m_status(Ignored)
+{
+}
 
 BenchmarkResult::BenchmarkResult(const BenchmarkResult& p_other)
     : QObject()
@@ -31,6 +93,14 @@ BenchmarkResult::BenchmarkResult(const BenchmarkResult& p_other)
     , m_nsMin(p_other.nsMin())
     , m_nsMax(p_other.nsMax())
     , m_nsAvg(p_other.nsAvg())
+    , m_nsMedian(p_other.nsMedian())
+    , m_nsP90(p_other.nsP90())
+    , m_nsP99(p_other.nsP99())
+    , m_nsStdDev(p_other.nsStdDev())
+    , m_nsConfidence(p_other.nsConfidence())
+    , m_outliers(p_other.outliers())
+    , m_warmup(p_other.warmup())
+    , m_samples(p_other.samples())
     , m_status(p_other.status())
 {
 }
@@ -77,6 +147,112 @@ void BenchmarkResult::setNsAvg(const double p_value)
     m_nsAvg = p_value;
 }
 
+double BenchmarkResult::nsMedian() const
+{
+    return m_nsMedian;
+}
+
+double BenchmarkResult::nsP90() const
+{
+    return m_nsP90;
+}
+
+double BenchmarkResult::nsP99() const
+{
+    return m_nsP99;
+}
+
+double BenchmarkResult::nsStdDev() const
+{
+    return m_nsStdDev;
+}
+
+double BenchmarkResult::nsConfidence() const
+{
+    return m_nsConfidence;
+}
+
+int BenchmarkResult::outliers() const
+{
+    return m_outliers;
+}
+
+int BenchmarkResult::warmup() const
+{
+    return m_warmup;
+}
+
+void BenchmarkResult::setWarmup(const int p_warmup)
+{
+    m_warmup = p_warmup;
+}
+
+const QVector<qint64>& BenchmarkResult::samples() const
+{
+    return m_samples;
+}
+
+void BenchmarkResult::setSamples(const QVector<qint64>& p_samples)
+{
+    m_samples  = p_samples;
+    m_outliers = 0;
+
+    QVector<double> sorted;
+    sorted.reserve(p_samples.size());
+    foreach (const qint64 ns, p_samples)
+    {
+        sorted << static_cast<double>(ns);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // Median absolute deviation, scaled to estimate the standard deviation of normal data
+    const double median = percentile(sorted, 0.5);
+    QVector<double> deviations;
+    deviations.reserve(sorted.size());
+    foreach (const double ns, sorted)
+    {
+        deviations << std::abs(ns - median);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    const double threshold = s_outlierThreshold * 1.4826 * percentile(deviations, 0.5);
+
+    // a null deviation means that most samples are equal: nothing is rejected
+    QVector<double> kept;
+    kept.reserve(sorted.size());
+    foreach (const double ns, sorted)
+    {
+        if (threshold == 0 || std::abs(ns - median) <= threshold)
+        {
+            kept << ns;
+        }
+    }
+    m_outliers = sorted.size() - kept.size();
+
+    const int n = kept.size();
+    double sum  = 0;
+    foreach (const double ns, kept)
+    {
+        sum += ns;
+    }
+    const double mean = (n > 0) ? sum / n : 0;
+
+    double squares = 0;
+    foreach (const double ns, kept)
+    {
+        squares += (ns - mean) * (ns - mean);
+    }
+
+    // the extrema are the raw ones: outliers are only excluded from the estimators
+    m_nsMin        = sorted.isEmpty() ? 0 : sorted.first();
+    m_nsMax        = sorted.isEmpty() ? 0 : sorted.last();
+    m_nsAvg        = mean;
+    m_nsMedian     = percentile(kept, 0.5);
+    m_nsP90        = percentile(kept, 0.9);
+    m_nsP99        = percentile(kept, 0.99);
+    m_nsStdDev     = (n > 1) ? std::sqrt(squares / (n - 1)) : 0;
+    m_nsConfidence = (n > 1) ? studentQuantile(n - 1) * m_nsStdDev / std::sqrt(static_cast<double>(n)) : 0;
+}
+
 BenchmarkResult::Status BenchmarkResult::status() const
 {
     return m_status;
@@ -110,34 +286,39 @@ QString BenchmarkResult::statusStr() const
 QString BenchmarkResult::timeStr() const
 {
     QString unit = "ns";
-    double min   = m_nsMin;
-    double max   = m_nsMax;
-    double avg   = m_nsAvg;
+    double scale = 1;
 
     const double us = 1000;
     const double ms = us * 1000;
     const double s  = ms * 1000;
-    if (min > s)
+    if (m_nsMin > s)
     {
-        min /= s;
-        max /= s;
-        avg /= s;
-        unit = "s";
+        scale = s;
+        unit  = "s";
     }
-    else if (min > ms)
+    else if (m_nsMin > ms)
     {
-        min /= ms;
-        max /= ms;
-        avg /= ms;
-        unit = "ms";
+        scale = ms;
+        unit  = "ms";
     }
-    else if (min > us)
+    else if (m_nsMin > us)
     {
-        min /= us;
-        max /= us;
-        avg /= us;
-        unit = "µs";
+        scale = us;
+        unit  = "µs";
     }
 
-    return QString("avg: %1 %4\nmin: %2 %4\nmax: %3 %4\n").arg(avg).arg(min).arg(max).arg(unit);
+    return QString("avg: %1 ± %2 %9 (stddev: %3 %9)\nmin: %4 %9\nmedian: %5 %9\np90: %6 %9\np99: %7 %9\nmax: %8 %9\n"
+                   "iterations: %10 (warmup: %11, outliers: %12)\n")
+        .arg(m_nsAvg / scale)
+        .arg(m_nsConfidence / scale)
+        .arg(m_nsStdDev / scale)
+        .arg(m_nsMin / scale)
+        .arg(m_nsMedian / scale)
+        .arg(m_nsP90 / scale)
+        .arg(m_nsP99 / scale)
+        .arg(m_nsMax / scale)
+        .arg(unit)
+        .arg(m_samples.size())
+        .arg(m_warmup)
+        .arg(m_outliers);
 }
@@ -22,6 +22,7 @@
 #include <QMetaType>
 #include <QObject>
 #include <QString>
+#include <QVector>
 
 class BenchmarkResult : public QObject
 {
@@ -52,6 +53,41 @@ public:
     double nsAvg() const;
     void setNsAvg(const double p_value);
 
+    double nsMedian() const;
+    double nsP90() const;
+    double nsP99() const;
+    double nsStdDev() const;
+
+    /*!
+    Returns the half-width of the 95% confidence interval of nsAvg().
+  */
+    double nsConfidence() const;
+
+    /*!
+    Returns the number of samples rejected as outliers.
+    A sample is an outlier when it is further than 3 scaled median absolute deviations from the median.
+    Outliers are excluded from the mean, the standard deviation, the confidence interval
+    and the percentiles, but not from nsMin() and nsMax().
+  */
+    int outliers() const;
+
+    /*!
+    Returns the number of unmeasured iterations run before the samples.
+  */
+    int warmup() const;
+    void setWarmup(const int p_warmup);
+
+    /*!
+    Returns the duration in nanoseconds of each measured iteration, warmup iterations excluded.
+  */
+    const QVector<qint64>& samples() const;
+
+    /*!
+    Sets the measured durations and computes the statistics of the result from them.
+    Outliers are kept in samples() but are rejected from all the statistics.
+  */
+    void setSamples(const QVector<qint64>& p_samples);
+
     Status status() const;
     void setStatus(const Status s);
     QString statusStr() const;
@@ -63,6 +99,14 @@ private:
     double m_nsMin;
     double m_nsMax;
     double m_nsAvg;
+    double m_nsMedian;
+    double m_nsP90;
+    double m_nsP99;
+    double m_nsStdDev;
+    double m_nsConfidence;
+    int m_outliers;
+    int m_warmup;
+    QVector<qint64> m_samples;
     Status m_status;
 };
 
@@ -0,0 +1,277 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "benchmark-runner.hh"
+
+#include "benchmark-task.hh"
+#include "matrix-converter.hh"
+#include "matrix-model.hh"
+#include "operation.hh"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <utility>
+
+CBenchmarkRunner::CBenchmarkRunner(QStringList p_cliArguments)
+    : QObject()
+    , m_command(std::move(p_cliArguments))
+    , m_iterations(10)
+    , m_warmup(1)
+    , m_precision(0)
+    , m_isCacheFlushed(true)
+    , m_filePath()
+    , m_model(nullptr)
+    , m_report()
+    , m_isSuccess(true)
+{
+}
+
+CBenchmarkRunner::~CBenchmarkRunner() { }
+
+int CBenchmarkRunner::execute()
+{
+    QStringList operations;
+    foreach (const Operation &o, Operation::list_benchmark())
+    {
+        operations << o.name();
+    }
+    const QStringList available = operations;
+
+    QStringList files;
+    QString outputPath;
+    QString formatName;
+    QString baselinePath;
+    double alpha     = 0.05;
+    double threshold = 0.02;
+
+    for (int i = 1; i < m_command.size(); ++i) // skip first command line argument (executable name)
+    {
+        QString arg(m_command[i]);
+
+        if (arg == "--benchmark")
+        {
+            continue;
+        }
+
+        const bool hasValue = i + 1 < m_command.size();
+        if (arg == "--operations" && hasValue)
+        {
+            operations = QString(m_command[++i]).split(',', Qt::SkipEmptyParts); //option value
+            foreach (const QString &name, operations)
+            {
+                if (!available.contains(name))
+                {
+                    qWarning() << QObject::tr("Invalid operation [%1]. Available operations are: %2").arg(name).arg(available.join(","));
+                    return -1;
+                }
+            }
+        }
+        else if (arg == "--iterations" && hasValue)
+        {
+            m_iterations = QString(m_command[++i]).toInt(); //option value
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            m_warmup = QString(m_command[++i]).toInt(); //option value
+        }
+        else if (arg == "--precision" && hasValue)
+        {
+            m_precision = QString(m_command[++i]).toDouble() / 100.0; //option value in percent
+        }
+        else if (arg == "--no-cache-flush")
+        {
+            m_isCacheFlushed = false;
+        }
+        else if ((arg == "--output" || arg == "-o") && hasValue)
+        {
+            outputPath = QString(m_command[++i]); //option value
+        }
+        else if (arg == "--format" && hasValue)
+        {
+            formatName = QString(m_command[++i]).toLower(); //option value
+        }
+        else if (arg == "--baseline" && hasValue)
+        {
+            baselinePath = QString(m_command[++i]); //option value
+        }
+        else if (arg == "--alpha" && hasValue)
+        {
+            alpha = QString(m_command[++i]).toDouble(); //option value
+        }
+        else if (arg == "--threshold" && hasValue)
+        {
+            threshold = QString(m_command[++i]).toDouble() / 100.0; //option value in percent
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            cv::setNumThreads(QString(m_command[++i]).toInt()); //option value
+        }
+        else if (QFile(arg).exists())
+        {
+            files << arg;
+        }
+        else
+        {
+            qWarning() << QObject::tr("Ignoring [%1]. Run [%2 -h] for usage information.").arg(arg).arg(QCoreApplication::applicationName());
+        }
+    }
+
+    if (m_iterations < 1 || m_warmup < 0 || m_precision < 0)
+    {
+        qWarning() << QObject::tr("Invalid number of iterations [%1], warmup iterations [%2] or precision [%3]")
+                          .arg(m_iterations)
+                          .arg(m_warmup)
+                          .arg(m_precision * 100);
+        return -1;
+    }
+
+    Format format = outputPath.endsWith(".csv", Qt::CaseInsensitive) ? Format_Csv : Format_Json;
+    if (formatName == "csv")
+    {
+        format = Format_Csv;
+    }
+    else if (formatName == "json")
+    {
+        format = Format_Json;
+    }
+    else if (!formatName.isEmpty())
+    {
+        qWarning() << QObject::tr("Invalid output format [%1]. Run [%2 -h] for usage information.").arg(formatName).arg(QCoreApplication::applicationName());
+        return -1;
+    }
+
+    if (alpha <= 0 || alpha >= 1)
+    {
+        qWarning() << QObject::tr("Invalid significance level [%1]. Run [%2 -h] for usage information.").arg(alpha).arg(QCoreApplication::applicationName());
+        return -1;
+    }
+
+    if (threshold < 0)
+    {
+        qWarning() << QObject::tr("Invalid change threshold [%1]. Run [%2 -h] for usage information.").arg(threshold * 100).arg(QCoreApplication::applicationName());
+        return -1;
+    }
+
+    if (files.isEmpty())
+    {
+        qWarning() << QObject::tr("No input file. Run [%1 -h] for usage information.").arg(QCoreApplication::applicationName());
+        return -1;
+    }
+
+    // the baseline is loaded first so that an invalid file does not waste a whole run
+    CBenchmarkReport baseline;
+    if (!baselinePath.isEmpty() && !baseline.load(baselinePath))
+    {
+        return -1;
+    }
+
+    m_report.reset(m_iterations, m_warmup, m_precision, m_isCacheFlushed);
+    foreach (const QString &filePath, files)
+    {
+        if (!run(filePath, operations))
+        {
+            return -1;
+        }
+    }
+
+    bool hasRegression = false;
+    if (!baselinePath.isEmpty())
+    {
+        const QVector<CBenchmarkReport::Comparison> comparisons = m_report.compare(baseline, alpha, threshold);
+        foreach (const CBenchmarkReport::Comparison &comparison, comparisons)
+        {
+            if (comparison.verdict == CBenchmarkReport::Regression)
+            {
+                hasRegression = true;
+                qWarning().noquote() << comparison.toString();
+            }
+            else
+            {
+                qDebug().noquote() << comparison.toString();
+            }
+        }
+        m_report.setComparisons(comparisons);
+    }
+
+    const QByteArray report = (format == Format_Csv) ? m_report.toCsv() : m_report.toJson();
+
+    if (outputPath.isEmpty())
+    {
+        QTextStream out(stdout);
+        out << report;
+        out.flush();
+    }
+    else
+    {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(report) != report.size())
+        {
+            qWarning() << QObject::tr("Fail to save output file [%1]").arg(outputPath);
+            qWarning() << "-- error:" << file.errorString();
+            return -1;
+        }
+    }
+
+    return (m_isSuccess && !hasRegression) ? 0 : -1;
+}
+
+bool CBenchmarkRunner::run(const QString &p_filePath, const QStringList &p_operations)
+{
+    CMatrixConverter converter;
+    if (!converter.load(p_filePath))
+    {
+        qWarning() << QObject::tr("Fail to load input file [%1]").arg(p_filePath);
+        return false;
+    }
+
+    CMatrixModel model(p_filePath, converter);
+
+    m_filePath = p_filePath;
+    m_model    = &model;
+
+    foreach (const QString &name, p_operations)
+    {
+        qDebug() << QObject::tr("Benchmark of [%1] on [%2]").arg(name).arg(p_filePath);
+
+        BenchmarkTask task(name, m_iterations, &model);
+        task.setWarmup(m_warmup);
+        task.setPrecision(m_precision);
+        task.setCacheFlushed(m_isCacheFlushed);
+        connect(&task, SIGNAL(resultReady(const BenchmarkResult &)), this, SLOT(processResult(const BenchmarkResult &)));
+        task.execute();
+    }
+
+    m_model = nullptr;
+    return true;
+}
+
+void CBenchmarkRunner::processResult(const BenchmarkResult &p_result)
+{
+    if (m_model == nullptr)
+    {
+        return;
+    }
+
+    if (p_result.status() != BenchmarkResult::Success)
+    {
+        m_isSuccess = false;
+    }
+
+    m_report.addResult(p_result, m_filePath, m_model);
+}
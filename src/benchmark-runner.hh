@@ -0,0 +1,80 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include "benchmark-report.hh"
+#include "benchmark-result.hh"
+
+#include <QObject>
+#include <QStringList>
+
+class CMatrixModel;
+
+/*!
+  \file benchmark-runner.hh
+  \class CBenchmarkRunner
+  \brief CBenchmarkRunner runs benchmarks from the command-line without any display
+
+  Each input matrix is loaded in turn and the selected operations of
+  Operation::list_benchmark() are run on it through BenchmarkTask.
+  Results are written as JSON or CSV with the duration of every measured iteration
+  so that they can be post-processed by performance tracking jobs.
+  A JSON report of a previous run can be given as a baseline: significant regressions
+  of at least the change threshold make the run fail.
+  \sa CBenchmarkReport
+*/
+class CBenchmarkRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Format_Json = 0,
+        Format_Csv
+    };
+
+    /// Constructor.
+    CBenchmarkRunner(QStringList p_cliArguments);
+
+    /// Destructor.
+    ~CBenchmarkRunner() override;
+
+    /**
+     * @brief Execute benchmark command line
+     * @return Error code, 0 if success, -1 otherwise
+     */
+    int execute();
+
+public slots:
+    void processResult(const BenchmarkResult &p_result);
+
+private:
+    bool run(const QString &p_filePath, const QStringList &p_operations);
+
+    QStringList m_command;
+    int m_iterations;
+    int m_warmup;
+    double m_precision;
+    bool m_isCacheFlushed;
+    QString m_filePath;
+    CMatrixModel *m_model;
+    CBenchmarkReport m_report;
+    bool m_isSuccess;
+};
@@ -19,24 +19,82 @@
 #include "benchmark-task.hh"
 
 #include "elapsed-timer.hh"
+#include "matrix-comparator.hh"
 #include "matrix-model.hh"
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QStringList>
+#include <QVector>
 #include <utility>
 
+/// Minimum number of measured iterations before the precision of the mean is checked
+static const int s_minAutoIterations = 5;
+
+/// Size of the buffer written between iterations, larger than the last level cache of usual CPUs
+static const int s_cacheFlushSize = 64 * 1024 * 1024;
+static const int s_cacheLineSize  = 64;
+
 BenchmarkTask::BenchmarkTask(QString p_operationName, const int p_nbIterations, CMatrixModel* p_model)
     : QObject()
     , m_name(std::move(p_operationName))
     , m_iterations(p_nbIterations)
+    , m_warmup(0)
+    , m_precision(0)
+    , m_isCacheFlushed(true)
     , m_model(p_model)
     , m_cancelRequested(false)
+    , m_cacheFlushBuffer()
 {
 }
 
 BenchmarkTask::~BenchmarkTask() { }
 
+int BenchmarkTask::warmup() const
+{
+    return m_warmup;
+}
+
+void BenchmarkTask::setWarmup(const int p_warmup)
+{
+    m_warmup = qMax(0, p_warmup);
+}
+
+double BenchmarkTask::precision() const
+{
+    return m_precision;
+}
+
+void BenchmarkTask::setPrecision(const double p_precision)
+{
+    m_precision = qMax(0.0, p_precision);
+}
+
+bool BenchmarkTask::isCacheFlushed() const
+{
+    return m_isCacheFlushed;
+}
+
+void BenchmarkTask::setCacheFlushed(const bool p_flushed)
+{
+    m_isCacheFlushed = p_flushed;
+}
+
+void BenchmarkTask::flushCaches()
+{
+    if (m_cacheFlushBuffer.size() != s_cacheFlushSize)
+    {
+        m_cacheFlushBuffer.fill(0, s_cacheFlushSize);
+    }
+
+    // writing one byte per line loads and dirties the whole line
+    char* data = m_cacheFlushBuffer.data();
+    for (int i = 0; i < s_cacheFlushSize; i += s_cacheLineSize)
+    {
+        ++data[i];
+    }
+}
+
 void BenchmarkTask::execute()
 {
     if (m_model == nullptr)
@@ -46,29 +104,39 @@ void BenchmarkTask::execute()
 
     m_cancelRequested = false;
 
+    // operations and restorations of the benchmark are not edits of the matrix
+    const bool isHistoryEnabled = m_model->isHistoryEnabled();
+    m_model->setHistoryEnabled(false);
+
     CMatrixModel* ref = m_model->clone();
 
     BenchmarkResult result(m_name);
 
     CElapsedTimer timer;
 
-    qint64 ns  = 0;
-    double min = DBL_MAX;
-    double max = -DBL_MAX;
-    double sum = 0;
-    for (int i = 0; i < m_iterations; ++i)
+    qint64 ns = 0;
+    QVector<qint64> samples;
+    samples.reserve(m_iterations);
+    // negative iterations are warmup ones and are not measured
+    for (int i = -m_warmup; i < m_iterations; ++i)
     {
         // check for cancel signals from benchmark-dialog
-        QApplication::processEvents();
+        QCoreApplication::processEvents();
 
         if (m_cancelRequested)
         {
+            m_model->setHistoryEnabled(isHistoryEnabled);
+            delete ref;
             result.setStatus(BenchmarkResult::Canceled);
             emit resultReady(result);
             return;
         }
 
-        CMatrixModel* backup = m_model->clone();
+        // the reference copy is made once: timed calls only follow the cache flush
+        if (m_isCacheFlushed)
+        {
+            flushCaches();
+        }
 
         if (m_name == "total")
         {
@@ -148,38 +216,55 @@ void BenchmarkTask::execute()
         else
         {
             qWarning() << "unsupported operation " << m_name;
-            delete backup;
+            delete ref;
+            m_model->setHistoryEnabled(isHistoryEnabled);
             result.setStatus(BenchmarkResult::Ignored);
             emit resultReady(result);
             return;
         }
 
-        m_model->setData(backup->data());
-        delete backup;
+        // restore the original values and drop the statistics cached by the operation
+        m_model->setData(ref->data().clone());
+        m_model->clearCaches();
 
-        if (ns < min)
+        if (i < 0)
         {
-            min = ns;
+            continue;
         }
 
-        if (ns > max)
+        samples << ns;
+
+        // in auto mode, stop as soon as the mean is known with the requested precision
+        if (m_precision > 0 && samples.size() >= s_minAutoIterations)
         {
-            max = ns;
+            BenchmarkResult estimate;
+            estimate.setSamples(samples);
+            if (estimate.nsConfidence() <= m_precision * estimate.nsAvg())
+            {
+                break;
+            }
         }
-        sum += ns;
     }
 
     // Check data integrity
     if (!CMatrixModel::compare(m_model, ref))
     {
         qWarning() << "Benchmark of operation" << m_name << " has modified original model";
+
+        const CMatrixComparator::Comparison comparison = CMatrixComparator::compare(m_model->data(), ref->data());
+        if (comparison.isComparable)
+        {
+            qWarning() << "-- differences:" << comparison.differences << "first at" << comparison.firstDifference << "channel"
+                       << comparison.firstChannel << "largest at" << comparison.largestDifference << "channel" << comparison.largestChannel
+                       << "(" << comparison.maxAbsoluteDifference << ")";
+        }
     }
 
     delete ref;
+    m_model->setHistoryEnabled(isHistoryEnabled);
 
-    result.setNsMin(min);
-    result.setNsMax(max);
-    result.setNsAvg(sum / (double) m_iterations);
+    result.setWarmup(m_warmup);
+    result.setSamples(samples);
     result.setStatus(BenchmarkResult::Success);
 
     emit resultReady(result);
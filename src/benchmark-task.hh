@@ -20,6 +20,7 @@
 
 #include "benchmark-result.hh"
 
+#include <QByteArray>
 #include <QString>
 
 class CMatrixModel;
@@ -32,6 +33,29 @@ public:
 
     ~BenchmarkTask() override;
 
+    /*!
+    Returns the number of iterations run before the measured ones.
+    Those iterations are not part of the result.
+  */
+    int warmup() const;
+    void setWarmup(const int p_warmup);
+
+    /*!
+    Returns the relative precision of the mean duration that stops the benchmark.
+    When it is positive, iterations are run until the half-width of the 95% confidence interval
+    of the mean is below this fraction of the mean, the number of iterations being the maximum.
+    The default value 0 runs exactly the number of iterations.
+  */
+    double precision() const;
+    void setPrecision(const double p_precision);
+
+    /*!
+    Returns \a true if the CPU caches are flushed before each iteration (default).
+    Timed calls then start from cold caches instead of the ones left by the previous iteration.
+  */
+    bool isCacheFlushed() const;
+    void setCacheFlushed(const bool p_flushed);
+
     void execute();
 
 signals:
@@ -41,8 +65,14 @@ public slots:
     void cancel();
 
 private:
+    void flushCaches();
+
     QString m_name;
     int m_iterations;
+    int m_warmup;
+    double m_precision;
+    bool m_isCacheFlushed;
     CMatrixModel *m_model;
     bool m_cancelRequested;
+    QByteArray m_cacheFlushBuffer;
 };
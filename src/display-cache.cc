@@ -0,0 +1,165 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "display-cache.hh"
+
+#include <QMutexLocker>
+
+// Tiles are wider than tall: wide matrices are mostly scrolled horizontally
+static const int s_tileRows    = 32;
+static const int s_tileColumns = 16;
+
+CDisplayCache::CDisplayCache(const int p_maxTiles) : m_mutex(), m_tiles(p_maxTiles), m_generation(0), m_hits(0), m_misses(0), m_prefetching(false) { }
+
+CDisplayCache::~CDisplayCache() { }
+
+int CDisplayCache::tileRows()
+{
+    return s_tileRows;
+}
+
+int CDisplayCache::tileColumns()
+{
+    return s_tileColumns;
+}
+
+QPoint CDisplayCache::tileAt(const int p_row, const int p_col)
+{
+    return QPoint(p_col / s_tileColumns, p_row / s_tileRows);
+}
+
+QRect CDisplayCache::tileCells(const QPoint& p_tile)
+{
+    return QRect(p_tile.x() * s_tileColumns, p_tile.y() * s_tileRows, s_tileColumns, s_tileRows);
+}
+
+quint64 CDisplayCache::key(const QPoint& p_tile)
+{
+    return (static_cast<quint64>(p_tile.y()) << 32) | static_cast<quint32>(p_tile.x());
+}
+
+int CDisplayCache::maxTiles() const
+{
+    return m_tiles.maxCost();
+}
+
+bool CDisplayCache::value(const int p_row, const int p_col, QString& p_value)
+{
+    const QPoint tile = tileAt(p_row, p_col);
+
+    QMutexLocker locker(&m_mutex);
+    const DisplayTile* displayTile = m_tiles.object(key(tile));
+    if (displayTile == nullptr)
+    {
+        ++m_misses;
+        return false;
+    }
+
+    const QRect cells = tileCells(tile);
+    p_value           = displayTile->values.at((p_row - cells.top()) * displayTile->columns + (p_col - cells.left()));
+    ++m_hits;
+    return true;
+}
+
+bool CDisplayCache::contains(const QPoint& p_tile) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tiles.contains(key(p_tile));
+}
+
+quint64 CDisplayCache::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+bool CDisplayCache::insert(const QPoint& p_tile, const int p_columns, const QVector<QString>& p_values, const quint64 p_generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (p_generation != m_generation)
+    {
+        return false;
+    }
+
+    m_tiles.insert(key(p_tile), new DisplayTile{p_values, p_columns});
+    return true;
+}
+
+void CDisplayCache::invalidate(const QRect& p_cells)
+{
+    const QPoint first = tileAt(p_cells.top(), p_cells.left());
+    const QPoint last  = tileAt(p_cells.bottom(), p_cells.right());
+
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+
+    // Large ranges: look for the cached tiles instead of enumerating the range
+    const qint64 tileCount = static_cast<qint64>(last.x() - first.x() + 1) * (last.y() - first.y() + 1);
+    if (tileCount > m_tiles.size())
+    {
+        const QRect range(first, last);
+        for (const quint64 tileKey : m_tiles.keys())
+        {
+            if (range.contains(static_cast<int>(tileKey & 0xffffffff), static_cast<int>(tileKey >> 32)))
+            {
+                m_tiles.remove(tileKey);
+            }
+        }
+        return;
+    }
+
+    for (int y = first.y(); y <= last.y(); ++y)
+    {
+        for (int x = first.x(); x <= last.x(); ++x)
+        {
+            m_tiles.remove(key(QPoint(x, y)));
+        }
+    }
+}
+
+void CDisplayCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+    m_tiles.clear();
+}
+
+qint64 CDisplayCache::hits() const
+{
+    return m_hits;
+}
+
+qint64 CDisplayCache::misses() const
+{
+    return m_misses;
+}
+
+void CDisplayCache::resetCounters()
+{
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+bool CDisplayCache::acquirePrefetch()
+{
+    return !m_prefetching.exchange(true);
+}
+
+void CDisplayCache::releasePrefetch()
+{
+    m_prefetching = false;
+}
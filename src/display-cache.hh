@@ -0,0 +1,146 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QCache>
+#include <QMutex>
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/*!
+  \file display-cache.hh
+  \class CDisplayCache
+  \brief CDisplayCache stores the formatted values of the cells of a table by tiles
+
+  Cells are grouped in tiles of tileRows() x tileColumns() cells that are
+  formatted, stored and evicted as a whole. Rectangles of cells and tile
+  coordinates follow the QRect / QPoint convention: x is the column and
+  y is the row.
+
+  The least recently used tiles are evicted once maxTiles() tiles are cached.
+
+  Tiles may be inserted from a background thread. Each insertion carries
+  the generation() observed before formatting the tile and is dropped
+  if the cache has been invalidated in the meantime, so that values
+  formatted from outdated data never survive an invalidation.
+*/
+class CDisplayCache
+{
+public:
+    /// Constructor.
+    CDisplayCache(const int p_maxTiles = 256);
+
+    /// Destructor.
+    ~CDisplayCache();
+
+    CDisplayCache(const CDisplayCache &) = delete;
+    CDisplayCache &operator=(const CDisplayCache &) = delete;
+
+    static int tileRows();
+    static int tileColumns();
+
+    /*!
+    Returns the coordinates of the tile that contains the cell (\a p_row, \a p_col).
+  */
+    static QPoint tileAt(const int p_row, const int p_col);
+
+    /*!
+    Returns the cells covered by the tile \a p_tile.
+  */
+    static QRect tileCells(const QPoint &p_tile);
+
+    int maxTiles() const;
+
+    /*!
+    Sets \a p_value to the cached value of the cell (\a p_row, \a p_col).
+    Returns \a false if the cell is not cached.
+    \sa hits, misses
+  */
+    bool value(const int p_row, const int p_col, QString &p_value);
+
+    /*!
+    Returns \a true if the tile \a p_tile is cached, \a false otherwise.
+  */
+    bool contains(const QPoint &p_tile) const;
+
+    /*!
+    Returns the number of invalidations of the cache.
+  */
+    quint64 generation() const;
+
+    /*!
+    Stores the \a p_values of the tile \a p_tile in row-major order.
+    \a p_columns is the number of columns of the tile, that is smaller than
+    tileColumns() on the right border of the table.
+    The values are dropped and \a false is returned if the cache has been
+    invalidated since \a p_generation.
+  */
+    bool insert(const QPoint &p_tile, const int p_columns, const QVector<QString> &p_values, const quint64 p_generation);
+
+    /*!
+    Removes the tiles that intersect \a p_cells.
+  */
+    void invalidate(const QRect &p_cells);
+
+    /*!
+    Removes all the tiles.
+  */
+    void clear();
+
+    /*!
+    Returns the number of values found in the cache.
+  */
+    qint64 hits() const;
+
+    /*!
+    Returns the number of values that were not found in the cache.
+  */
+    qint64 misses() const;
+
+    void resetCounters();
+
+    /*!
+    Returns \a true if the caller may start formatting tiles in background,
+    \a false if another background task is already running.
+    \sa releasePrefetch
+  */
+    bool acquirePrefetch();
+
+    void releasePrefetch();
+
+private:
+    struct DisplayTile
+    {
+        QVector<QString> values;
+        int columns;
+    };
+
+    static quint64 key(const QPoint &p_tile);
+
+    mutable QMutex m_mutex;
+    QCache<quint64, DisplayTile> m_tiles;
+    quint64 m_generation;
+
+    std::atomic<qint64> m_hits;
+    std::atomic<qint64> m_misses;
+    std::atomic<bool> m_prefetching;
+};
@@ -18,13 +18,14 @@
 
 #include "edf.hh"
 
+#include <QByteArray>
 #include <QDataStream>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
 
-CEdfFile::CEdfFile(const QString& p_filePath) : m_data(), m_metadata(), m_headerStart(-1), m_headerStop(-1), m_file(nullptr), m_stream(nullptr)
+CEdfFile::CEdfFile(const QString& p_filePath) : m_data(), m_metadata(), m_headerStart(-1), m_headerStop(-1), m_frames(), m_currentFrame(0), m_progressHandler()
 {
     read(p_filePath);
 }
@@ -63,15 +64,6 @@ bool CEdfFile::loadData()
 {
     m_data.release();
 
-    if (!isStreamInitialized() && !initStream())
-    {
-        qWarning() << "Invalid image stream reader";
-        return false;
-    }
-
-    stream()->seek(0);
-
-    //Read in whole content of a file. Will have to be done later anyways for the matrix
     QFile file(path());
     if (!file.open(QIODevice::ReadOnly))
     {
@@ -80,142 +72,287 @@ bool CEdfFile::loadData()
         return false;
     }
 
-    const QByteArray& fileContent = file.readAll();
-    closeStream();
+    if (!indexFrames(file))
+    {
+        return false;
+    }
 
-    QTextStream localStream(fileContent);
-    int lineCount = 0;
+    return readFrame(0);
+}
 
-    //For performance reasons we keep track of if the first line was already found.
-    //This allows us to call the very expensive function pos() ideally only twice: At the first line and for the end of the header
-    bool startLineFound = false;
+bool CEdfFile::indexFrames(QFile& p_file)
+{
+    // EDF files may contain several concatenated header+payload blocks (image stacks, time series).
+    // Scan all headers in one pass and skip over the binary sections without reading them,
+    // so that only the frame being viewed is decoded later on.
+    m_frames.clear();
 
-    qint64 startLinePos = -1;
-    while (!localStream.atEnd())
+    qint64 position = 0;
+    while (position < p_file.size())
     {
-        ++lineCount;
+        m_metadata.clear();
+        m_headerStart = -1;
+        m_headerStop  = -1;
 
-        if (!startLineFound)
+        if (!p_file.seek(position) || !readHeader(p_file))
         {
-            startLinePos = localStream.pos();
+            break;
         }
-        const QString& line = localStream.readLine().trimmed();
 
-        if (isBeginHeaderLine(line))
+        if (!checkRequiredHeaderProperties())
         {
-            m_headerStart  = startLinePos;
-            startLineFound = true;
-            continue;
+            qWarning() << "Invalid .edf image file format: missing header properties";
+            qWarning() << "-- frame:" << m_frames.size();
+            break;
         }
 
-        if (!line.isEmpty() && m_headerStart < 0)
-        {
-            qWarning() << "Skip reading badly formed edf image: content found before header section";
-            qWarning() << " -- file:" << path();
-            qWarning() << " -- line" << lineCount << "starting with:" << line.left(10);
-            qWarning() << " -- expecting '{' character to start header section";
-            Q_ASSERT(false);
-            return false;
-        }
+        EdfFrame frame;
+        frame.metadata = m_metadata;
+        frame.rows     = static_cast<int>(readRowCount());
+        frame.cols     = static_cast<int>(readColumnCount());
+        frame.type     = readDataType();
 
-        if (isEndHeaderLine(line))
+        // Binary data start after the header section, which may not start at the very beginning of the block.
+        // Beware of cases where there exist some characters before headerStart mark
+        // (ie: m_headerStart > 0): we need to skip more bytes than just 'headerSize()'
+        frame.offset = m_headerStart + headerSize();
+
+        const qint64 frameSize  = static_cast<qint64>(frame.rows) * frame.cols * CV_ELEM_SIZE(frame.type);
+        const qint64 binarySize = readBinarySize();
+        if (binarySize < frameSize)
         {
-            m_headerStop = localStream.pos();
+            qWarning() << "Invalid .edf image file format: binary size" << binarySize << "is smaller than image size" << frameSize;
+            qWarning() << "-- frame:" << m_frames.size();
             break;
         }
 
-        if (m_headerStart < 0 || line.isEmpty())
+        if (frame.offset + frameSize > p_file.size())
         {
-            //qDebug() << "Skip empty / comment line" << line;
-            continue;
+            qWarning() << "Can't read raw binary data from edf image file" << metadata().fileName();
+            qWarning() << "-- error: file is truncated (expected" << frame.offset + frameSize << "bytes, got" << p_file.size() << ")";
+            qWarning() << "-- frame:" << m_frames.size();
+            break;
         }
 
-        if (isHeaderLine(line))
-        {
-            m_metadata.addProperty(parseHeaderLine(line));
-            //qDebug() << "Add property from header line" << line;
-            continue;
-        }
+        m_frames.append(frame);
+        position = frame.offset + binarySize;
     }
 
-    if (!checkRequiredHeaderProperties())
+    m_metadata.clear();
+    if (m_frames.isEmpty())
     {
-        qWarning() << "Invalid .edf image file format: missing header properties";
+        qWarning() << "No valid image found in edf file:" << path();
         return false;
     }
 
-    QDataStream in(fileContent); // read the data serialized from the file
+    return true;
+}
 
-    // Start reading binary data after the header section
-    // Beware of cases where there exist some characters before headerStart mark
-    // (ie: m_headerStart > 0): we need to skip more bytes than just 'headerSize()'
-    in.skipRawData(static_cast<int>(m_headerStop));
+int CEdfFile::frameCount() const
+{
+    return m_frames.size();
+}
 
-    const int binarySize = static_cast<int>(readBinarySize());
-    const int rows       = static_cast<int>(readRowCount());
-    const int cols       = static_cast<int>(readColumnCount());
+int CEdfFile::currentFrame() const
+{
+    return m_currentFrame;
+}
 
-#if 0
-    const int length = binarySize;
-    //char *buffer = new char[length];
-    const int bytes = in.readRawData(buffer, length);
-    if (bytes < 0)
+bool CEdfFile::readFrame(const int p_index)
+{
+    if (p_index < 0 || p_index >= frameCount())
     {
-        qWarning() << "Can't read raw binary data from edf image file" << info().fileName();
-        delete[] buffer;
+        qWarning() << "Invalid frame index" << p_index << "for edf file" << metadata().fileName();
         return false;
     }
-#endif
 
-    cv::Mat matrix(rows, cols, readDataType());
-    const int bytes = in.readRawData(reinterpret_cast<char*>(matrix.data), binarySize);
-    if (bytes < 0)
+    const cv::Mat matrix = decodeFrame(p_index);
+    if (matrix.empty())
     {
-        qWarning() << "Can't read raw binary data from edf image file" << metadata().fileName();
         return false;
     }
 
+    m_currentFrame = p_index;
+    setMetadata(m_frames[p_index].metadata);
     setData(matrix);
     return true;
 }
 
-bool CEdfFile::loadHeader()
+cv::Mat CEdfFile::decodeFrame(const int p_index) const
 {
+    if (p_index < 0 || p_index >= frameCount())
+    {
+        return cv::Mat();
+    }
+
+    const EdfFrame& frame = m_frames[p_index];
+
+    QFile file(path());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't read from edf file:" << path();
+        qWarning() << "-- error:" << file.errorString();
+        return cv::Mat();
+    }
+
+    // Read the binary section straight into the matrix buffer, by slices to report progress
+    static const qint64 s_sliceSize = 4 << 20;
+
+    cv::Mat matrix(frame.rows, frame.cols, frame.type);
+    const qint64 size = static_cast<qint64>(matrix.total() * matrix.elemSize());
+    if (!file.seek(frame.offset))
+    {
+        qWarning() << "Can't seek to frame" << p_index << "in edf image file" << metadata().fileName();
+        return cv::Mat();
+    }
+
+    char* buffer = reinterpret_cast<char*>(matrix.data);
+    for (qint64 position = 0; position < size; position += s_sliceSize)
+    {
+        const qint64 length = std::min(s_sliceSize, size - position);
+        if (file.read(buffer + position, length) != length)
+        {
+            qWarning() << "Can't read raw binary data from edf image file" << metadata().fileName();
+            qWarning() << "-- frame:" << p_index;
+            qWarning() << "-- error:" << file.errorString();
+            return cv::Mat();
+        }
+
+        if (m_progressHandler && !m_progressHandler(position + length, size))
+        {
+            return cv::Mat();
+        }
+    }
+
+    return matrix;
+}
+
+bool CEdfFile::readHeaders(const QString& p_path)
+{
+    if (p_path.isEmpty())
+    {
+        return false;
+    }
+
     clear();
+    m_metadata.setFile(p_path);
+    return loadHeader();
+}
 
-    if (!isStreamInitialized() && !initStream())
+void CEdfFile::setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler)
+{
+    m_progressHandler = p_handler;
+}
+
+cv::Size CEdfFile::frameSize(const int p_index) const
+{
+    if (p_index < 0 || p_index >= frameCount())
     {
+        return cv::Size();
+    }
+    return cv::Size(m_frames[p_index].cols, m_frames[p_index].rows);
+}
+
+int CEdfFile::frameType(const int p_index) const
+{
+    if (p_index < 0 || p_index >= frameCount())
+    {
+        return -1;
+    }
+    return m_frames[p_index].type;
+}
+
+bool CEdfFile::loadHeader()
+{
+    QFile file(path());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't read from edf file:" << path();
+        qWarning() << "-- error:" << file.errorString();
         return false;
     }
 
-    stream()->seek(0);
-    while (!stream()->atEnd())
+    if (!indexFrames(file))
     {
-        const QString& line = stream()->readLine().trimmed();
+        return false;
+    }
+
+    m_currentFrame = 0;
+    setMetadata(m_frames[0].metadata);
+    return true;
+}
+
+bool CEdfFile::readHeader(QFile& p_file)
+{
+    // EDF headers are ASCII blocks padded to a multiple of 512 bytes.
+    // Read the file block by block and only scan raw bytes until the closing '}' line,
+    // so that the binary section is never loaded or decoded as text.
+    static const qint64 s_blockSize = 512;
 
-        if (line.isEmpty() || isBeginHeaderLine(line))
+    const qint64 base = p_file.pos();
+
+    QByteArray header;
+    qint64 lineStart = 0;
+    int lineCount    = 0;
+
+    while (true)
+    {
+        const qint64 lineStop = header.indexOf('\n', lineStart);
+        if (lineStop < 0)
         {
-            //qDebug() << "Skip empty / comment line" << line;
+            const QByteArray block = p_file.read(s_blockSize);
+            if (block.isEmpty())
+            {
+                if (m_headerStart < 0)
+                {
+                    // only padding until the end of file
+                    return false;
+                }
+                qWarning() << "Skip reading badly formed edf image: end of header section not found";
+                qWarning() << " -- file:" << path();
+                qWarning() << " -- expecting '}' character to end header section";
+                return false;
+            }
+            header.append(block);
             continue;
         }
 
-        if (isHeaderLine(line))
+        ++lineCount;
+        const QByteArray line = header.mid(lineStart, lineStop - lineStart).trimmed();
+
+        if (m_headerStart < 0)
         {
-            m_metadata.addProperty(parseHeaderLine(line));
-            //qDebug() << "Add property from header line" << line;
-            continue;
+            // Warning: can't compare the line with single char '{'
+            // because it may start with some 'invalid' characters.
+            if (line.endsWith('{'))
+            {
+                m_headerStart = base + lineStart;
+            }
+            else if (!line.isEmpty())
+            {
+                qWarning() << "Skip reading badly formed edf image: content found before header section";
+                qWarning() << " -- file:" << path();
+                qWarning() << " -- line" << lineCount << "starting with:" << line.left(10);
+                qWarning() << " -- expecting '{' character to start header section";
+                return false;
+            }
         }
-
-        if (isEndHeaderLine(line))
+        else if (line.endsWith('}'))
         {
-            break;
+            m_headerStop = base + lineStop + 1;
+            return true;
+        }
+        else if (!line.isEmpty())
+        {
+            const QString& property = QString::fromLatin1(line);
+            if (isHeaderLine(property))
+            {
+                m_metadata.addProperty(parseHeaderLine(property));
+            }
         }
 
-        break;
+        lineStart = lineStop + 1;
     }
-    closeStream();
-
-    return true;
 }
 
 bool CEdfFile::isHeaderLine(const QString& p_line) const
@@ -274,12 +411,27 @@ unsigned int CEdfFile::numericValue(const QString& p_property) const
 
 unsigned int CEdfFile::headerSize() const
 {
+    // The size declared in the header includes the padding after the '}' line
     const unsigned int size = static_cast<unsigned int>(m_headerStop - m_headerStart);
-    return (size > 0) ? size : numericValue("EDF_HeaderSize");
+    if (!metadata().value("EDF_HeaderSize").isEmpty())
+    {
+        const unsigned int declaredSize = numericValue("EDF_HeaderSize");
+        if (declaredSize >= size)
+        {
+            return declaredSize;
+        }
+        qWarning() << "Ignore invalid EDF_HeaderSize property:" << declaredSize << "is smaller than header section" << size;
+    }
+    return size;
 }
 
 unsigned int CEdfFile::readBinarySize() const
 {
+    if (!metadata().value("EDF_BinarySize").isEmpty())
+    {
+        return numericValue("EDF_BinarySize");
+    }
+
     static const QHash<int, unsigned int> s_sizes {{CV_8SC1, sizeof(char)},
                                                    {CV_8UC1, sizeof(unsigned char)},
                                                    {CV_16SC1, sizeof(short)},
@@ -292,7 +444,7 @@ unsigned int CEdfFile::readBinarySize() const
     Q_ASSERT_X(s_sizes.contains(type), "EDF reader", "Can't determine binary size from dimensions and datatype (unsupported image type)");
 
     const unsigned int elements = readRowCount() * readColumnCount();
-    return s_sizes.contains(type) ? s_sizes.value(type) * elements : numericValue("EDF_BinarySize");
+    return s_sizes.value(type) * elements;
 }
 
 unsigned int CEdfFile::readRowCount() const
@@ -329,7 +481,8 @@ void CEdfFile::clear()
     m_headerStop  = -1;
     m_data.release();
     m_metadata.clear();
-    closeStream();
+    m_frames.clear();
+    m_currentFrame = 0;
 }
 
 bool CEdfFile::save(bool p_createFile)
@@ -421,50 +574,6 @@ QString CEdfFile::matrixTypeToDataType(const int p_type) const
     return s_types.contains(p_type) ? s_types.value(p_type) : QString();
 }
 
-QTextStream* CEdfFile::stream() const
-{
-    return m_stream;
-}
-
-bool CEdfFile::initStream()
-{
-    if (m_file || m_stream)
-    {
-        qWarning() << "Skip stream initialization for file" << metadata().fileName();
-        return false;
-    }
-
-    QString path = metadata().absoluteFilePath();
-    m_file       = new QFile(metadata().absoluteFilePath());
-    if (!m_file->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        qWarning() << "Can't read from file:" << metadata().fileName();
-        return false;
-    }
-
-    m_stream = new QTextStream(m_file);
-    return true;
-}
-
-void CEdfFile::closeStream()
-{
-    if (m_file)
-    {
-        m_file->close();
-    }
-
-    delete m_file;
-    m_file = nullptr;
-
-    delete m_stream;
-    m_stream = nullptr;
-}
-
-bool CEdfFile::isStreamInitialized() const
-{
-    return m_stream != nullptr;
-}
-
 const CMetadata& CEdfFile::metadata() const
 {
     return m_metadata;
@@ -21,10 +21,11 @@
 #include "metadata.hh"
 
 #include <QString>
+#include <QVector>
+#include <functional>
 #include <opencv2/opencv.hpp>
 
 class QFile;
-class QTextStream;
 
 /**
  * @class CEdfFile
@@ -32,6 +33,9 @@ class QTextStream;
  *
  * Qt/OpenCV implementation for The ESRF (european synchrotron) image format following the specification available at:
  * https://www.esrf.fr/home/UsersAndScience/Experiments/CBS/ID02/available_software/saxs-program-package/implementation.html
+ *
+ * A file may contain several concatenated header+payload blocks (frames).
+ * All headers are indexed when reading the file but only the requested frame is decoded.
  */
 class CEdfFile
 {
@@ -49,6 +53,30 @@ public:
 
     bool read(const QString& p_path);
 
+    /// Returns the number of frames indexed in the file.
+    int frameCount() const;
+
+    /// Returns the index of the frame currently loaded in data().
+    int currentFrame() const;
+
+    /// Decodes frame \a p_index and makes it the current data and metadata.
+    bool readFrame(const int p_index);
+
+    /// Decodes frame \a p_index without changing the current frame.
+    cv::Mat decodeFrame(const int p_index) const;
+
+    /// Indexes the frames of \a p_path without decoding any of them: metadata() describes the first frame.
+    bool readHeaders(const QString& p_path);
+
+    /// Returns the dimensions of frame \a p_index.
+    cv::Size frameSize(const int p_index) const;
+
+    /// Returns the OpenCV type of frame \a p_index.
+    int frameType(const int p_index) const;
+
+    /// Sets the function called with the number of bytes decoded and the frame size by decodeFrame(): returning false cancels the decoding.
+    void setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler);
+
     bool isHeaderLine(const QString& p_line) const;
     bool isBeginHeaderLine(const QString& p_line) const;
     bool isEndHeaderLine(const QString& p_line) const;
@@ -66,6 +94,9 @@ protected:
     bool loadHeader();
 
 private:
+    bool indexFrames(QFile& p_file);
+    bool readHeader(QFile& p_file);
+
     bool checkRequiredHeaderProperties();
 
     unsigned int headerSize() const;
@@ -83,14 +114,6 @@ private:
     void updateHeader();
     QString matrixTypeToDataType(const int p_type) const;
 
-    QTextStream* stream() const;
-
-    bool initStream();
-
-    void closeStream();
-
-    bool isStreamInitialized() const;
-
 private:
     cv::Mat m_data;
     CMetadata m_metadata;
@@ -98,6 +121,17 @@ private:
     qint64 m_headerStart;
     qint64 m_headerStop;
 
-    QFile* m_file;
-    QTextStream* m_stream;
+    struct EdfFrame
+    {
+        CMetadata metadata;
+        qint64 offset;
+        int rows;
+        int cols;
+        int type;
+    };
+
+    QVector<EdfFrame> m_frames;
+    int m_currentFrame;
+
+    std::function<bool(qint64, qint64)> m_progressHandler;
 };
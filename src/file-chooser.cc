@@ -19,6 +19,7 @@
 #include "file-chooser.hh"
 
 #include "empty-icon-provider.hh"
+#include "matrix-converter.hh"
 
 #include <QApplication>
 #include <QBoxLayout>
@@ -29,6 +30,11 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QSettings>
+#include <QTimer>
+#include <QtConcurrent>
+
+/// Delay in milliseconds without path change before the file is probed
+static const int s_probeDelay = 250;
 
 CFileChooser::CFileChooser(QWidget *p_parent)
     : QWidget(p_parent)
@@ -41,6 +47,9 @@ CFileChooser::CFileChooser(QWidget *p_parent)
     , m_options()
     , m_completerModel(new QFileSystemModel(this))
     , m_completer(new QCompleter(this))
+    , m_probeTimer(new QTimer(this))
+    , m_probeWatcher()
+    , m_probedPath()
 {
     const int size = 22;
     m_button->setMinimumSize(QSize(size, size));
@@ -60,6 +69,11 @@ CFileChooser::CFileChooser(QWidget *p_parent)
     m_lineEdit->setCompleter(m_completer);
     connect(m_lineEdit, SIGNAL(textChanged(const QString &)), this, SLOT(setPath(const QString &)));
 
+    m_probeTimer->setSingleShot(true);
+    m_probeTimer->setInterval(s_probeDelay);
+    connect(m_probeTimer, SIGNAL(timeout()), SLOT(startProbe()));
+    connect(&m_probeWatcher, SIGNAL(finished()), SLOT(probeFinished()));
+
     QLayout *mainLayout = new QHBoxLayout;
     mainLayout->addWidget(m_lineEdit);
     mainLayout->addWidget(m_button);
@@ -155,11 +169,49 @@ void CFileChooser::setPath(const QString &p_path)
     if (fileInfo.isDir())
     {
         setDirectory(m_path);
+        m_lineEdit->setToolTip(QString());
     }
     else
     {
         setDirectory(fileInfo.dir());
+
+        // The tooltip describes the file once it has been probed
+        m_lineEdit->setToolTip(QString());
+        if (fileInfo.isFile() && CMatrixConverter::isFilenameSupported(m_path))
+        {
+            m_probeTimer->start();
+        }
     }
 
     emit(pathChanged(m_path));
 }
+
+void CFileChooser::startProbe()
+{
+    // a running probe restarts this one when it is over
+    if (m_probeWatcher.isRunning())
+    {
+        return;
+    }
+
+    // Some formats can only be described by loading them: the file is never read from the GUI thread
+    const QString path = m_path;
+    m_probedPath       = path;
+    m_probeWatcher.setFuture(QtConcurrent::run([path]() { return CMatrixConverter::probe(path).toString(); }));
+}
+
+void CFileChooser::probeFinished()
+{
+    if (m_probedPath != m_path)
+    {
+        // the path changed in the meantime
+        const QFileInfo fileInfo(m_path);
+        if (fileInfo.isFile() && CMatrixConverter::isFilenameSupported(m_path))
+        {
+            m_probeTimer->start();
+        }
+        return;
+    }
+
+    m_lineEdit->setToolTip(m_probeWatcher.result());
+}
@@ -21,6 +21,7 @@
 
 #include <QDir>
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QString>
 #include <QWidget>
 
@@ -28,6 +29,7 @@ class QLineEdit;
 class QPushButton;
 class QFileSystemModel;
 class QCompleter;
+class QTimer;
 
 /*!
   \file file-chooser.hh
@@ -127,6 +129,8 @@ signals:
 
 private slots:
     void browse();
+    void startProbe();
+    void probeFinished();
 
 private:
     QLineEdit* m_lineEdit;
@@ -138,4 +142,9 @@ private:
     QFileDialog::Options m_options;
     QFileSystemModel* m_completerModel;
     QCompleter* m_completer;
+
+    // the header of the selected file is probed in background once typing pauses
+    QTimer* m_probeTimer;
+    QFutureWatcher<QString> m_probeWatcher;
+    QString m_probedPath;
 };
@@ -18,6 +18,8 @@
 #include "histogram-widget.hh"
 
 #include "histogram.hh"
+#include "matrix-histogram.hh"
+#include "matrix-statistics.hh"
 
 #include <QBoxLayout>
 #include <QDebug>
@@ -26,46 +28,55 @@
 const QColor CHistogramWidget::_red(239, 41, 41);
 const QColor CHistogramWidget::_green(138, 226, 52);
 const QColor CHistogramWidget::_blue(114, 159, 207);
+const QColor CHistogramWidget::_gray(136, 138, 133);
 
-CHistogramWidget::CHistogramWidget(QWidget *p_parent)
-    : QWidget(p_parent)
-    , m_redHistogram(new CHistogram(_red))
-    , m_greenHistogram(new CHistogram(_green))
-    , m_blueHistogram(new CHistogram(_blue))
+CHistogramWidget::CHistogramWidget(QWidget *p_parent) : QWidget(p_parent), m_layout(new QVBoxLayout), m_histograms()
 {
     setStyleSheet("background: transparent;");
     setAttribute(Qt::WA_TranslucentBackground);
     setWindowFlags(Qt::FramelessWindowHint);
 
-    QVBoxLayout *mainLayout = new QVBoxLayout;
-    mainLayout->addWidget(m_redHistogram);
-    mainLayout->addWidget(m_greenHistogram);
-    mainLayout->addWidget(m_blueHistogram);
-    setLayout(mainLayout);
+    setLayout(m_layout);
 
     resize(sizeHint());
 }
 
 CHistogramWidget::~CHistogramWidget() { }
 
-void CHistogramWidget::setImage(QImage *p_image)
+QColor CHistogramWidget::channelColor(const int p_channel, const int p_channels) const
 {
-    QImage copy = p_image->convertToFormat(QImage::Format_ARGB32);
-    QVector<uint> redValues(256, 0), greenValues(256, 0), blueValues(256, 0);
-    for (int j = 0; j < p_image->height(); ++j)
+    // channels of color matrices are in BGR(A) order
+    if (p_channels < 3 || p_channel > 2)
     {
-        QRgb *row = reinterpret_cast<QRgb *>(copy.scanLine(j));
-        for (int i = 0; i < p_image->width(); ++i)
+        return _gray;
+    }
+
+    return (p_channel == 0) ? _blue : (p_channel == 1) ? _green : _red;
+}
+
+void CHistogramWidget::setHistogram(const CMatrixHistogram &p_histogram, const CMatrixStatistics &p_statistics)
+{
+    const int channels = (p_histogram.channels() == p_statistics.channels()) ? p_histogram.channels() : 0;
+    if (channels != m_histograms.size())
+    {
+        qDeleteAll(m_histograms);
+        m_histograms.clear();
+
+        // red, green and blue from top to bottom
+        for (int i = 0; i < channels; ++i)
         {
-            ++redValues[qRed(row[i])];
-            ++greenValues[qGreen(row[i])];
-            ++blueValues[qBlue(row[i])];
+            const int channel     = (channels >= 3 && i < 3) ? 2 - i : i;
+            CHistogram *histogram = new CHistogram(channelColor(channel, channels));
+            m_layout->addWidget(histogram);
+            m_histograms.append(histogram);
         }
     }
 
-    m_redHistogram->setValues(redValues);
-    m_greenHistogram->setValues(greenValues);
-    m_blueHistogram->setValues(blueValues);
+    for (int i = 0; i < channels; ++i)
+    {
+        const int channel = (channels >= 3 && i < 3) ? 2 - i : i;
+        m_histograms[i]->setHistogram(p_histogram, p_statistics, channel);
+    }
 }
 
 QSize CHistogramWidget::sizeHint() const
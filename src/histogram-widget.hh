@@ -20,18 +20,23 @@
 
 #include <QColor>
 #include <QSize>
+#include <QVector>
 #include <QWidget>
 
 class QPaintEvent;
+class QVBoxLayout;
 class CHistogram;
+class CMatrixHistogram;
+class CMatrixStatistics;
 
 /*!
   \file histogram-widget.hh
   \class CHistogramWidget
-  \brief CHistogramWidget displays the histogram of an image
+  \brief CHistogramWidget displays the histograms of a matrix
 
-  CHistogramWidget wraps three CHistogram corresponding
-  to RGB channels of a QImage.
+  CHistogramWidget wraps a CHistogram per channel of a CMatrixHistogram.
+  The histograms are computed by the model from the values of the matrix:
+  the widget only draws them.
 */
 class CHistogramWidget : public QWidget
 {
@@ -44,18 +49,20 @@ public:
     /// Destructor.
     ~CHistogramWidget() override;
 
-    void setImage(QImage *p_image);
+    void setHistogram(const CMatrixHistogram &p_histogram, const CMatrixStatistics &p_statistics);
 
 protected:
     QSize sizeHint() const override;
     void paintEvent(QPaintEvent *p_event) override;
 
 private:
-    CHistogram *m_redHistogram;
-    CHistogram *m_greenHistogram;
-    CHistogram *m_blueHistogram;
+    QColor channelColor(const int p_channel, const int p_channels) const;
+
+    QVBoxLayout *m_layout;
+    QVector<CHistogram *> m_histograms;
 
     static const QColor _red;
     static const QColor _green;
     static const QColor _blue;
+    static const QColor _gray;
 };
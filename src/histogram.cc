@@ -18,12 +18,14 @@
 
 #include "histogram.hh"
 
+#include "matrix-histogram.hh"
+
 #include <QBoxLayout>
 #include <QDebug>
 #include <QLabel>
 #include <QPainter>
 #include <QPixmap>
-#include <QtCore/qmath.h>
+#include <algorithm>
 #include <utility>
 
 CHistogram::CHistogram(QColor p_color, QWidget *p_parent)
@@ -31,6 +33,8 @@ CHistogram::CHistogram(QColor p_color, QWidget *p_parent)
     , m_color(std::move(p_color))
     , m_values()
     , m_pixmapLabel(new QLabel(this))
+    , m_lower(nullptr)
+    , m_upper(nullptr)
     , m_count(new QLabel(this))
     , m_min(new QLabel(this))
     , m_max(new QLabel(this))
@@ -64,50 +68,60 @@ CHistogram::CHistogram(QColor p_color, QWidget *p_parent)
 
 CHistogram::~CHistogram() { }
 
-void CHistogram::setValues(const QVector<uint> &p_values)
+void CHistogram::setHistogram(const CMatrixHistogram &p_histogram, const CMatrixStatistics &p_statistics, const int p_channel)
 {
-    m_values = p_values;
+    m_values = p_histogram.counts(p_channel);
+    m_lower->setText(QString::number(p_histogram.lower()));
+    m_upper->setText(QString::number(p_histogram.isEmpty() ? p_histogram.upper() : p_histogram.binValue(p_histogram.bins() - 1)));
 
     drawPixmap();
-    computeStats();
+    showStatistics(p_statistics.channel(p_channel));
 }
 
-QBoxLayout *CHistogram::makeAxisBar() const
+QBoxLayout *CHistogram::makeAxisBar()
 {
     QString css = QString("QLabel{background-color: "
                           "qlineargradient(x1: 0, y1: 0, x2: 1, y2: 0, "
                           "stop: 0 black, stop: 1 %1);}")
                       .arg(m_color.name());
 
-    QLabel *begin = new QLabel("0");
-    QLabel *end   = new QLabel("255");
+    m_lower = new QLabel("0");
+    m_upper = new QLabel("255");
 
     QLabel *gradient = new QLabel;
     gradient->setStyleSheet(css);
 
     QBoxLayout *mainLayout = new QHBoxLayout;
-    mainLayout->addWidget(begin);
+    mainLayout->addWidget(m_lower);
     mainLayout->addWidget(gradient, 1);
-    mainLayout->addWidget(end);
+    mainLayout->addWidget(m_upper);
 
     return mainLayout;
 }
 
 void CHistogram::drawPixmap()
 {
-    // normalize histogram
-    const qreal max = *std::max_element(m_values.begin(), m_values.end());
+    QPixmap pixmap(300, 50);
+    pixmap.fill(Qt::white);
+
+    // bins are summed by columns of the pixmap when there are more bins than columns
+    const int columns = qMin(m_values.size(), pixmap.width());
+    QVector<qreal> normalizedValues(columns, 0);
+    for (int i = 0; i < m_values.size(); ++i)
+    {
+        normalizedValues[static_cast<int>(static_cast<qint64>(i) * columns / m_values.size())] += m_values[i];
+    }
 
-    QVector<qreal> normalizedValues(m_values.size(), 0);
+    // normalize histogram
+    const qreal max = normalizedValues.empty() ? 0 : *std::max_element(normalizedValues.begin(), normalizedValues.end());
     if (max > 0.0)
     {
-        for (int i = 0; i < 256; ++i)
+        for (qreal &value : normalizedValues)
         {
-            normalizedValues[i] = m_values[i] / max;
+            value /= max;
         }
     }
 
-    QPixmap pixmap(300, 50);
     QPainter painter(&pixmap);
 
     const qreal w        = pixmap.width();
@@ -119,49 +133,18 @@ void CHistogram::drawPixmap()
         const qreal barHeight = normalizedValues[i] * h;
 
         // draw bar
-        painter.fillRect(barWidth * i,
-                         h - barHeight, /* origin */
-                         barWidth * (i + 1),
-                         h, /* size */
-                         m_color);
-
-        // fill the rest of the pixmap
-        painter.fillRect(barWidth * i,
-                         0, /* origin */
-                         barWidth * (i + 1),
-                         h - barHeight, /* size */
-                         Qt::white);
+        painter.fillRect(QRectF(barWidth * i, h - barHeight, barWidth, barHeight), m_color);
     }
 
     m_pixmapLabel->setPixmap(pixmap);
 }
 
-void CHistogram::computeStats()
+void CHistogram::showStatistics(const CMatrixStatistics::ChannelStatistics &p_statistics)
 {
-    uint squareSum = 0;
-    uint sum       = 0;
-    int min        = 255;
-    int max        = 0;
-    int count      = 0;
-
-    for (int i = 0; i < m_values.size(); ++i)
-    {
-        sum += i * m_values[i];
-        squareSum += i * i * m_values[i];
-
-        min = qMin(min, i);
-        max = qMax(max, i);
-        count += m_values[i];
-    }
-
-    const double mean              = (count == 0) ? 0.0 : sum / (double) count;
-    const double meanSquare        = (count == 0) ? 0.0 : squareSum / (double) count;
-    const double standardDeviation = qSqrt(qAbs(meanSquare - mean * mean));
-
     // update labels
-    m_count->setText(tr("Count: %1").arg(count));
-    m_min->setText(tr("Min: %1").arg(min));
-    m_max->setText(tr("Max: %1").arg(max));
-    m_mean->setText(tr("Mean: %1").arg(mean));
-    m_standardDeviation->setText(tr("StdDev: %1").arg(standardDeviation));
+    m_count->setText(tr("Count: %1").arg(p_statistics.count));
+    m_min->setText(tr("Min: %1").arg(p_statistics.count > 0 ? p_statistics.min : 0));
+    m_max->setText(tr("Max: %1").arg(p_statistics.count > 0 ? p_statistics.max : 0));
+    m_mean->setText(tr("Mean: %1").arg(p_statistics.mean()));
+    m_standardDeviation->setText(tr("StdDev: %1").arg(p_statistics.standardDeviation()));
 }
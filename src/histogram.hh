@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include "matrix-statistics.hh"
+
 #include <QColor>
 #include <QVector>
 #include <QWidget>
@@ -30,8 +32,9 @@ class QLabel;
   \class CHistogram
   \brief CHistogram displays histogram and statistics from a set of values.
 
-  Values typically correspond to pixel data from an image.
-  Statistics include min/max values, mean and standard deviation.
+  Values correspond to a channel of a CMatrixHistogram, in the native type of the matrix.
+  Statistics are read from the CMatrixStatistics of the matrix: they include
+  min/max values, mean and standard deviation.
 */
 class CHistogram : public QWidget
 {
@@ -41,18 +44,23 @@ public:
     CHistogram(QColor p_color, QWidget *p_parent = nullptr);
     ~CHistogram() override;
 
-    void setValues(const QVector<uint> &p_values);
+    /*!
+    Displays the bins and the statistics of the channel \a p_channel.
+  */
+    void setHistogram(const CMatrixHistogram &p_histogram, const CMatrixStatistics &p_statistics, const int p_channel);
 
 private:
     void drawPixmap();
-    void computeStats();
-    QBoxLayout *makeAxisBar() const;
+    void showStatistics(const CMatrixStatistics::ChannelStatistics &p_statistics);
+    QBoxLayout *makeAxisBar();
 
 private:
     QColor m_color;
-    QVector<uint> m_values;
+    QVector<quint64> m_values;
 
     QLabel *m_pixmapLabel;
+    QLabel *m_lower;
+    QLabel *m_upper;
     QLabel *m_count;
     QLabel *m_min;
     QLabel *m_max;
@@ -0,0 +1,409 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "history.hh"
+
+#include <algorithm>
+#include <cstring>
+
+// Large enough to keep the number of blocks low, small enough to share most of an operation's untouched data
+static const int s_blockSize = 256 * 1024;
+
+CHistory::CHistory(const qint64 p_memoryLimit)
+    : m_undo()
+    , m_redo()
+    , m_memoryLimit(p_memoryLimit)
+    , m_memoryUsage(0)
+    , m_blockReferences()
+    , m_isGroupOpen(false)
+    , m_isGroupModified(false)
+{
+}
+
+CHistory::~CHistory() { }
+
+int CHistory::blockSize()
+{
+    return s_blockSize;
+}
+
+qint64 CHistory::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+void CHistory::setMemoryLimit(const qint64 p_bytes)
+{
+    if (p_bytes != m_memoryLimit)
+    {
+        m_memoryLimit = p_bytes;
+        trim();
+    }
+}
+
+qint64 CHistory::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+bool CHistory::canUndo() const
+{
+    return !m_isGroupOpen && !m_undo.isEmpty();
+}
+
+bool CHistory::canRedo() const
+{
+    return !m_isGroupOpen && !m_redo.isEmpty();
+}
+
+bool CHistory::recordSnapshot(const cv::Mat& p_data)
+{
+    clearEntries(m_redo);
+    if (m_isGroupOpen)
+    {
+        m_isGroupModified = true;
+        return true;
+    }
+
+    // The snapshot would be dropped right away: the matrix is not even copied
+    if (dataSize(p_data) > m_memoryLimit)
+    {
+        clearEntries(m_undo);
+        return false;
+    }
+
+    appendEntry(m_undo, HistoryEntry{false, takeSnapshot(p_data, lastSnapshot(p_data)), QPoint(), QByteArray(), QByteArray()});
+    trim();
+    return true;
+}
+
+void CHistory::recordCellEdit(const QPoint& p_cell, const QByteArray& p_before, const QByteArray& p_after)
+{
+    clearEntries(m_redo);
+    if (m_isGroupOpen)
+    {
+        m_isGroupModified = true;
+        return;
+    }
+
+    appendEntry(m_undo, HistoryEntry{true, Snapshot{0, 0, 0, QVector<QByteArray>(), cv::Mat()}, p_cell, p_before, p_after});
+    trim();
+}
+
+bool CHistory::undo(cv::Mat& p_data, QRect* p_cells)
+{
+    if (!canUndo())
+    {
+        return false;
+    }
+
+    const HistoryEntry& entry = m_undo.last();
+    if (entry.isCellEdit)
+    {
+        if (!writeCell(p_data, entry.cell, entry.before))
+        {
+            removeEntry(m_undo, m_undo.size() - 1);
+            return false;
+        }
+
+        *p_cells = QRect(entry.cell, QSize(1, 1));
+        m_redo << m_undo.takeLast();
+        return true;
+    }
+
+    // the current matrix is kept to redo the operation
+    HistoryEntry current{false, takeSnapshot(p_data, &entry.snapshot), QPoint(), QByteArray(), QByteArray()};
+    p_data   = restoreSnapshot(entry.snapshot);
+    *p_cells = QRect();
+
+    appendEntry(m_redo, current);
+    removeEntry(m_undo, m_undo.size() - 1);
+    trim();
+    return true;
+}
+
+bool CHistory::redo(cv::Mat& p_data, QRect* p_cells)
+{
+    if (!canRedo())
+    {
+        return false;
+    }
+
+    const HistoryEntry& entry = m_redo.last();
+    if (entry.isCellEdit)
+    {
+        if (!writeCell(p_data, entry.cell, entry.after))
+        {
+            removeEntry(m_redo, m_redo.size() - 1);
+            return false;
+        }
+
+        *p_cells = QRect(entry.cell, QSize(1, 1));
+        m_undo << m_redo.takeLast();
+        return true;
+    }
+
+    // the current matrix is kept to undo the operation again
+    HistoryEntry current{false, takeSnapshot(p_data, &entry.snapshot), QPoint(), QByteArray(), QByteArray()};
+    p_data   = restoreSnapshot(entry.snapshot);
+    *p_cells = QRect();
+
+    appendEntry(m_undo, current);
+    removeEntry(m_redo, m_redo.size() - 1);
+    trim();
+    return true;
+}
+
+bool CHistory::beginGroup(const cv::Mat& p_data)
+{
+    if (m_isGroupOpen)
+    {
+        return true;
+    }
+
+    // the entry of an open group is never dropped: it must fit in the limit
+    if (dataSize(p_data) > m_memoryLimit)
+    {
+        return false;
+    }
+
+    // the redo entries are only discarded if an edit is recorded in the group
+    appendEntry(m_undo, HistoryEntry{false, takeSnapshot(p_data, lastSnapshot(p_data)), QPoint(), QByteArray(), QByteArray()});
+    m_isGroupOpen     = true;
+    m_isGroupModified = false;
+    trim();
+    return true;
+}
+
+void CHistory::endGroup()
+{
+    if (!m_isGroupOpen)
+    {
+        return;
+    }
+
+    m_isGroupOpen = false;
+    if (!m_isGroupModified && !m_undo.isEmpty())
+    {
+        removeEntry(m_undo, m_undo.size() - 1);
+    }
+    trim();
+}
+
+bool CHistory::isGroupOpen() const
+{
+    return m_isGroupOpen;
+}
+
+bool CHistory::restoreGroup(cv::Mat& p_data)
+{
+    if (!m_isGroupOpen || m_undo.isEmpty())
+    {
+        return false;
+    }
+
+    p_data            = restoreSnapshot(m_undo.last().snapshot);
+    m_isGroupModified = false;
+    return true;
+}
+
+void CHistory::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_blockReferences.clear();
+    m_isGroupOpen     = false;
+    m_isGroupModified = false;
+    m_memoryUsage     = 0;
+}
+
+bool CHistory::isShared(const cv::Mat& p_data) const
+{
+    return !p_data.empty() && m_blockReferences.contains(reinterpret_cast<const char*>(p_data.data));
+}
+
+CHistory::Snapshot CHistory::takeSnapshot(const cv::Mat& p_data, const Snapshot* p_reference) const
+{
+    // Buffers allocated by OpenCV are shared: the model copies them before modifying them in place
+    if (p_data.u != nullptr && p_data.isContinuous())
+    {
+        return Snapshot{p_data.rows, p_data.cols, p_data.type(), QVector<QByteArray>(), p_data};
+    }
+
+    const cv::Mat continuous = p_data.isContinuous() ? p_data : p_data.clone();
+
+    Snapshot snapshot{continuous.rows, continuous.cols, continuous.type(), QVector<QByteArray>(), cv::Mat()};
+
+    // Blocks are only compared with the blocks of a snapshot with the same layout
+    const bool isComparable = p_reference != nullptr && p_reference->rows == snapshot.rows && p_reference->cols == snapshot.cols
+                              && p_reference->type == snapshot.type && p_reference->values.empty();
+
+    const size_t size = continuous.total() * continuous.elemSize();
+    const char* data  = reinterpret_cast<const char*>(continuous.data);
+    snapshot.blocks.reserve(static_cast<int>((size + s_blockSize - 1) / s_blockSize));
+    for (size_t offset = 0; offset < size; offset += s_blockSize)
+    {
+        const int length = static_cast<int>(std::min<size_t>(s_blockSize, size - offset));
+        const int block  = static_cast<int>(offset / s_blockSize);
+        if (isComparable && std::memcmp(p_reference->blocks[block].constData(), data + offset, length) == 0)
+        {
+            snapshot.blocks << p_reference->blocks[block];
+        }
+        else
+        {
+            snapshot.blocks << QByteArray(data + offset, length);
+        }
+    }
+
+    return snapshot;
+}
+
+const CHistory::Snapshot* CHistory::lastSnapshot(const cv::Mat& p_data) const
+{
+    for (int i = m_undo.size() - 1; i >= 0; --i)
+    {
+        const Snapshot& snapshot = m_undo[i].snapshot;
+        if (!m_undo[i].isCellEdit && snapshot.rows == p_data.rows && snapshot.cols == p_data.cols && snapshot.type == p_data.type())
+        {
+            return &snapshot;
+        }
+    }
+
+    for (int i = m_redo.size() - 1; i >= 0; --i)
+    {
+        const Snapshot& snapshot = m_redo[i].snapshot;
+        if (!m_redo[i].isCellEdit && snapshot.rows == p_data.rows && snapshot.cols == p_data.cols && snapshot.type == p_data.type())
+        {
+            return &snapshot;
+        }
+    }
+
+    return nullptr;
+}
+
+cv::Mat CHistory::restoreSnapshot(const Snapshot& p_snapshot)
+{
+    // the restored matrix is modified in place afterwards: it never shares the buffer of a snapshot
+    if (!p_snapshot.values.empty())
+    {
+        return p_snapshot.values.clone();
+    }
+
+    cv::Mat data(p_snapshot.rows, p_snapshot.cols, p_snapshot.type);
+
+    uchar* cursor = data.data;
+    for (const QByteArray& block : p_snapshot.blocks)
+    {
+        std::memcpy(cursor, block.constData(), block.size());
+        cursor += block.size();
+    }
+
+    return data;
+}
+
+qint64 CHistory::dataSize(const cv::Mat& p_data)
+{
+    return static_cast<qint64>(p_data.total() * p_data.elemSize());
+}
+
+bool CHistory::writeCell(cv::Mat& p_data, const QPoint& p_cell, const QByteArray& p_value)
+{
+    if (p_cell.y() < 0 || p_cell.y() >= p_data.rows || p_cell.x() < 0 || p_cell.x() >= p_data.cols
+        || static_cast<size_t>(p_value.size()) != p_data.elemSize())
+    {
+        return false;
+    }
+
+    std::memcpy(p_data.ptr(p_cell.y(), p_cell.x()), p_value.constData(), p_value.size());
+    return true;
+}
+
+void CHistory::trim()
+{
+    // Drop the oldest entries first, but never the entry of an open group
+    while (m_memoryUsage > m_memoryLimit)
+    {
+        if (m_undo.size() > (m_isGroupOpen ? 1 : 0))
+        {
+            removeEntry(m_undo, 0);
+        }
+        else if (!m_redo.isEmpty())
+        {
+            removeEntry(m_redo, 0);
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+void CHistory::appendEntry(QVector<HistoryEntry>& p_entries, const HistoryEntry& p_entry)
+{
+    // The memory usage is kept up to date: a block is only counted by the first entry that references it
+    m_memoryUsage += p_entry.before.size() + p_entry.after.size();
+    if (!p_entry.snapshot.values.empty())
+    {
+        int& references = m_blockReferences[reinterpret_cast<const char*>(p_entry.snapshot.values.data)];
+        if (references++ == 0)
+        {
+            m_memoryUsage += dataSize(p_entry.snapshot.values);
+        }
+    }
+    for (const QByteArray& block : p_entry.snapshot.blocks)
+    {
+        int& references = m_blockReferences[block.constData()];
+        if (references++ == 0)
+        {
+            m_memoryUsage += block.size();
+        }
+    }
+    p_entries << p_entry;
+}
+
+void CHistory::removeEntry(QVector<HistoryEntry>& p_entries, const int p_index)
+{
+    const HistoryEntry& entry = p_entries[p_index];
+    m_memoryUsage -= entry.before.size() + entry.after.size();
+    if (!entry.snapshot.values.empty())
+    {
+        QHash<const char*, int>::iterator it = m_blockReferences.find(reinterpret_cast<const char*>(entry.snapshot.values.data));
+        if (it != m_blockReferences.end() && --it.value() == 0)
+        {
+            m_blockReferences.erase(it);
+            m_memoryUsage -= dataSize(entry.snapshot.values);
+        }
+    }
+    for (const QByteArray& block : entry.snapshot.blocks)
+    {
+        QHash<const char*, int>::iterator it = m_blockReferences.find(block.constData());
+        if (it != m_blockReferences.end() && --it.value() == 0)
+        {
+            m_blockReferences.erase(it);
+            m_memoryUsage -= block.size();
+        }
+    }
+    p_entries.remove(p_index);
+}
+
+void CHistory::clearEntries(QVector<HistoryEntry>& p_entries)
+{
+    while (!p_entries.isEmpty())
+    {
+        removeEntry(p_entries, p_entries.size() - 1);
+    }
+}
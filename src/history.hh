@@ -0,0 +1,177 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file history.hh
+  \class CHistory
+  \brief CHistory records the edits of a matrix so that they can be undone and redone
+
+  Operations on the whole matrix are recorded as snapshots of the matrix
+  before the operation. A matrix that owns its buffer is not copied: the snapshot
+  shares the buffer, which must no longer be modified in place (see isShared()).
+  Other matrices (mapped files) are copied in blocks of blockSize() bytes
+  that are implicitly shared (QByteArray): a block that did not change since
+  the previous snapshot is shared instead of being copied again, so that
+  successive snapshots only cost the blocks that an operation modified.
+
+  Cell edits are recorded as deltas: the position of the cell and its value
+  before and after the edit.
+
+  The memory used by the recorded snapshots and deltas is bounded by
+  memoryLimit(): the oldest entries are dropped first once it is reached.
+  A matrix larger than the limit is not recorded at all.
+
+  A group merges all the edits made between beginGroup() and endGroup() into
+  a single entry. While a group is open, restoreGroup() restores the matrix
+  as it was when the group began, which allows to try several parameters
+  of an operation from the same original matrix.
+*/
+class CHistory
+{
+public:
+    /// Constructor.
+    CHistory(const qint64 p_memoryLimit = 512 * 1024 * 1024);
+
+    /// Destructor.
+    ~CHistory();
+
+    CHistory(const CHistory &) = delete;
+    CHistory &operator=(const CHistory &) = delete;
+
+    static int blockSize();
+
+    qint64 memoryLimit() const;
+
+    /*!
+    Sets the maximum number of bytes used by the history to \a p_bytes.
+    The oldest entries are dropped if the history is larger.
+  */
+    void setMemoryLimit(const qint64 p_bytes);
+
+    /*!
+    Returns the number of bytes used by the history.
+    Blocks shared between several snapshots are only counted once.
+  */
+    qint64 memoryUsage() const;
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    /*!
+    Records \a p_data before it is modified by an operation.
+    The edits that could be redone are discarded.
+    Returns \a false if \a p_data is larger than memoryLimit(): nothing is recorded
+    and the history is cleared since the previous edits can no longer be undone.
+  */
+    bool recordSnapshot(const cv::Mat &p_data);
+
+    /*!
+    Records the edition of the cell \a p_cell (x is the column, y the row)
+    from the value \a p_before to the value \a p_after, as raw bytes.
+  */
+    void recordCellEdit(const QPoint &p_cell, const QByteArray &p_before, const QByteArray &p_after);
+
+    /*!
+    Restores \a p_data as it was before the last edit.
+    Sets \a p_cells to the modified cells, or to an invalid rectangle if the whole matrix changed.
+    Returns \a false if there is nothing to undo.
+  */
+    bool undo(cv::Mat &p_data, QRect *p_cells);
+
+    /*!
+    Applies again the last undone edit on \a p_data.
+    Sets \a p_cells to the modified cells, or to an invalid rectangle if the whole matrix changed.
+    Returns \a false if there is nothing to redo.
+  */
+    bool redo(cv::Mat &p_data, QRect *p_cells);
+
+    /*!
+    Begins a group of edits of \a p_data that are undone as a single one.
+    Returns \a false if \a p_data is larger than memoryLimit(): no group is opened.
+    \sa endGroup, restoreGroup
+  */
+    bool beginGroup(const cv::Mat &p_data);
+
+    /*!
+    Ends the current group. The group is dropped if no edit was recorded in the meantime.
+  */
+    void endGroup();
+
+    bool isGroupOpen() const;
+
+    /*!
+    Restores \a p_data as it was when the current group began.
+    Returns \a false if no group is open.
+  */
+    bool restoreGroup(cv::Mat &p_data);
+
+    void clear();
+
+    /*!
+    Returns \a true if a snapshot shares the buffer of \a p_data,
+    which must then be copied before it is modified in place.
+  */
+    bool isShared(const cv::Mat &p_data) const;
+
+private:
+    struct Snapshot
+    {
+        int rows;
+        int cols;
+        int type;
+        QVector<QByteArray> blocks;
+        cv::Mat values;
+    };
+
+    struct HistoryEntry
+    {
+        bool isCellEdit;
+        Snapshot snapshot;
+        QPoint cell;
+        QByteArray before;
+        QByteArray after;
+    };
+
+    Snapshot takeSnapshot(const cv::Mat &p_data, const Snapshot *p_reference) const;
+    const Snapshot *lastSnapshot(const cv::Mat &p_data) const;
+    static cv::Mat restoreSnapshot(const Snapshot &p_snapshot);
+    static qint64 dataSize(const cv::Mat &p_data);
+    static bool writeCell(cv::Mat &p_data, const QPoint &p_cell, const QByteArray &p_value);
+
+    void trim();
+    void appendEntry(QVector<HistoryEntry> &p_entries, const HistoryEntry &p_entry);
+    void removeEntry(QVector<HistoryEntry> &p_entries, const int p_index);
+    void clearEntries(QVector<HistoryEntry> &p_entries);
+
+    QVector<HistoryEntry> m_undo;
+    QVector<HistoryEntry> m_redo;
+    qint64 m_memoryLimit;
+    qint64 m_memoryUsage;
+    QHash<const char *, int> m_blockReferences;
+    bool m_isGroupOpen;
+    bool m_isGroupModified;
+};
@@ -0,0 +1,118 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "image-item.hh"
+
+#include "image-pyramid.hh"
+
+#include <QImage>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadPool>
+
+CImageItem::CImageItem(const std::shared_ptr<CImagePyramid> &p_pyramid, QGraphicsItem *p_parent) : QGraphicsObject(p_parent), m_pyramid(p_pyramid)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    connect(m_pyramid.get(), SIGNAL(tileRendered(const QRect &)), this, SLOT(updateRect(const QRect &)));
+
+    // The single tile of the coarsest level is a preview of the whole image
+    // that is displayed until the tiles of the current level are rendered
+    requestTile(m_pyramid->levelCount() - 1, QPoint(0, 0));
+}
+
+CImageItem::~CImageItem() { }
+
+QRectF CImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), m_pyramid->size());
+}
+
+void CImageItem::paint(QPainter *p_painter, const QStyleOptionGraphicsItem *p_option, QWidget *p_widget)
+{
+    Q_UNUSED(p_widget);
+
+    const QRect bounds(QPoint(0, 0), m_pyramid->size());
+    const QRect exposed = p_option->exposedRect.toAlignedRect() & bounds;
+    if (exposed.isEmpty())
+    {
+        return;
+    }
+
+    const int level = m_pyramid->levelForScale(QStyleOptionGraphicsItem::levelOfDetailFromTransform(p_painter->worldTransform()));
+    const int span  = CImagePyramid::tileSize() << level;
+
+    for (int y = exposed.top() / span; y <= exposed.bottom() / span; ++y)
+    {
+        for (int x = exposed.left() / span; x <= exposed.right() / span; ++x)
+        {
+            const QPoint tile(x, y);
+            const QRect cells = CImagePyramid::tileCells(level, tile) & bounds;
+
+            QImage image;
+            if (m_pyramid->tile(level, tile, image))
+            {
+                p_painter->drawImage(QRectF(cells), image, QRectF(0, 0, qreal(cells.width()) / (1 << level), qreal(cells.height()) / (1 << level)));
+                continue;
+            }
+
+            requestTile(level, tile);
+
+            // Meanwhile, display the part of a coarser tile that covers the same cells
+            for (int coarser = level + 1; coarser < m_pyramid->levelCount(); ++coarser)
+            {
+                const QPoint parent(x >> (coarser - level), y >> (coarser - level));
+                if (m_pyramid->tile(coarser, parent, image))
+                {
+                    const QRectF source(QRectF(cells.translated(-CImagePyramid::tileCells(coarser, parent).topLeft())));
+                    const qreal scale = 1 << coarser;
+                    p_painter->drawImage(QRectF(cells), image, QRectF(source.topLeft() / scale, source.size() / scale));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void CImageItem::updateRect(const QRect &p_rect)
+{
+    update(QRectF(p_rect));
+}
+
+void CImageItem::requestTile(const int p_level, const QPoint &p_tile)
+{
+    if (!m_pyramid->acquire(p_level, p_tile))
+    {
+        return;
+    }
+
+    // The task shares the pyramid and the mapped file of its data: tiles of a pyramid replaced in the meantime are skipped.
+    // Tiles rendered while the data are modified are dropped by the invalidation.
+    const std::shared_ptr<CImagePyramid> pyramid = m_pyramid;
+    const std::shared_ptr<CMappedFile> mapping   = m_pyramid->mapping();
+    QThreadPool::globalInstance()->start(
+        [pyramid, mapping, p_level, p_tile]()
+        {
+            Q_UNUSED(mapping); // keeps the mapped file alive until the task is over
+            if (pyramid->isCanceled())
+            {
+                return;
+            }
+
+            const quint64 generation = pyramid->generation();
+            pyramid->insert(p_level, p_tile, pyramid->render(p_level, p_tile), generation);
+        });
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QGraphicsObject>
+#include <memory>
+
+class CImagePyramid;
+
+/*!
+  \file image-item.hh
+  \class CImageItem
+  \brief CImageItem is a graphics item that displays a matrix by tiles
+
+  Unlike QGraphicsPixmapItem, the item never holds the whole image: it only
+  paints the tiles of the CImagePyramid that intersect the exposed area, at the
+  level that matches the current zoom. Tiles that are not rendered yet are
+  requested in background and temporarily replaced by a coarser cached tile.
+  Modified pixels are displayed by calling updateRect() once the pyramid has
+  been invalidated.
+*/
+class CImageItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    /// Constructor.
+    CImageItem(const std::shared_ptr<CImagePyramid> &p_pyramid, QGraphicsItem *p_parent = nullptr);
+
+    /// Destructor.
+    ~CImageItem() override;
+
+    QRectF boundingRect() const override;
+
+    void paint(QPainter *p_painter, const QStyleOptionGraphicsItem *p_option, QWidget *p_widget = nullptr) override;
+
+public slots:
+    /*!
+    Schedules a repaint of the pixels \a p_rect of the image after they have been modified.
+  */
+    void updateRect(const QRect &p_rect);
+
+private:
+    void requestTile(const int p_level, const QPoint &p_tile);
+
+    std::shared_ptr<CImagePyramid> m_pyramid;
+};
@@ -0,0 +1,216 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "image-pyramid.hh"
+
+#include "matrix-model.hh"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+static const int s_tileSize = 256;
+
+// Cost of the cached tiles, in KiB
+static const int s_maxCost = 256 * 1024;
+
+CImagePyramid::CImagePyramid(const cv::Mat &p_data, const std::shared_ptr<CMappedFile> &p_mapping, const double p_min, const double p_max)
+    : QObject()
+    , m_data(p_data)
+    , m_mapping(p_mapping)
+    , m_min(p_min)
+    , m_max(p_max)
+    , m_levelCount(1)
+    , m_mutex()
+    , m_tiles(s_maxCost)
+    , m_pending()
+    , m_generation(0)
+    , m_canceled(false)
+{
+    while ((s_tileSize << (m_levelCount - 1)) < qMax(m_data.cols, m_data.rows))
+    {
+        ++m_levelCount;
+    }
+}
+
+CImagePyramid::~CImagePyramid() { }
+
+int CImagePyramid::tileSize()
+{
+    return s_tileSize;
+}
+
+QRect CImagePyramid::tileCells(const int p_level, const QPoint &p_tile)
+{
+    const int span = s_tileSize << p_level;
+    return QRect(p_tile.x() * span, p_tile.y() * span, span, span);
+}
+
+quint64 CImagePyramid::key(const int p_level, const QPoint &p_tile)
+{
+    return (static_cast<quint64>(p_level) << 56) | (static_cast<quint64>(p_tile.y()) << 28) | static_cast<quint64>(p_tile.x());
+}
+
+QSize CImagePyramid::size() const
+{
+    return QSize(m_data.cols, m_data.rows);
+}
+
+const cv::Mat &CImagePyramid::data() const
+{
+    return m_data;
+}
+
+const std::shared_ptr<CMappedFile> &CImagePyramid::mapping() const
+{
+    return m_mapping;
+}
+
+int CImagePyramid::maxCost() const
+{
+    return m_tiles.maxCost();
+}
+
+int CImagePyramid::levelCount() const
+{
+    return m_levelCount;
+}
+
+int CImagePyramid::levelForScale(const qreal p_scale) const
+{
+    int level = 0;
+    while (level + 1 < m_levelCount && p_scale * (1 << (level + 1)) <= 1)
+    {
+        ++level;
+    }
+    return level;
+}
+
+bool CImagePyramid::tile(const int p_level, const QPoint &p_tile, QImage &p_image)
+{
+    QMutexLocker locker(&m_mutex);
+    const QImage *image = m_tiles.object(key(p_level, p_tile));
+    if (image == nullptr)
+    {
+        return false;
+    }
+
+    p_image = *image;
+    return true;
+}
+
+bool CImagePyramid::acquire(const int p_level, const QPoint &p_tile)
+{
+    const quint64 tileKey = key(p_level, p_tile);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_tiles.contains(tileKey) || m_pending.contains(tileKey))
+    {
+        return false;
+    }
+
+    m_pending.insert(tileKey);
+    return true;
+}
+
+QImage CImagePyramid::render(const int p_level, const QPoint &p_tile) const
+{
+    const QRect cells = tileCells(p_level, p_tile) & QRect(0, 0, m_data.cols, m_data.rows);
+    if (cells.isEmpty())
+    {
+        return QImage();
+    }
+
+    // A pixel of the level covers (scale x scale) cells, less on the right and bottom borders
+    const int scale = 1 << p_level;
+    const cv::Size size((cells.width() + scale - 1) / scale, (cells.height() + scale - 1) / scale);
+
+    QImage image(size.width, size.height, QImage::Format_RGB888);
+    try
+    {
+        cv::Mat values = m_data(cv::Rect(cells.x(), cells.y(), cells.width(), cells.height()));
+        if (p_level > 0)
+        {
+            cv::Mat sampled;
+            cv::resize(values, sampled, size, 0, 0, cv::INTER_NEAREST);
+            values = sampled;
+        }
+
+        if (!CMatrixModel::renderImage(values, image, QPoint(0, 0), m_min, m_max))
+        {
+            return QImage();
+        }
+    }
+    catch (cv::Exception &e)
+    {
+        qWarning() << "Can't sample image tile";
+        qWarning() << "-- error:" << e.what();
+        return QImage();
+    }
+
+    return image;
+}
+
+bool CImagePyramid::insert(const int p_level, const QPoint &p_tile, const QImage &p_image, const quint64 p_generation)
+{
+    const quint64 tileKey = key(p_level, p_tile);
+    bool inserted         = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.remove(tileKey);
+        if (p_generation == m_generation && !p_image.isNull())
+        {
+            m_tiles.insert(tileKey, new QImage(p_image), qMax(1, static_cast<int>(p_image.sizeInBytes() / 1024)));
+            inserted = true;
+        }
+    }
+
+    // a dropped tile is repainted, hence requested again
+    emit tileRendered(tileCells(p_level, p_tile) & QRect(0, 0, m_data.cols, m_data.rows));
+    return inserted;
+}
+
+quint64 CImagePyramid::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void CImagePyramid::invalidate(const QRect &p_cells)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+
+    for (const quint64 tileKey : m_tiles.keys())
+    {
+        const int level = static_cast<int>(tileKey >> 56);
+        const QPoint tile(static_cast<int>(tileKey & 0xfffffff), static_cast<int>((tileKey >> 28) & 0xfffffff));
+        if (tileCells(level, tile).intersects(p_cells))
+        {
+            m_tiles.remove(tileKey);
+        }
+    }
+}
+
+void CImagePyramid::cancel()
+{
+    m_canceled = true;
+}
+
+bool CImagePyramid::isCanceled() const
+{
+    return m_canceled;
+}
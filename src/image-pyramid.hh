@@ -0,0 +1,155 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QSet>
+#include <atomic>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+class CMappedFile;
+
+/*!
+  \file image-pyramid.hh
+  \class CImagePyramid
+  \brief CImagePyramid renders a matrix as an image by tiles at several resolutions
+
+  The image is split in tiles of tileSize() x tileSize() pixels at power-of-two
+  levels: a pixel of the level L covers 2^L x 2^L cells of the matrix, so that
+  the whole matrix fits in a single tile at the last level.
+  Tiles are rendered on demand from the matrix values, possibly from a background
+  thread, and the least recently used ones are evicted once the cache exceeds
+  maxCost() KiB: the memory does not depend on the size of the matrix.
+
+  Each insertion carries the generation() observed before rendering the tile
+  and is dropped if the pyramid has been invalidated in the meantime.
+  Rectangles of cells and tile coordinates follow the QRect / QPoint convention:
+  x is the column and y is the row.
+*/
+class CImagePyramid : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+    Constructor. The values of \a p_data in [\a p_min, \a p_max] are mapped to [0, 255].
+    \a p_data shares the buffer of the matrix: modified cells must be invalidated.
+    \a p_mapping is the mapped file \a p_data may point into, kept alive with the pyramid.
+  */
+    CImagePyramid(const cv::Mat &p_data, const std::shared_ptr<CMappedFile> &p_mapping, const double p_min, const double p_max);
+
+    /// Destructor.
+    ~CImagePyramid() override;
+
+    static int tileSize();
+
+    /*!
+    Returns the cells covered by the tile \a p_tile of the level \a p_level.
+  */
+    static QRect tileCells(const int p_level, const QPoint &p_tile);
+
+    QSize size() const;
+    const cv::Mat &data() const;
+    const std::shared_ptr<CMappedFile> &mapping() const;
+
+    int maxCost() const;
+
+    /*!
+    Returns the number of levels, the last one fitting the whole matrix in a single tile.
+  */
+    int levelCount() const;
+
+    /*!
+    Returns the coarsest level whose pixels are not larger than a screen pixel
+    when the matrix is displayed with the scale \a p_scale.
+  */
+    int levelForScale(const qreal p_scale) const;
+
+    /*!
+    Sets \a p_image to the cached image of the tile \a p_tile of the level \a p_level.
+    Returns \a false if the tile is not cached.
+  */
+    bool tile(const int p_level, const QPoint &p_tile, QImage &p_image);
+
+    /*!
+    Returns \a true if the caller may render the tile \a p_tile of the level \a p_level,
+    \a false if it is already cached or being rendered.
+    \sa insert
+  */
+    bool acquire(const int p_level, const QPoint &p_tile);
+
+    /*!
+    Renders the tile \a p_tile of the level \a p_level from the matrix values.
+    Cells are sampled with a nearest-neighbour interpolation.
+  */
+    QImage render(const int p_level, const QPoint &p_tile) const;
+
+    /*!
+    Stores the rendered \a p_image of the tile \a p_tile of the level \a p_level
+    and emits tileRendered().
+    The image is dropped and \a false is returned if the pyramid has been
+    invalidated since \a p_generation.
+  */
+    bool insert(const int p_level, const QPoint &p_tile, const QImage &p_image, const quint64 p_generation);
+
+    /*!
+    Returns the number of invalidations of the pyramid.
+  */
+    quint64 generation() const;
+
+    /*!
+    Removes the tiles of all the levels that intersect \a p_cells.
+  */
+    void invalidate(const QRect &p_cells);
+
+    /*!
+    Marks the pyramid as no longer displayed: tiles that are not rendered yet are skipped.
+  */
+    void cancel();
+
+    bool isCanceled() const;
+
+signals:
+    /*!
+    Emitted from the rendering thread when the rendering of the tile that covers \a p_cells is over.
+  */
+    void tileRendered(const QRect &p_cells);
+
+private:
+    static quint64 key(const int p_level, const QPoint &p_tile);
+
+    cv::Mat m_data;
+    std::shared_ptr<CMappedFile> m_mapping;
+    double m_min;
+    double m_max;
+    int m_levelCount;
+
+    mutable QMutex m_mutex;
+    QCache<quint64, QImage> m_tiles;
+    QSet<quint64> m_pending;
+    quint64 m_generation;
+
+    std::atomic<bool> m_canceled;
+};
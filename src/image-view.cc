@@ -18,6 +18,8 @@
 #include "image-view.hh"
 
 #include "histogram-widget.hh"
+#include "image-item.hh"
+#include "image-pyramid.hh"
 #include "main-window.hh"
 #include "matrix-model.hh"
 #include "position.hh"
@@ -27,22 +29,28 @@
 #include <QGraphicsRectItem>
 #include <QGraphicsScene>
 #include <QGraphicsView>
-#include <QImage>
 #include <QMenu>
 #include <QMouseEvent>
 #include <QPainter>
-#include <QPixmap>
+#include <QResizeEvent>
+#include <QSettings>
+#include <QSlider>
 #include <QWheelEvent>
 
 CImageView::CImageView(QWidget *p_parent)
     : QGraphicsView(p_parent)
     , m_parent(qobject_cast<CMainWindow *>(p_parent))
     , m_model(nullptr)
-    , m_image(nullptr)
+    , m_pyramid()
+    , m_imageItem(nullptr)
+    , m_imageMin(0)
+    , m_imageMax(255)
+    , m_imageStretched(false)
     , m_histogramWidget(nullptr)
     , m_histogramNeedsRedraw(true)
     , m_scene(new QGraphicsScene)
     , m_selectionBox(new QGraphicsRectItem(0, 0, 1, 1))
+    , m_frameSlider(new QSlider(Qt::Horizontal, this))
     , m_zoomInAct(nullptr)
     , m_zoomOutAct(nullptr)
     , m_normalSizeAct(nullptr)
@@ -57,12 +65,19 @@ CImageView::CImageView(QWidget *p_parent)
 
     setScene(m_scene);
 
+    m_frameSlider->setVisible(false);
+    m_frameSlider->setTickPosition(QSlider::TicksBelow);
+    m_frameSlider->setAutoFillBackground(true);
+
     createActions();
 }
 
 CImageView::~CImageView()
 {
-    delete m_image;
+    if (m_pyramid)
+    {
+        m_pyramid->cancel();
+    }
     delete m_histogramWidget;
     delete m_selectionBox;
     delete m_scene;
@@ -111,11 +126,61 @@ void CImageView::setModel(CMatrixModel *p_model)
         m_model = p_model;
 
         connect(m_model, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)), this, SLOT(update(const QModelIndex &, const QModelIndex &)));
-
+        connect(m_model, SIGNAL(modelReset()), this, SLOT(update()));
+        connect(m_model, SIGNAL(rowsInserted(const QModelIndex &, int, int)), this, SLOT(update()));
+        connect(m_model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this, SLOT(update()));
+        connect(m_model, SIGNAL(columnsInserted(const QModelIndex &, int, int)), this, SLOT(update()));
+        connect(m_model, SIGNAL(columnsRemoved(const QModelIndex &, int, int)), this, SLOT(update()));
+        connect(m_model, SIGNAL(frameChanged(int)), this, SLOT(updateFrameSlider()));
+        connect(m_model, SIGNAL(statisticsChanged()), this, SLOT(updateImageRange()));
+        connect(m_frameSlider, SIGNAL(valueChanged(int)), m_model, SLOT(setFrame(int)));
+
+        updateFrameSlider();
         update();
     }
 }
 
+void CImageView::updateFrameSlider()
+{
+    const int frameCount = m_model ? m_model->frameCount() : 1;
+
+    m_frameSlider->blockSignals(true);
+    m_frameSlider->setRange(0, frameCount - 1);
+    m_frameSlider->setValue(m_model ? m_model->frame() : 0);
+    m_frameSlider->blockSignals(false);
+
+    m_frameSlider->setToolTip(tr("Frame %1 / %2").arg(m_frameSlider->value() + 1).arg(frameCount));
+    m_frameSlider->setVisible(frameCount > 1);
+}
+
+void CImageView::updateImageRange()
+{
+    // The image was first stretched with an estimated range: redraw it with the exact one
+    double min = 0, max = 0;
+    const bool stretched = model()->imageRange(&min, &max);
+    if (stretched != m_imageStretched || min != m_imageMin || max != m_imageMax)
+    {
+        draw();
+        return;
+    }
+
+    // The histogram of edited cells waits for the statistics computed in background
+    if (m_histogramNeedsRedraw && m_histogramAct->isChecked() && m_histogramWidget != nullptr)
+    {
+        updateHistogram();
+    }
+}
+
+void CImageView::resizeEvent(QResizeEvent *p_event)
+{
+    QGraphicsView::resizeEvent(p_event);
+
+    // keep the frame slider at the bottom of the viewport
+    const QRect area = viewport()->geometry();
+    const int height = m_frameSlider->sizeHint().height();
+    m_frameSlider->setGeometry(area.left(), area.bottom() - height + 1, area.width(), height);
+}
+
 CMainWindow *CImageView::parent() const
 {
     if (m_parent == nullptr)
@@ -261,11 +326,26 @@ void CImageView::toggleHistogram(bool p_visible)
             m_histogramWidget = new CHistogramWidget(this);
         }
 
-        m_histogramWidget->setImage(m_image);
-        m_histogramNeedsRedraw = false;
+        updateHistogram();
+    }
+
+    if (m_histogramWidget)
+    {
+        m_histogramWidget->setVisible(p_visible);
     }
+}
 
-    m_histogramWidget->setVisible(p_visible);
+void CImageView::updateHistogram()
+{
+    QSettings settings;
+    settings.beginGroup("image");
+    const int bins = settings.value("histogram-bins", 0).toInt();
+    settings.endGroup();
+
+    // histograms of the values in their native type, not of the displayed pixels,
+    // read from the statistics of the model that are updated by the edits
+    m_histogramWidget->setHistogram(model()->histogram(bins), model()->statistics());
+    m_histogramNeedsRedraw = false;
 }
 
 void CImageView::draw()
@@ -273,12 +353,17 @@ void CImageView::draw()
     // reset scene
     m_scene->clear();
 
-    // delete previous image
+    // the tiles of the previous pyramid that are not rendered yet are skipped
+    if (m_pyramid)
+    {
+        m_pyramid->cancel();
+    }
 
-    delete m_image;
+    const cv::Mat data = model()->data();
+    m_imageStretched   = model()->imageRange(&m_imageMin, &m_imageMax);
 
-    // set p_image as current image
-    m_image = model()->toQImage();
+    // The last reference may be released by a rendering thread: delete the pyramid from its own thread
+    m_pyramid = std::shared_ptr<CImagePyramid>(new CImagePyramid(data, model()->mapping(), m_imageMin, m_imageMax), [](CImagePyramid *p_pyramid) { p_pyramid->deleteLater(); });
 
     // rebuild histogram
     if (m_histogramAct->isChecked())
@@ -288,8 +373,7 @@ void CImageView::draw()
             m_histogramWidget = new CHistogramWidget(this);
         }
 
-        m_histogramWidget->setImage(m_image);
-        m_histogramNeedsRedraw = false;
+        updateHistogram();
         m_histogramWidget->setVisible(true);
     }
     else
@@ -302,16 +386,65 @@ void CImageView::draw()
     m_selectionBox->setBrush(QBrush(QColor(255, 0, 0, 100)));
     m_selectionBox->setPen(Qt::NoPen);
 
-    // rebuild scene
-    m_scene->setSceneRect(QRect(0, 0, m_image->width(), m_image->height()));
-    m_scene->addPixmap(QPixmap::fromImage(*m_image));
+    // rebuild scene: tiles are rendered on demand when they are displayed
+    m_scene->setSceneRect(QRect(0, 0, data.cols, data.rows));
+    m_imageItem = new CImageItem(m_pyramid);
+    m_scene->addItem(m_imageItem);
     m_scene->addItem(m_selectionBox);
 }
 
 void CImageView::update(const QModelIndex &p_begin, const QModelIndex &p_end)
 {
-    Q_UNUSED(p_begin);
-    Q_UNUSED(p_end);
+    // An invalid range means that the dimensions or the type of the matrix changed
+    if (!p_begin.isValid() || !p_end.isValid() || !updateImage(QRect(QPoint(p_begin.column(), p_begin.row()), QPoint(p_end.column(), p_end.row()))))
+    {
+        draw();
+    }
+}
+
+bool CImageView::updateImage(const QRect &p_cells)
+{
+    // The pyramid shares the buffer of the matrix, unless it was reallocated
+    const cv::Mat data = model()->data();
+    if (!m_pyramid || m_imageItem == nullptr || m_pyramid->size() != QSize(data.cols, data.rows) || m_pyramid->data().data != data.data)
+    {
+        return false;
+    }
+
+    // The stretched range is only computed by complete redraws: redraw everything if it changed.
+    // Statistics that are computed again in background redraw the image with updateImageRange().
+    if (m_imageStretched)
+    {
+        double min = 0, max = 0;
+        if (model()->hasStatistics())
+        {
+            model()->valueRange(&min, &max);
+            if (min != m_imageMin || max != m_imageMax)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            cv::minMaxLoc(data(cv::Rect(p_cells.x(), p_cells.y(), p_cells.width(), p_cells.height())).reshape(1), &min, &max);
+            if (min < m_imageMin || max > m_imageMax)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Render again the tiles of the modified cells at all levels
+    m_pyramid->invalidate(p_cells);
+    m_imageItem->updateRect(p_cells);
+
+    // The histogram is only read again if it is displayed, and not before the statistics are known
+    if (m_histogramAct->isChecked() && m_histogramWidget != nullptr && model()->hasStatistics())
+    {
+        updateHistogram();
+        return true;
+    }
 
-    draw();
+    m_histogramNeedsRedraw = true;
+    return true;
 }
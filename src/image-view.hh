@@ -20,13 +20,17 @@
 
 #include <QGraphicsView>
 #include <QModelIndex>
+#include <memory>
 
 class CMainWindow;
 class CMatrixModel;
 class CHistogramWidget;
+class CImageItem;
+class CImagePyramid;
 
 class QAction;
-class QImage;
+class QResizeEvent;
+class QSlider;
 class QWheelEvent;
 class QMouseEvent;
 class QKeyEvent;
@@ -58,6 +62,7 @@ public:
     void wheelEvent(QWheelEvent *p_event) override;
     void mousePressEvent(QMouseEvent *p_event) override;
     void keyPressEvent(QKeyEvent *p_event) override;
+    void resizeEvent(QResizeEvent *p_event) override;
 
 public slots:
     void selectItem(int p_row, int p_col);
@@ -74,6 +79,10 @@ public slots:
 
     void draw();
 
+private slots:
+    void updateFrameSlider();
+    void updateImageRange();
+
 protected:
     /*!
     Provides custom context menu with specific actions that are relevant to the image view.
@@ -83,17 +92,29 @@ protected:
 
 private:
     void createActions();
+    bool updateImage(const QRect &p_cells);
+    void updateHistogram();
 
     CMainWindow *m_parent;
     CMatrixModel *m_model;
 
-    QImage *m_image;
+    std::shared_ptr<CImagePyramid> m_pyramid;
+    CImageItem *m_imageItem;
+
+    // range of values mapped to [0, 255] by the last complete redraw
+    double m_imageMin;
+    double m_imageMax;
+    bool m_imageStretched;
+
     CHistogramWidget *m_histogramWidget;
     bool m_histogramNeedsRedraw;
 
     QGraphicsScene *m_scene;
     QGraphicsRectItem *m_selectionBox;
 
+    // frame selection for multi-frame images
+    QSlider *m_frameSlider;
+
     // context menu actions
     QAction *m_zoomInAct;
     QAction *m_zoomOutAct;
@@ -21,6 +21,7 @@
 #include "config.hh"
 #include "image-view.hh"
 #include "matrix-converter.hh"
+#include "matrix-loader.hh"
 #include "matrix-model.hh"
 #include "matrix-view.hh"
 #include "new-matrix-dialog.hh"
@@ -79,7 +80,9 @@ const QStringList CMainWindow::_fileExtensions = QStringList() << "*.mfe"
                                                                << "*.tiff"
                                                                << "*.TIFF"
                                                                << "*.edf"
-                                                               << "*.EDF";
+                                                               << "*.EDF"
+                                                               << "*.ada"
+                                                               << "*.ADA";
 
 const QStringList CMainWindow::_fileTypeFilters = QStringList() << "All files (*.*);;"
                                                                 << "JPEG (*.jpg *.jpeg *.JPG);;"
@@ -92,6 +95,7 @@ const QStringList CMainWindow::_fileTypeFilters = QStringList() << "All files (*
                                                                 << "RAW (*.raw *.RAW);;"
                                                                 << "MFE (*.mfe *.MFE);;"
                                                                 << "EDF (*.edf *.EDF);;"
+                                                                << "ADA (*.ada *.ADA);;"
                                                                 << "TXT (*.txt *.TXT);;"
                                                                 << "XML (*.xml *.XML);;";
 
@@ -115,6 +119,8 @@ CMainWindow::CMainWindow(QWidget* p_parent)
     , m_openAct(nullptr)
     , m_saveAct(nullptr)
     , m_saveAsAct(nullptr)
+    , m_undoAct(nullptr)
+    , m_redoAct(nullptr)
     , m_operationsAct(nullptr)
     , m_benchmarkAct(nullptr)
     , m_dataViewAct(nullptr)
@@ -214,6 +220,20 @@ void CMainWindow::createActions()
     m_saveAsAct->setStatusTip(tr("Save the current data file with a different name"));
     connect(m_saveAsAct, SIGNAL(triggered()), this, SLOT(saveAs()));
 
+    m_undoAct = new QAction(tr("&Undo"), this);
+    m_undoAct->setShortcut(QKeySequence::Undo);
+    m_undoAct->setIcon(QIcon::fromTheme("edit-undo", QIcon(":/icons/tango/32x32/actions/edit-undo.png")));
+    m_undoAct->setStatusTip(tr("Undo the last edit of the matrix"));
+    m_undoAct->setEnabled(false);
+    connect(m_undoAct, SIGNAL(triggered()), this, SLOT(undo()));
+
+    m_redoAct = new QAction(tr("&Redo"), this);
+    m_redoAct->setShortcut(QKeySequence::Redo);
+    m_redoAct->setIcon(QIcon::fromTheme("edit-redo", QIcon(":/icons/tango/32x32/actions/edit-redo.png")));
+    m_redoAct->setStatusTip(tr("Redo the last undone edit of the matrix"));
+    m_redoAct->setEnabled(false);
+    connect(m_redoAct, SIGNAL(triggered()), this, SLOT(redo()));
+
     m_operationsAct = new QAction(tr("&Operations"), this);
     m_operationsAct->setIcon(QIcon(":/icons/matrix-viewer/48x48/operations.png"));
     m_operationsAct->setStatusTip(tr("Apply common operations"));
@@ -307,6 +327,8 @@ void CMainWindow::newMatrix()
 
     // Build model from parameters
     CMatrixModel* model = new CMatrixModel(rows, cols, type + 8 * (channels - 1), value1, value2, value3);
+    connect(model, SIGNAL(historyChanged()), this, SLOT(updateHistoryActions()));
+    connect(model, SIGNAL(message(const QString&)), this, SLOT(showMessage(const QString&)));
     positionWidget()->setValueDescription(model->valueDescription());
 
     // New tab
@@ -541,6 +563,10 @@ void CMainWindow::createMenus()
     fileMenu->addSeparator();
     fileMenu->addAction(m_exitAct);
 
+    QMenu* editMenu = menuBar()->addMenu(tr("&Edit"));
+    editMenu->addAction(m_undoAct);
+    editMenu->addAction(m_redoAct);
+
     QMenu* viewMenu = menuBar()->addMenu(tr("&View"));
     viewMenu->addAction(m_dataViewAct);
     viewMenu->addAction(m_imageViewAct);
@@ -582,6 +608,7 @@ void CMainWindow::preferences()
     ConfigDialog dialog(this);
     dialog.exec();
     readSettings();
+    CMatrixModel::readHistorySettings();
 }
 
 void CMainWindow::documentation()
@@ -708,18 +735,65 @@ void CMainWindow::open(const QString& p_filename)
     QFileInfo fi(p_filename);
     m_openPath = fi.absolutePath();
 
-    // Try to find a suitable profile for this file
-    QString profile = findProfile(p_filename);
+    // New tab with a placeholder until the file is decoded in background
+    CTab* tab = new CTab();
 
-    // Build model from data file
-    CMatrixModel* model = new CMatrixModel(p_filename);
-    model->setProfile(profile);
-    positionWidget()->setValueDescription(model->valueDescription());
+    CMatrixLoader* loader = new CMatrixLoader(p_filename, tab);
 
-    // New tab
-    CTab* tab = new CTab();
+    CProgressBar* progressBar = new CProgressBar;
+    progressBar->setRange(0, 100);
+    connect(loader, SIGNAL(progress(int)), progressBar, SLOT(setValue(int)));
+    connect(progressBar, SIGNAL(canceled()), loader, SLOT(cancel()));
+
+    QBoxLayout* placeholderLayout = new QVBoxLayout;
+    placeholderLayout->addStretch();
+    placeholderLayout->addWidget(new QLabel(tr("Loading %1").arg(fi.fileName())), 0, Qt::AlignHCenter);
+    placeholderLayout->addWidget(progressBar);
+    placeholderLayout->addStretch();
+
+    QWidget* placeholder = new QWidget;
+    placeholder->setLayout(placeholderLayout);
+    tab->addWidget(placeholder);
+
+    m_mainWidget->addTab(tab, p_filename);
+    m_mainWidget->setCurrentWidget(tab);
+
+    connect(tab, SIGNAL(labelChanged(const QString&)), m_mainWidget, SLOT(changeTabText(const QString&)));
+    connect(loader, SIGNAL(finished(bool)), this, SLOT(fileLoaded(bool)));
+
+    showMessage(tr("Loading: %1").arg(p_filename));
+    writeSettings(); // updates openPath
+
+    loader->start();
+}
+
+void CMainWindow::fileLoaded(bool p_success)
+{
+    CMatrixLoader* loader = qobject_cast<CMatrixLoader*>(sender());
+    CTab* tab             = (loader != nullptr) ? qobject_cast<CTab*>(loader->parent()) : nullptr;
+    if (tab == nullptr)
+    {
+        return;
+    }
+
+    const QString filename = loader->filePath();
+    if (!p_success)
+    {
+        showMessage(loader->isCanceled() ? tr("Loading canceled: %1").arg(filename) : tr("Can't load file: %1").arg(filename));
+        tab->deleteLater(); // also deletes the loader, which is emitting
+        return;
+    }
+
+    // Build model from the decoded file and try to find a suitable profile for it
+    CMatrixModel* model = loader->takeModel();
+    connect(model, SIGNAL(historyChanged()), this, SLOT(updateHistoryActions()));
+    connect(model, SIGNAL(message(const QString&)), this, SLOT(showMessage(const QString&)));
+    model->setProfile(findProfile(filename));
+    loader->deleteLater();
+
+    // Replace the placeholder by the views
+    delete tab->widget(0);
 
-    // Set up the views
     CMatrixView* matrixView = new CMatrixView(this);
     matrixView->setModel(model);
     tab->addWidget(matrixView);
@@ -728,27 +802,27 @@ void CMainWindow::open(const QString& p_filename)
     imgView->setModel(model);
     tab->addWidget(imgView);
 
-    m_mainWidget->addTab(tab, p_filename);
-    m_mainWidget->setCurrentWidget(tab);
-
     imgView->bestSize();
 
-    if (model->isFormatData())
+    // Other tabs may have been opened while this file was loading
+    if (tab == currentWidget())
     {
-        m_dataViewAct->setChecked(true);
-        toggleDataView(m_dataViewAct->isChecked());
-    }
+        positionWidget()->setValueDescription(model->valueDescription());
 
-    if (model->isFormatImage())
-    {
-        m_imageViewAct->setChecked(true);
-        toggleImageView(m_imageViewAct->isChecked());
-    }
+        if (model->isFormatData())
+        {
+            m_dataViewAct->setChecked(true);
+            toggleDataView(m_dataViewAct->isChecked());
+        }
 
-    connect(tab, SIGNAL(labelChanged(const QString&)), m_mainWidget, SLOT(changeTabText(const QString&)));
+        if (model->isFormatImage())
+        {
+            m_imageViewAct->setChecked(true);
+            toggleImageView(m_imageViewAct->isChecked());
+        }
+    }
 
-    showMessage(p_filename);
-    writeSettings(); // updates openPath
+    showMessage(filename);
 }
 
 void CMainWindow::open()
@@ -775,6 +849,20 @@ void CMainWindow::save(const QString& p_filename)
         return;
     }
 
+    // Only the current frame of a stack is decoded: writing it in EDF would replace the whole stack by a single frame
+    const CMatrixModel* model = currentModel();
+    if (model->frameCount() > 1 && QFileInfo(p_filename).suffix().toLower() == "edf")
+    {
+        qWarning() << "Can't save a single frame of a multi-frame EDF file:" << p_filename;
+        QMessageBox::warning(this,
+                             tr("Save"),
+                             tr("%1 contains %2 frames and only the current one can be saved.\n"
+                                "Save it in another format instead.")
+                                 .arg(QFileInfo(p_filename).fileName())
+                                 .arg(model->frameCount()));
+        return;
+    }
+
     currentWidget()->setModified(false);
     currentWidget()->setFilePath(p_filename);
 
@@ -782,6 +870,12 @@ void CMainWindow::save(const QString& p_filename)
     converter.setData(currentModel()->data());
     converter.save(p_filename);
 
+    if (model->hasFrameEdits())
+    {
+        showMessage(tr("Save: %1 (frame %2 only)").arg(p_filename).arg(model->frame() + 1));
+        return;
+    }
+
     showMessage(tr("Save: %1").arg(p_filename));
 }
 
@@ -822,7 +916,7 @@ void CMainWindow::closeTab(int p_index)
         const int nbChildren = tab->count();
         for (int i = 0; i < nbChildren; ++i)
         {
-            delete currentWidget()->widget(i);
+            delete tab->widget(i);
         }
     }
 
@@ -845,6 +939,30 @@ void CMainWindow::changeTab(int p_index)
             positionWidget()->setValueDescription(currentModel()->valueDescription());
         }
     }
+    updateHistoryActions();
+}
+
+void CMainWindow::undo()
+{
+    if (currentModel() != nullptr)
+    {
+        currentModel()->undo();
+    }
+}
+
+void CMainWindow::redo()
+{
+    if (currentModel() != nullptr)
+    {
+        currentModel()->redo();
+    }
+}
+
+void CMainWindow::updateHistoryActions()
+{
+    CMatrixModel* model = currentModel();
+    m_undoAct->setEnabled(model != nullptr && model->canUndo());
+    m_redoAct->setEnabled(model != nullptr && model->canRedo());
 }
 
 void CMainWindow::showMessage(const QString& p_message) const
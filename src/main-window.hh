@@ -52,6 +52,9 @@ The CMainWindow handles files as illustrated below :
 \li The class CMatrixConverter handles IO operations and
 converts a file into OpenCV cv::Mat object
 
+\li The class CMatrixLoader runs the CMatrixConverter in background
+while the tab displays the loading progress
+
 \li The class CMatrixModel is built on the cv::Mat data
 
 \li CMatrixView and CImageView offer visualization of the CMatrixModel
@@ -66,6 +69,11 @@ public slots:
   */
     void open(const QString &p_filename);
 
+    /*!
+  Display \a p_message in the status bar
+  */
+    void showMessage(const QString &p_message) const;
+
 public:
     /// Constructor
     CMainWindow(QWidget *p_parent = nullptr);
@@ -103,11 +111,6 @@ public:
   */
     CPosition *positionWidget() const;
 
-    /*!
-  Display \a p_message in the status bar
-  */
-    void showMessage(const QString &p_message) const;
-
 protected:
     /*!
   Saves settings before closing the application
@@ -129,9 +132,13 @@ private slots:
     void save();
     void saveAs();
     void closeTab(int p_index);
+    void fileLoaded(bool p_success);
     void changeTab(int p_index);
     void operations();
     void benchmark();
+    void undo();
+    void redo();
+    void updateHistoryActions();
 
     //application
     void preferences();
@@ -188,6 +195,8 @@ private:
     QAction *m_openAct;
     QAction *m_saveAct;
     QAction *m_saveAsAct;
+    QAction *m_undoAct;
+    QAction *m_redoAct;
     QAction *m_operationsAct;
     QAction *m_benchmarkAct;
 
@@ -26,6 +26,7 @@
  \image html main.png
 */
 #include "benchmark-result.hh"
+#include "benchmark-runner.hh"
 #include "config.hh"
 #include "main-window.hh"
 #include "matrix-converter.hh"
@@ -73,7 +74,7 @@ void printUsage()
     out << "\t--txt \t"
         << "Text format: first row = [nbcolumns nbrows]; second row = [data]." << Qt::endl;
     out << "\t--raw \t"
-        << "Raw images (16bits unsigned, little-endian byte order)." << Qt::endl;
+        << "Raw images (layout given by the --raw-* options)." << Qt::endl;
     out << "\t--mfe \t"
         << "Matrix Format Exchange." << Qt::endl;
     out << "\t--edf \t"
@@ -87,6 +88,57 @@ void printUsage()
         << "Specify an integer VALUE for width of raw images (default is 2160)." << Qt::endl;
     out << "\t--raw-height <VALUE>\t\t\t"
         << "Specify an integer VALUE for height of raw images (default is 1944)." << Qt::endl;
+    out << "\t--raw-type <TYPE>\t\t\t"
+        << "Specify the pixel layout of raw images: raw8|raw10|raw10p|raw12|raw12p|raw14|raw14p|raw16 (default is raw16)." << Qt::endl;
+    out << "\t\t\t\t\t\t"
+        << "Unpacked layouts store one 16-bit word per pixel, 'p' layouts are MIPI packed." << Qt::endl;
+    out << "\t--raw-bayer <PATTERN>\t\t\t"
+        << "Specify the Bayer PATTERN of raw images: none|rggb|bggr|grbg|gbrg (default is none)." << Qt::endl;
+    out << "\t--raw-header-size <VALUE>\t\t"
+        << "Specify the number of bytes to skip at the beginning of raw images (default is 0)." << Qt::endl;
+    out << "\t--raw-big-endian\t\t\t"
+        << "Read and write unpacked raw images in big-endian byte order." << Qt::endl;
+    out << "\t--mfe-version <VALUE>\t\t\t"
+        << "Specify the version of saved MFE files: 1 (raw values, default) or 2 (compressed chunks)." << Qt::endl;
+    out << "\t--threads <VALUE>\t\t\t"
+        << "Specify the number of threads used to load and convert files (default is all cores, 1 disables parallelism)." << Qt::endl;
+    out << Qt::endl;
+
+    out << "--------------------------------------------------------" << Qt::endl;
+    out << "Benchmark mode (no display required)" << Qt::endl;
+    out << "Usage: " << QCoreApplication::applicationName() << " --benchmark [OPTIONS] FILES" << Qt::endl;
+    out << Qt::endl;
+
+    out << "FILES: list of compatible matrix data files" << Qt::endl;
+    out << Qt::endl;
+
+    out << "OPTIONS:" << Qt::endl;
+    out << "\t--operations <LIST>\t\t\t"
+        << "Specify a comma-separated LIST of operations to run (default is all benchmark operations)." << Qt::endl;
+    out << "\t--iterations <VALUE>\t\t\t"
+        << "Specify the number of measured iterations of each operation (default is 10)." << Qt::endl;
+    out << "\t--warmup <VALUE>\t\t\t"
+        << "Specify the number of unmeasured iterations run before the measured ones (default is 1)." << Qt::endl;
+    out << "\t--precision <PERCENT>\t\t\t"
+        << "Run iterations until the 95% confidence interval of the mean is within PERCENT of the mean," << Qt::endl;
+    out << "\t\t\t\t\t\t"
+        << "--iterations being the maximum (default is 0, exactly --iterations are run)." << Qt::endl;
+    out << "\t--no-cache-flush\t\t\t"
+        << "Do not flush CPU caches before each iteration." << Qt::endl;
+    out << "\t--baseline <FILE>\t\t\t"
+        << "Compare results with the JSON report FILE of a previous run and fail on significant regressions." << Qt::endl;
+    out << "\t--alpha <VALUE>\t\t\t\t"
+        << "Specify the significance level of the Mann-Whitney U test used to compare with the baseline (default is 0.05)." << Qt::endl;
+    out << "\t\t\t\t\t\t"
+        << "It applies to the p-values adjusted with the Holm-Bonferroni method for all the compared operations." << Qt::endl;
+    out << "\t--threshold <PERCENT>\t\t\t"
+        << "Only report changes of the median duration of at least PERCENT (default is 2)." << Qt::endl;
+    out << "\t-o, --output <FILE>\t\t\t"
+        << "Specify the FILE where results are written (default is the standard output)." << Qt::endl;
+    out << "\t--format <FORMAT>\t\t\t"
+        << "Specify the FORMAT of results: json|csv (default is csv for *.csv outputs, json otherwise)." << Qt::endl;
+    out << "\t--threads <VALUE>\t\t\t"
+        << "Specify the number of threads used by operations (default is all cores, 1 disables parallelism)." << Qt::endl;
     out << Qt::endl;
     out << "********************************************************" << Qt::endl;
     out << Qt::endl;
@@ -101,6 +153,16 @@ void printVersion()
 /// Main routine of the application
 int main(int argc, char *argv[])
 {
+    // The benchmark mode runs on build hosts without any display:
+    // use the offscreen platform unless another one is explicitly requested
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--benchmark") == 0 && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
+
     QApplication application(argc, argv);
 
     QApplication::setOrganizationDomain("rgoffe.org");
@@ -123,7 +185,8 @@ int main(int argc, char *argv[])
     bool helpFlag         = false;
     ;
     bool versionFlag = false;
-    bool cliMode     = false;
+    bool cliMode       = false;
+    bool benchmarkMode = false;
 
     if (arguments.contains("-h") || arguments.contains("--help"))
     {
@@ -137,6 +200,10 @@ int main(int argc, char *argv[])
     {
         cliMode = true;
     }
+    else if (arguments.contains("--benchmark")) // CLI option
+    {
+        benchmarkMode = true;
+    }
 
     // Localization
     QDir translationDirectory;
@@ -178,6 +245,12 @@ int main(int argc, char *argv[])
         return parser.execute();
     }
 
+    if (benchmarkMode)
+    {
+        CBenchmarkRunner runner(QCoreApplication::arguments());
+        return runner.execute();
+    }
+
     qRegisterMetaType<BenchmarkResult>("BenchmarkResult");
 
     CMainWindow mainWindow;
@@ -0,0 +1,81 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "mapped-file.hh"
+
+#include <QDebug>
+
+CMappedFile::CMappedFile(const QString &p_path) : m_file(p_path), m_data(nullptr), m_size(0)
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Can't open file for memory mapping:" << p_path;
+        qWarning() << "-- error:" << m_file.errorString();
+        return;
+    }
+
+    m_size = m_file.size();
+    if (m_size <= 0)
+    {
+        qWarning() << "Can't map empty file:" << p_path;
+        return;
+    }
+
+    // Private mapping: written pages are copied instead of being flushed to the file
+    m_data = m_file.map(0, m_size, QFileDevice::MapPrivateOption);
+    if (m_data == nullptr)
+    {
+        qWarning() << "Can't map file in memory:" << p_path;
+        qWarning() << "-- error:" << m_file.errorString();
+        m_size = 0;
+    }
+}
+
+CMappedFile::~CMappedFile()
+{
+    if (m_data != nullptr)
+    {
+        m_file.unmap(m_data);
+    }
+    m_file.close();
+}
+
+bool CMappedFile::isValid() const
+{
+    return m_data != nullptr;
+}
+
+uchar *CMappedFile::data() const
+{
+    return m_data;
+}
+
+qint64 CMappedFile::size() const
+{
+    return m_size;
+}
+
+QString CMappedFile::fileName() const
+{
+    return m_file.fileName();
+}
+
+bool CMappedFile::contains(const void *p_address) const
+{
+    const uchar *address = static_cast<const uchar *>(p_address);
+    return m_data != nullptr && address >= m_data && address < m_data + m_size;
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+/*!
+  \file mapped-file.hh
+  \class CMappedFile
+  \brief CMappedFile maps the whole content of a file in memory
+
+  The file is mapped in private mode: pages are loaded lazily by the system
+  when they are first read and a page is only copied when it is written to.
+  Modifications are never written back to the file.
+
+  This allows cv::Mat headers to point directly into the mapped region
+  without paying for a full copy of the file content.
+  The mapping remains valid as long as the CMappedFile object is alive,
+  hence it is usually shared (std::shared_ptr) with the owner of the cv::Mat.
+*/
+class CMappedFile
+{
+public:
+    /// Constructor.
+    CMappedFile(const QString &p_path);
+
+    /// Destructor.
+    ~CMappedFile();
+
+    CMappedFile(const CMappedFile &) = delete;
+    CMappedFile &operator=(const CMappedFile &) = delete;
+
+    /*!
+    Returns \a true if the file has been successfully mapped, \a false otherwise.
+  */
+    bool isValid() const;
+
+    /*!
+    Returns the start address of the mapped region.
+  */
+    uchar *data() const;
+
+    /*!
+    Returns the size in bytes of the mapped region.
+  */
+    qint64 size() const;
+
+    /*!
+    Returns the name of the mapped file.
+  */
+    QString fileName() const;
+
+    /*!
+    Returns \a true if \a p_address is within the mapped region.
+  */
+    bool contains(const void *p_address) const;
+
+private:
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_size;
+};
@@ -0,0 +1,314 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "matrix-comparator.hh"
+
+#include "parallel-bands.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+struct BandComparison
+{
+    qint64 differences;
+    qint64 first;
+    qint64 largest;
+    double maxAbsoluteDifference;
+    quint64 maxUlpDifference;
+};
+
+template <typename T>
+static inline bool isSameValue(const T p_first, const T p_second)
+{
+    return p_first == p_second || std::memcmp(&p_first, &p_second, sizeof(T)) == 0;
+}
+
+template <typename T>
+static inline quint64 ulpDistance(const T p_first, const T p_second)
+{
+    const qint64 first  = p_first;
+    const qint64 second = p_second;
+    return first > second ? static_cast<quint64>(first - second) : static_cast<quint64>(second - first);
+}
+
+// Floating point values are mapped to integers that count the representable values from zero
+static inline quint64 ulpDistance(const qint64 p_first, const qint64 p_second, const bool p_isNan)
+{
+    if (p_isNan)
+    {
+        return std::numeric_limits<quint64>::max();
+    }
+    return p_first > p_second ? static_cast<quint64>(p_first) - static_cast<quint64>(p_second)
+                              : static_cast<quint64>(p_second) - static_cast<quint64>(p_first);
+}
+
+static inline quint64 ulpDistance(const float p_first, const float p_second)
+{
+    qint32 first, second;
+    std::memcpy(&first, &p_first, sizeof(first));
+    std::memcpy(&second, &p_second, sizeof(second));
+
+    const qint64 min = std::numeric_limits<qint32>::min();
+    return ulpDistance(first < 0 ? min - first : first, second < 0 ? min - second : second, std::isnan(p_first) || std::isnan(p_second));
+}
+
+static inline quint64 ulpDistance(const double p_first, const double p_second)
+{
+    qint64 first, second;
+    std::memcpy(&first, &p_first, sizeof(first));
+    std::memcpy(&second, &p_second, sizeof(second));
+
+    const qint64 min = std::numeric_limits<qint64>::min();
+    return ulpDistance(first < 0 ? min - first : first, second < 0 ? min - second : second, std::isnan(p_first) || std::isnan(p_second));
+}
+
+template <typename T>
+static bool equalValues(const uchar* p_first, const uchar* p_second, const int p_count)
+{
+    const T* first  = reinterpret_cast<const T*>(p_first);
+    const T* second = reinterpret_cast<const T*>(p_second);
+    for (int i = 0; i < p_count; ++i)
+    {
+        if (!isSameValue(first[i], second[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool equalRows(const uchar* p_first, const uchar* p_second, const int p_count, const size_t p_rowSize, const int p_depth)
+{
+    if (std::memcmp(p_first, p_second, p_rowSize) == 0)
+    {
+        return true;
+    }
+
+    // Only floating point values can differ in memory and still be equal (signed zeros)
+    switch (p_depth)
+    {
+        case CV_32F:
+            return equalValues<float>(p_first, p_second, p_count);
+
+        case CV_64F:
+            return equalValues<double>(p_first, p_second, p_count);
+
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+static void compareBand(const cv::Mat& p_first,
+                        const cv::Mat& p_second,
+                        const cv::Range& p_rows,
+                        const double p_absoluteTolerance,
+                        const quint64 p_ulpTolerance,
+                        BandComparison& p_result)
+{
+    const int count      = p_first.cols * p_first.channels();
+    const size_t rowSize = count * sizeof(T);
+    for (int r = p_rows.start; r < p_rows.end; ++r)
+    {
+        const T* first  = p_first.ptr<T>(r);
+        const T* second = p_second.ptr<T>(r);
+        if (std::memcmp(first, second, rowSize) == 0)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (isSameValue(first[i], second[i]))
+            {
+                continue;
+            }
+
+            double difference = std::abs(static_cast<double>(first[i]) - static_cast<double>(second[i]));
+            if (std::isnan(difference))
+            {
+                difference = std::numeric_limits<double>::infinity();
+            }
+            const quint64 ulp = ulpDistance(first[i], second[i]);
+
+            p_result.maxUlpDifference = std::max(p_result.maxUlpDifference, ulp);
+            if (p_result.largest < 0 || difference > p_result.maxAbsoluteDifference)
+            {
+                p_result.maxAbsoluteDifference = difference;
+                p_result.largest               = static_cast<qint64>(r) * count + i;
+            }
+
+            if (difference <= p_absoluteTolerance || ulp <= p_ulpTolerance)
+            {
+                continue;
+            }
+
+            ++p_result.differences;
+            if (p_result.first < 0)
+            {
+                p_result.first = static_cast<qint64>(r) * count + i;
+            }
+        }
+    }
+}
+
+bool CMatrixComparator::isComparable(const cv::Mat& p_first, const cv::Mat& p_second)
+{
+    if (p_first.empty() && p_second.empty())
+    {
+        return true;
+    }
+
+    return p_first.type() == p_second.type() && p_first.rows == p_second.rows && p_first.cols == p_second.cols;
+}
+
+bool CMatrixComparator::equal(const cv::Mat& p_first, const cv::Mat& p_second)
+{
+    if (!isComparable(p_first, p_second))
+    {
+        return false;
+    }
+
+    if (p_first.empty())
+    {
+        return true;
+    }
+
+    const int count      = p_first.cols * p_first.channels();
+    const size_t rowSize = p_first.cols * p_first.elemSize();
+    const int rows       = CParallelBands::rows(p_first);
+    const int bands      = (p_first.rows + rows - 1) / rows;
+
+    std::atomic<bool> isDifferent(false);
+    cv::parallel_for_(cv::Range(0, bands),
+                      [&](const cv::Range& p_range)
+                      {
+                          for (int b = p_range.start; b < p_range.end; ++b)
+                          {
+                              const int last = std::min(p_first.rows, (b + 1) * rows);
+                              for (int r = b * rows; r < last; ++r)
+                              {
+                                  // Stop all the bands as soon as one of them found a difference
+                                  if (isDifferent)
+                                  {
+                                      return;
+                                  }
+
+                                  if (!equalRows(p_first.ptr(r), p_second.ptr(r), count, rowSize, p_first.depth()))
+                                  {
+                                      isDifferent = true;
+                                      return;
+                                  }
+                              }
+                          }
+                      });
+
+    return !isDifferent;
+}
+
+CMatrixComparator::Comparison
+CMatrixComparator::compare(const cv::Mat& p_first, const cv::Mat& p_second, const double p_absoluteTolerance, const quint64 p_ulpTolerance)
+{
+    Comparison result{isComparable(p_first, p_second), 0, QPoint(-1, -1), -1, QPoint(-1, -1), -1, 0, 0};
+    if (!result.isComparable || p_first.empty())
+    {
+        return result;
+    }
+
+    const int rows  = CParallelBands::rows(p_first);
+    const int bands = (p_first.rows + rows - 1) / rows;
+
+    std::vector<BandComparison> comparisons(bands, BandComparison{0, -1, -1, 0, 0});
+    cv::parallel_for_(cv::Range(0, bands),
+                      [&](const cv::Range& p_range)
+                      {
+                          for (int b = p_range.start; b < p_range.end; ++b)
+                          {
+                              const cv::Range bandRange(b * rows, std::min(p_first.rows, (b + 1) * rows));
+                              switch (p_first.depth())
+                              {
+                                  case CV_8U:
+                                      compareBand<uchar>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_8S:
+                                      compareBand<schar>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_16U:
+                                      compareBand<ushort>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_16S:
+                                      compareBand<short>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_32S:
+                                      compareBand<int>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_32F:
+                                      compareBand<float>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  case CV_64F:
+                                      compareBand<double>(p_first, p_second, bandRange, p_absoluteTolerance, p_ulpTolerance, comparisons[b]);
+                                      break;
+
+                                  default:
+                                      break;
+                              }
+                          }
+                      });
+
+    // Bands are merged in row-major order: the first difference comes from the first band that has one
+    qint64 first   = -1;
+    qint64 largest = -1;
+    for (const BandComparison& comparison : comparisons)
+    {
+        result.maxUlpDifference = std::max(result.maxUlpDifference, comparison.maxUlpDifference);
+        result.differences += comparison.differences;
+        if (first < 0)
+        {
+            first = comparison.first;
+        }
+        if (comparison.largest >= 0 && (largest < 0 || comparison.maxAbsoluteDifference > result.maxAbsoluteDifference))
+        {
+            result.maxAbsoluteDifference = comparison.maxAbsoluteDifference;
+            largest                      = comparison.largest;
+        }
+    }
+
+    const int count    = p_first.cols * p_first.channels();
+    const int channels = p_first.channels();
+    if (first >= 0)
+    {
+        result.firstDifference = QPoint(static_cast<int>(first % count) / channels, static_cast<int>(first / count));
+        result.firstChannel    = static_cast<int>(first % count) % channels;
+    }
+    if (largest >= 0)
+    {
+        result.largestDifference = QPoint(static_cast<int>(largest % count) / channels, static_cast<int>(largest / count));
+        result.largestChannel    = static_cast<int>(largest % count) % channels;
+    }
+
+    return result;
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QPoint>
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file matrix-comparator.hh
+  \class CMatrixComparator
+  \brief CMatrixComparator compares the values of two matrices in their native type
+
+  Matrices are compared by bands of rows in parallel. Rows are first compared
+  as raw memory (memcmp), values are only decoded for the rows that differ.
+
+  equal() stops as soon as a difference is found.
+  compare() scans the whole matrices: it accepts a tolerance on the absolute
+  difference or on the distance in units in the last place (ULP) of the values,
+  and reports the first and the largest differences.
+
+  Two values are equal if their absolute difference is within the absolute
+  tolerance, or if they are bitwise identical (NaN, signed zeros).
+*/
+class CMatrixComparator
+{
+public:
+    struct Comparison
+    {
+        /// \a false if the matrices do not have the same dimensions and type.
+        bool isComparable;
+
+        /// Number of values whose difference is beyond the tolerances.
+        qint64 differences;
+
+        /// Cell (x is the column, y is the row) and channel of the first difference in row-major order.
+        QPoint firstDifference;
+        int firstChannel;
+
+        /// Cell and channel of the largest absolute difference.
+        QPoint largestDifference;
+        int largestChannel;
+
+        double maxAbsoluteDifference;
+        quint64 maxUlpDifference;
+
+        bool isEqual() const
+        {
+            return isComparable && differences == 0;
+        }
+    };
+
+    /*!
+    Returns \a true if \a p_first and \a p_second have the same dimensions, type and values.
+  */
+    static bool equal(const cv::Mat &p_first, const cv::Mat &p_second);
+
+    /*!
+    Compares all the values of \a p_first and \a p_second.
+    Values are considered equal if their absolute difference is lower or equal to \a p_absoluteTolerance
+    or if they are less than \a p_ulpTolerance representable values apart.
+  */
+    static Comparison compare(const cv::Mat &p_first, const cv::Mat &p_second, const double p_absoluteTolerance = 0, const quint64 p_ulpTolerance = 0);
+
+private:
+    static bool isComparable(const cv::Mat &p_first, const cv::Mat &p_second);
+};
@@ -17,15 +17,20 @@
 //******************************************************************************
 #include "matrix-converter.hh"
 
+#include "ada.hh"
 #include "config.hh"
 #include "edf.hh"
+#include "mapped-file.hh"
 #include "mfe.hh"
+#include "raw.hh"
+#include "txt.hh"
 
 #include <QDebug>
 #include <QFile>
+#include <QImageReader>
+#include <QRegularExpression>
 #include <QSettings>
 #include <QStringList>
-#include <QTextStream>
 #include <QElapsedTimer>
 
 #if defined(LIBEXIV2_ENABLED)
@@ -45,7 +50,25 @@ const QStringList CMatrixConverter::s_fileStorageExtensions = QStringList() << "
                                                                             << "yaml"
                                                                             << "json";
 
-CMatrixConverter::CMatrixConverter() : QObject(), m_format(Format_Unknown), m_data(), m_metadata(), m_rawType(0), m_rawWidth(0), m_rawHeight(0) { }
+CMatrixConverter::CMatrixConverter()
+    : QObject()
+    , m_format(Format_Unknown)
+    , m_data()
+    , m_metadata()
+    , m_rawType(0)
+    , m_rawWidth(0)
+    , m_rawHeight(0)
+    , m_rawLittleEndian(true)
+    , m_rawBayerPattern(CRawFile::Bayer_None)
+    , m_rawHeaderSize(0)
+    , m_mfeVersion(1)
+    , m_memoryMapping(false)
+    , m_progressHandler()
+    , m_mapping()
+    , m_edfFile()
+{
+    readSettings();
+}
 
 CMatrixConverter::CMatrixConverter(const QString& p_filename)
     : QObject()
@@ -55,7 +78,16 @@ CMatrixConverter::CMatrixConverter(const QString& p_filename)
     , m_rawType(0)
     , m_rawWidth(0)
     , m_rawHeight(0)
+    , m_rawLittleEndian(true)
+    , m_rawBayerPattern(CRawFile::Bayer_None)
+    , m_rawHeaderSize(0)
+    , m_mfeVersion(1)
+    , m_memoryMapping(false)
+    , m_progressHandler()
+    , m_mapping()
+    , m_edfFile()
 {
+    readSettings();
     if (!load(p_filename))
     {
         qWarning() << "Can't load file: " << p_filename;
@@ -68,9 +100,12 @@ void CMatrixConverter::readSettings()
 {
     QSettings settings;
     settings.beginGroup("image");
-    m_rawType   = settings.value("raw-type", 0).toInt();
-    m_rawWidth  = settings.value("raw-width", 2160).toInt();
-    m_rawHeight = settings.value("raw-height", 1944).toInt();
+    m_rawType         = settings.value("raw-type", 0).toInt();
+    m_rawWidth        = settings.value("raw-width", 2160).toInt();
+    m_rawHeight       = settings.value("raw-height", 1944).toInt();
+    m_rawLittleEndian = settings.value("raw-little-endian", true).toBool();
+    m_rawBayerPattern = settings.value("raw-bayer-pattern", CRawFile::Bayer_None).toInt();
+    m_rawHeaderSize   = settings.value("raw-header-size", 0).toInt();
     settings.endGroup();
 }
 
@@ -94,8 +129,51 @@ void CMatrixConverter::setRawType(const int p_value)
     m_rawType = p_value;
 }
 
+void CMatrixConverter::setRawLittleEndian(const bool p_value)
+{
+    m_rawLittleEndian = p_value;
+}
+
+void CMatrixConverter::setRawBayerPattern(const int p_value)
+{
+    m_rawBayerPattern = p_value;
+}
+
+void CMatrixConverter::setRawHeaderSize(const int p_value)
+{
+    m_rawHeaderSize = p_value;
+}
+
+void CMatrixConverter::setMfeVersion(const int p_value)
+{
+    m_mfeVersion = p_value;
+}
+
+void CMatrixConverter::setMemoryMapping(const bool p_value)
+{
+    m_memoryMapping = p_value;
+}
+
+std::shared_ptr<CMappedFile> CMatrixConverter::mapping() const
+{
+    return m_mapping;
+}
+
+void CMatrixConverter::setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler)
+{
+    m_progressHandler = p_handler;
+}
+
+std::shared_ptr<CEdfFile> CMatrixConverter::edfFile() const
+{
+    return m_edfFile;
+}
+
 bool CMatrixConverter::load(const QString& p_filename)
 {
+    m_mapping.reset();
+    m_edfFile.reset();
+
     const QString suffix = QFileInfo(p_filename).suffix().toLower();
 
     if (s_fileStorageExtensions.contains(suffix))
@@ -210,73 +288,23 @@ const CMetadata& CMatrixConverter::metadata()
 
 bool CMatrixConverter::loadFromTxt(const QString& p_filename)
 {
-    QFile file(p_filename);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    CTxtFile txt;
+    txt.setProgressHandler(m_progressHandler);
+    if (!txt.read(p_filename))
     {
-        QTextStream stream(&file);
-
-        // first line contains the number of columns and rows of the matrix
-        QStringList values = stream.readLine().split(" ");
-        if (values.size() != 2)
-        {
-            qWarning() << QString("CMatrixConverter::loadFromTxt first line of file [%1] should contain COL ROW information but has [%2]")
-                              .arg(p_filename)
-                              .arg(values.join(" "));
-            return false;
-        }
-
-        const uint rows = values[1].toInt(), cols = values[0].toInt();
-        if (rows == 0 || cols == 0)
-        {
-            qWarning() << "CMatrixConverter::loadFromTxt invalid dimensions for matrix:" << p_filename;
-            return false;
-        }
-
-        m_data.create(rows, cols, CV_64FC1);
-
-        // second line contains matrix values
-        values = stream.readLine().split(" ");
-
-        for (uint v = 0; v < rows * cols; ++v)
-        {
-            int row                     = v / cols;
-            int col                     = v % cols;
-            m_data.at<double>(row, col) = values[v].toDouble();
-        }
-
-        file.close();
-
-        return true;
+        qWarning() << "CMatrixConverter::loadFromTxt invalid matrix:" << p_filename;
+        return false;
     }
 
-    qWarning() << "CMatrixConverter::loadFromTxt unable to open:" << p_filename;
-    return false;
+    m_data = txt.data();
+    return true;
 }
 
 bool CMatrixConverter::saveToTxt(const QString& p_filename)
 {
-    m_data.convertTo(m_data, CV_64FC1);
-
-    QFile file(p_filename);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        QTextStream stream(&file);
-        stream << m_data.cols << " " << m_data.rows << "\n";
-
-        for (int j = 0; j < m_data.rows; ++j)
-        {
-            for (int i = 0; i < m_data.cols; ++i)
-            {
-                stream << m_data.at<double>(j, i) << " ";
-            }
-        }
-
-        file.close();
-        return true;
-    }
-
-    qWarning() << "CMatrixConverter::saveToTxt unable to open:" << p_filename;
-    return false;
+    CTxtFile txt;
+    txt.setData(m_data);
+    return txt.write(p_filename);
 }
 
 bool CMatrixConverter::loadFromFileStorage(const QString& p_filename)
@@ -332,6 +360,13 @@ bool CMatrixConverter::loadFromImage(const QString& p_filename)
         return false;
     }
 
+    readExifMetadata(p_filename, m_metadata);
+
+    return true;
+}
+
+void CMatrixConverter::readExifMetadata(const QString& p_filename, CMetadata& p_metadata)
+{
 #if defined(LIBEXIV2_ENABLED)
     try
     {
@@ -355,7 +390,7 @@ bool CMatrixConverter::loadFromImage(const QString& p_filename)
                 continue;
             }
 
-            m_metadata.addProperty(CProperty(key, value));
+            p_metadata.addProperty(CProperty(key, value));
         }
     }
     catch (std::exception& e)
@@ -367,9 +402,10 @@ bool CMatrixConverter::loadFromImage(const QString& p_filename)
     {
         qDebug() << "Can't read exif metadata for file:" << p_filename;
     }
+#else
+    Q_UNUSED(p_filename);
+    Q_UNUSED(p_metadata);
 #endif
-
-    return true;
 }
 
 bool CMatrixConverter::saveToImage(const QString& p_filename)
@@ -406,50 +442,31 @@ bool CMatrixConverter::saveToImage(const QString& p_filename)
 
 bool CMatrixConverter::loadFromRaw(const QString& p_filename)
 {
-    if (m_rawType == 0)
+    CRawFile raw;
+    raw.setType(m_rawType);
+    raw.setSize(m_rawWidth, m_rawHeight);
+    raw.setLittleEndian(m_rawLittleEndian);
+    raw.setBayerPattern(m_rawBayerPattern);
+    raw.setHeaderSize(m_rawHeaderSize);
+    if (!raw.read(p_filename, m_memoryMapping))
     {
-        unsigned short* buffer = new unsigned short[m_rawWidth * m_rawHeight];
-        FILE* fd               = fopen(p_filename.toStdString().c_str(), "rb");
-        if (fd != nullptr)
-        {
-            size_t readBytes = fread(buffer, sizeof(unsigned short), m_rawWidth * m_rawHeight, fd);
-            fclose(fd);
-
-            if (readBytes == 0)
-            {
-                qWarning() << "Nothing to read from raw image file:" << p_filename;
-                delete[] buffer;
-                return false;
-            }
-        }
-        else
-        {
-            qWarning() << "Can't open raw image file in read mode:" << p_filename;
-            delete[] buffer;
-            return false;
-        }
-
-        cv::Mat rawData(cv::Size(m_rawWidth, m_rawHeight), CV_16U, buffer);
-
-        const double ratio = 127.5 / 511.5; // conversion from 10bits to 8 bits
-        m_data             = rawData * ratio;
-        m_data.convertTo(m_data, CV_8UC1);
-        delete[] buffer;
-    }
-    else
-    {
-        qWarning() << "CMatrixConverter::loadFromRaw format not supported yet for type:" << m_rawType;
         return false;
     }
 
+    m_data    = raw.data();
+    m_mapping = raw.mapping();
     return true;
 }
 
 bool CMatrixConverter::saveToRaw(const QString& p_filename)
 {
-    Q_UNUSED(p_filename);
-    qWarning() << "CMatrixConverter::saveToRaw not implemented yet";
-    return false;
+    CRawFile raw;
+    raw.setType(m_rawType);
+    raw.setLittleEndian(m_rawLittleEndian);
+    raw.setBayerPattern(m_rawBayerPattern);
+    raw.setHeaderSize(m_rawHeaderSize);
+    raw.setData(m_data);
+    return raw.write(p_filename);
 }
 
 bool CMatrixConverter::loadFromMfe(const QString& p_filename)
@@ -457,8 +474,13 @@ bool CMatrixConverter::loadFromMfe(const QString& p_filename)
     try
     {
         MatrixFormatExchange mfe;
-        mfe.read(p_filename);
-        m_data = mfe.data();
+        if (!mfe.read(p_filename, m_memoryMapping))
+        {
+            return false;
+        }
+
+        m_data    = mfe.data();
+        m_mapping = mfe.mapping();
         m_metadata.addProperty(CProperty("Comment", QString::fromStdString(mfe.comment())));
     }
     catch (cv::Exception& e)
@@ -477,9 +499,13 @@ bool CMatrixConverter::saveToMfe(const QString& p_filename)
     try
     {
         MatrixFormatExchange mfe;
-        mfe.setData(m_data);
+        mfe.setVersion(m_mfeVersion);
+        mfe.setData(m_data.isContinuous() ? m_data : m_data.clone());
         mfe.setComment("MatrixViewer");
-        mfe.write(p_filename);
+        if (!mfe.write(p_filename))
+        {
+            return false;
+        }
     }
     catch (cv::Exception& e)
     {
@@ -496,10 +522,18 @@ bool CMatrixConverter::loadFromEdf(const QString& p_filename)
 {
     try
     {
-        CEdfFile edf;
-        edf.read(p_filename);
-        m_data     = edf.data();
-        m_metadata = edf.metadata();
+        auto edf = std::make_shared<CEdfFile>();
+        edf->setProgressHandler(m_progressHandler);
+        const bool ok = edf->read(p_filename);
+        edf->setProgressHandler(nullptr); // other frames are decoded without progress
+        if (!ok)
+        {
+            return false;
+        }
+
+        m_data     = edf->data();
+        m_metadata = edf->metadata();
+        m_edfFile  = edf;
     }
     catch (cv::Exception& e)
     {
@@ -534,116 +568,208 @@ bool CMatrixConverter::saveToEdf(const QString& p_filename)
 
 bool CMatrixConverter::loadFromAda(const QString& p_filename)
 {
-    try
+    QElapsedTimer timer;
+    timer.start();
+
+    CAdaFile ada;
+    ada.setProgressHandler(m_progressHandler);
+    if (!ada.read(p_filename))
     {
-        QElapsedTimer timer;
-        timer.start();
+        return false;
+    }
+    m_data = ada.data();
 
-        QFile file(p_filename);
-        if (!file.open(QIODevice::ReadOnly))
-        {
-            qWarning() << "Can't read matrix from:" << file.fileName();
-            qWarning() << "-- error:" <<file.errorString();
-            return false;
-        }
+    qInfo() << "Matrix" << m_data.rows << "x" << m_data.cols << "loaded from:" << p_filename << "in:" << timer.elapsed() << "ms";
+    return true;
+}
 
-        QDataStream stream(&file);
-        qint32 columns, rows;
-        qint8 type, channels;
-        stream >> columns >> rows >> type >> channels;
+bool CMatrixConverter::saveToAda(const QString& p_filename)
+{
+    QElapsedTimer timer;
+    timer.start();
 
-        m_data.create(rows, columns, type);
+    CAdaFile ada;
+    ada.setData(m_data);
+    if (!ada.write(p_filename))
+    {
+        return false;
+    }
 
-        switch (type)
-        {
-            case CV_64F:
-            {
-                for (int c = 0; c < columns; ++c)
-                {
-                    for (int r = 0; r < rows; ++r)
-                    {
-                        double value;
-                        stream >> value;
-                        m_data.at<double>(r, c) = value;
-                    }
-                }
-            }
-            break;
+    qInfo() << "Matrix" << m_data.rows << "x" << m_data.cols << "saved as:" << p_filename << "in:" << timer.elapsed() << "ms";
+    return true;
+}
 
-            case CV_32F:
-            {
-                for (int c = 0; c < columns; ++c)
-                {
-                    for (int r = 0; r < rows; ++r)
-                    {
-                        stream >> m_data.at<float>(r, c);
-                    }
-                }
-            }
-            break;
+bool CMatrixConverter::isFilenameSupported(const QString& p_filename)
+{
+    static const QStringList s_extensions = QStringList() << CMatrixConverter::s_fileStorageExtensions << CMatrixConverter::s_imageExtensions << "mfe"
+                                                          << "edf"
+                                                          << "ada"
+                                                          << "txt"
+                                                          << "raw";
+    return s_extensions.contains(QFileInfo(p_filename).suffix().toLower());
+}
+
+CMatrixInfo CMatrixConverter::probe(const QString& p_filename)
+{
+    CMatrixInfo info;
+    const QString suffix = QFileInfo(p_filename).suffix().toLower();
+
+    bool ok = false;
+    if (s_fileStorageExtensions.contains(suffix))
+    {
+        ok = probeFileStorage(p_filename, info);
+    }
+    else if (suffix == "txt")
+    {
+        ok = CTxtFile::probe(p_filename, info);
+    }
+    else if (suffix == "raw")
+    {
+        ok = probeRaw(p_filename, info);
+    }
+    else if (suffix == "mfe")
+    {
+        ok = probeMfe(p_filename, info);
+    }
+    else if (suffix == "edf")
+    {
+        ok = probeEdf(p_filename, info);
+    }
+    else if (suffix == "ada")
+    {
+        ok = CAdaFile::probe(p_filename, info);
+    }
+    else
+    {
+        ok = probeImage(p_filename, info);
+    }
+
+    if (!ok)
+    {
+        return CMatrixInfo();
+    }
+    return info;
+}
 
-            case CV_32S:
+bool CMatrixConverter::probeFileStorage(const QString& p_filename, CMatrixInfo& p_info)
+{
+    // The "rows", "cols" and "dt" attributes of the matrix are written before
+    // its values: only the beginning of the file is scanned for them.
+    QFile file(p_filename);
+    if (file.open(QIODevice::ReadOnly))
+    {
+        const QString head = QString::fromLatin1(file.read(4096));
+        file.close();
+
+        static const QRegularExpression s_rowsRegExp("\\brows\\W+(\\d+)");
+        static const QRegularExpression s_colsRegExp("\\bcols\\W+(\\d+)");
+        static const QRegularExpression s_typeRegExp("\\bdt\\W+(\\d*)([ucwsifd])\\b");
+
+        const QRegularExpressionMatch rows = s_rowsRegExp.match(head);
+        const QRegularExpressionMatch cols = s_colsRegExp.match(head);
+        const QRegularExpressionMatch type = s_typeRegExp.match(head);
+        if (rows.hasMatch() && cols.hasMatch() && type.hasMatch())
+        {
+            static const QString s_depthCodes = "ucwsifd";
+            const int channels = type.captured(1).isEmpty() ? 1 : type.captured(1).toInt();
+            const int depth    = s_depthCodes.indexOf(type.captured(2));
+            if (channels > 0 && channels <= CV_CN_MAX)
             {
-                for (int c = 0; c < columns; ++c)
-                {
-                    for (int r = 0; r < rows; ++r)
-                    {
-                        stream >> m_data.at<int>(r, c);
-                    }
-                }
+                p_info.setSize(rows.captured(1).toInt(), cols.captured(1).toInt());
+                p_info.setType(CV_MAKETYPE(depth, channels));
+                return p_info.isValid();
             }
-            break;
-
         }
+    }
 
-        qInfo() << "Matrix" << m_data.rows << "x" << m_data.cols << "loaded from:" << p_filename << "in:" << timer.elapsed() << "ms";
+    // Unusual layout: fall back to a complete load
+    CMatrixConverter converter;
+    if (!converter.loadFromFileStorage(p_filename))
+    {
+        return false;
     }
-    catch (cv::Exception& e)
+
+    p_info.setSize(converter.m_data.rows, converter.m_data.cols);
+    p_info.setType(converter.m_data.type());
+    return p_info.isValid();
+}
+
+bool CMatrixConverter::probeImage(const QString& p_filename, CMatrixInfo& p_info)
+{
+    QImageReader reader(p_filename);
+    const QSize size = reader.size();
+    if (!size.isValid())
     {
-        qWarning() << "OpenCV error while reading ADA matrix";
-        qWarning() << "file: " << p_filename;
-        qWarning() << "error: " << e.what();
         return false;
     }
 
+    // Same types as cv::imread(-1) with the alpha channel removed
+    int type;
+    switch (reader.imageFormat())
+    {
+        case QImage::Format_Mono:
+        case QImage::Format_MonoLSB:
+        case QImage::Format_Indexed8:
+        case QImage::Format_Grayscale8:
+            type = CV_8UC1;
+            break;
+
+        case QImage::Format_Grayscale16:
+            type = CV_16UC1;
+            break;
+
+        case QImage::Format_RGBX64:
+        case QImage::Format_RGBA64:
+        case QImage::Format_RGBA64_Premultiplied:
+            type = CV_16UC3;
+            break;
+
+        default:
+            type = CV_8UC3;
+            break;
+    }
+
+    p_info.setSize(size.height(), size.width());
+    p_info.setType(type);
+    readExifMetadata(p_filename, p_info.metadata());
     return true;
 }
 
-bool CMatrixConverter::saveToAda(const QString& p_filename)
+bool CMatrixConverter::probeRaw(const QString& p_filename, CMatrixInfo& p_info)
 {
-    QElapsedTimer timer;
-    timer.start();
+    // Raw files have no header: the layout comes from the settings
+    CMatrixConverter converter;
 
-    QFile file(p_filename);
-    if (!file.open(QIODevice::WriteOnly))
+    const qint64 valueCount = static_cast<qint64>(converter.m_rawWidth) * converter.m_rawHeight;
+    const int depth         = (converter.m_rawType == CRawFile::Type_Raw8) ? CV_8U : CV_16U;
+    const int channels      = (converter.m_rawBayerPattern == CRawFile::Bayer_None) ? 1 : 3;
+    if (!QFileInfo(p_filename).isFile() || valueCount <= 0)
     {
-        qWarning() << "Can't write matrix as:" << file.fileName();
-        qWarning() << "-- error:" <<file.errorString();
         return false;
     }
 
+    p_info.setSize(converter.m_rawHeight, converter.m_rawWidth);
+    p_info.setType(CV_MAKETYPE(depth, channels));
+    return true;
+}
+
+bool CMatrixConverter::probeMfe(const QString& p_filename, CMatrixInfo& p_info)
+{
     try
     {
-        const qint32 columns = m_data.cols;
-        const qint32 rows = m_data.rows;
-        const qint8 type = m_data.type();
-        const qint8 channels = m_data.channels();
-
-        QDataStream stream(&file);
-        stream << columns << rows << type << channels;
-        for (int c = 0; c < columns; ++c)
+        MatrixFormatExchange mfe;
+        if (!mfe.open(p_filename))
         {
-            for (int r = 0; r < rows; ++r)
-            {
-                stream << m_data.at<double>(r, c);
-            }
+            return false;
         }
 
-        qInfo() << "Matrix" << m_data.rows << "x" << m_data.cols << "saved as:" << p_filename << "in:" << timer.elapsed() << "ms";
+        p_info.setSize(mfe.rows(), mfe.cols());
+        p_info.setType(mfe.type());
+        p_info.metadata().addProperty(CProperty("Comment", QString::fromStdString(mfe.comment())));
     }
     catch (cv::Exception& e)
     {
-        qWarning() << "OpenCV error while reading ADA matrix";
+        qWarning() << "OpenCV error while probing MFE matrix";
         qWarning() << "file: " << p_filename;
         qWarning() << "error: " << e.what();
         return false;
@@ -652,11 +778,18 @@ bool CMatrixConverter::saveToAda(const QString& p_filename)
     return true;
 }
 
-bool CMatrixConverter::isFilenameSupported(const QString& p_filename)
+bool CMatrixConverter::probeEdf(const QString& p_filename, CMatrixInfo& p_info)
 {
-    static const QStringList s_extensions = QStringList() << CMatrixConverter::s_fileStorageExtensions << CMatrixConverter::s_imageExtensions << "mfe"
-                                                          << "edf"
-                                                          << "txt"
-                                                          << "raw";
-    return s_extensions.contains(QFileInfo(p_filename).suffix().toLower());
+    CEdfFile edf;
+    if (!edf.readHeaders(p_filename))
+    {
+        return false;
+    }
+
+    const cv::Size size = edf.frameSize(0);
+    p_info.setSize(size.height, size.width);
+    p_info.setType(edf.frameType(0));
+    p_info.setFrameCount(edf.frameCount());
+    p_info.metadata() = edf.metadata();
+    return true;
 }
@@ -18,11 +18,17 @@
 
 #pragma once
 
+#include "matrix-info.hh"
 #include "metadata.hh"
 
 #include <QObject>
+#include <functional>
+#include <memory>
 #include <opencv2/opencv.hpp>
 
+class CEdfFile;
+class CMappedFile;
+
 /*!
   \file matrix-converter.hh
   \class CMatrixConverter
@@ -40,6 +46,16 @@
   ### MFE files
 
   Custom serialization in MFE binary format.
+  Matrices are saved in version 1 (raw values) unless setMfeVersion(2)
+  is called to save them as compressed chunks.
+  When memory mapping is enabled (see setMemoryMapping()), the matrix
+  points directly into the mapped file instead of being copied.
+
+  ### RAW files
+
+  Raw sensor images, see CRawFile for the supported layouts.
+  The layout is read from the application settings and may be
+  overridden with the setRaw*() methods.
 
   ### TXT files
 
@@ -89,6 +105,36 @@ public:
     void setRawWidth(const int p_value);
     void setRawHeight(const int p_value);
     void setRawType(const int p_value);
+    void setRawLittleEndian(const bool p_value);
+    void setRawBayerPattern(const int p_value);
+    void setRawHeaderSize(const int p_value);
+
+    void setMfeVersion(const int p_value);
+
+    /*!
+  If \a p_value is \a true, formats that support it are loaded through
+  a memory mapping of the file instead of being copied in memory.
+  The loaded data are then only valid as long as mapping() is alive.
+  */
+    void setMemoryMapping(const bool p_value);
+
+    /*!
+  Returns the memory mapping of the last loaded file, if any.
+  */
+    std::shared_ptr<CMappedFile> mapping() const;
+
+    /*!
+  Sets the function called during load() with the number of bytes read and the file size.
+  If the function returns \a false, loading is canceled and load() returns \a false.
+  Only TXT, ADA and EDF files report intermediate progress.
+  */
+    void setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler);
+
+    /*!
+  Returns the EDF file of the last loaded matrix, if any.
+  It gives access to the other frames of multi-frame EDF files.
+  */
+    std::shared_ptr<CEdfFile> edfFile() const;
 
     /*!
   Return \a true if \a p_filename ends with a supported extensions,
@@ -96,6 +142,15 @@ public:
   */
     static bool isFilenameSupported(const QString& p_filename);
 
+    /*!
+  Returns the dimensions, type and metadata of the matrix stored in \a p_filename
+  without decoding its values.
+  Only the header of the file is read, except for FileStorage files
+  whose header can't be located without parsing the values.
+  The returned information is invalid if the file can't be read.
+  */
+    static CMatrixInfo probe(const QString& p_filename);
+
 private:
     bool loadFromFileStorage(const QString& filename);
     bool saveToFileStorage(const QString& filename);
@@ -118,6 +173,14 @@ private:
     bool loadFromAda(const QString& filename);
     bool saveToAda(const QString& filename);
 
+    static bool probeFileStorage(const QString& filename, CMatrixInfo& info);
+    static bool probeImage(const QString& filename, CMatrixInfo& info);
+    static bool probeRaw(const QString& filename, CMatrixInfo& info);
+    static bool probeMfe(const QString& filename, CMatrixInfo& info);
+    static bool probeEdf(const QString& filename, CMatrixInfo& info);
+
+    static void readExifMetadata(const QString& filename, CMetadata& metadata);
+
     FileFormat m_format;
     cv::Mat m_data;
     CMetadata m_metadata;
@@ -125,6 +188,16 @@ private:
     int m_rawType;
     int m_rawWidth;
     int m_rawHeight;
+    bool m_rawLittleEndian;
+    int m_rawBayerPattern;
+    int m_rawHeaderSize;
+
+    int m_mfeVersion;
+
+    bool m_memoryMapping;
+    std::function<bool(qint64, qint64)> m_progressHandler;
+    std::shared_ptr<CMappedFile> m_mapping;
+    std::shared_ptr<CEdfFile> m_edfFile;
 
 public:
     static const QStringList s_fileStorageExtensions;
@@ -0,0 +1,266 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "matrix-histogram.hh"
+
+#include "parallel-bands.hh"
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+// 16-bit data get one bin per value
+static const int s_maxBins = 65536;
+
+// Adaptive number of bins of floating point data
+static const int s_floatingPointBins = 1024;
+
+typedef void (*BandCounter)(const cv::Mat &p_data, const cv::Range &p_rows, const double p_lower, const double p_scale, const int p_bins, std::vector<quint64> &p_counts);
+
+template <typename T>
+static void countBand(const cv::Mat &p_data, const cv::Range &p_rows, const double p_lower, const double p_scale, const int p_bins, std::vector<quint64> &p_counts)
+{
+    const int cn   = p_data.channels();
+    const int cols = p_data.cols;
+
+    std::vector<int> indices(cols);
+    for (int i = p_rows.start; i < p_rows.end; ++i)
+    {
+        const T *row = p_data.ptr<T>(i);
+        for (int c = 0; c < cn; ++c)
+        {
+            // Indices first, without dependency between the values: out of range and NaN values get -1
+            for (int j = 0; j < cols; ++j)
+            {
+                const double bin = (static_cast<double>(row[j * cn + c]) - p_lower) * p_scale;
+                indices[j]       = (bin >= 0 && bin <= p_bins) ? qMin(static_cast<int>(bin), p_bins - 1) : -1;
+            }
+
+            quint64 *counts = p_counts.data() + static_cast<size_t>(c) * p_bins;
+            for (int j = 0; j < cols; ++j)
+            {
+                if (indices[j] >= 0)
+                {
+                    ++counts[indices[j]];
+                }
+            }
+        }
+    }
+}
+
+CMatrixHistogram::CMatrixHistogram() : m_lower(0), m_upper(0), m_bins(0), m_isDiscrete(false), m_counts() { }
+
+CMatrixHistogram::CMatrixHistogram(const int p_channels, const int p_bins, const double p_lower, const double p_upper)
+    : m_lower(p_lower)
+    , m_upper(p_upper)
+    , m_bins(p_bins)
+    , m_isDiscrete(false)
+    , m_counts(p_channels, QVector<quint64>(p_bins, 0))
+{
+}
+
+CMatrixHistogram::~CMatrixHistogram() { }
+
+int CMatrixHistogram::maxBins()
+{
+    return s_maxBins;
+}
+
+bool CMatrixHistogram::isEmpty() const
+{
+    return m_counts.isEmpty() || m_bins == 0;
+}
+
+int CMatrixHistogram::channels() const
+{
+    return m_counts.size();
+}
+
+int CMatrixHistogram::bins() const
+{
+    return m_bins;
+}
+
+double CMatrixHistogram::lower() const
+{
+    return m_lower;
+}
+
+double CMatrixHistogram::upper() const
+{
+    return m_upper;
+}
+
+double CMatrixHistogram::binWidth() const
+{
+    return (m_bins > 0) ? (m_upper - m_lower) / m_bins : 0;
+}
+
+double CMatrixHistogram::binValue(const int p_bin) const
+{
+    return m_isDiscrete ? m_lower + p_bin : m_lower + (p_bin + 0.5) * binWidth();
+}
+
+const QVector<quint64> &CMatrixHistogram::counts(const int p_channel) const
+{
+    return m_counts.at(p_channel);
+}
+
+quint64 CMatrixHistogram::total(const int p_channel) const
+{
+    const QVector<quint64> &counts = m_counts.at(p_channel);
+    return std::accumulate(counts.begin(), counts.end(), quint64(0));
+}
+
+int CMatrixHistogram::binAt(const double p_value) const
+{
+    const double bin = (p_value - m_lower) * m_bins / (m_upper - m_lower);
+    return (m_bins > 0 && bin >= 0 && bin <= m_bins) ? qMin(static_cast<int>(bin), m_bins - 1) : -1;
+}
+
+bool CMatrixHistogram::accumulate(const cv::Mat &p_values, const int p_weight)
+{
+    if (isEmpty() || p_values.channels() != channels())
+    {
+        return false;
+    }
+
+    cv::Mat values;
+    p_values.convertTo(values, CV_64F);
+    values = values.reshape(1, static_cast<int>(p_values.total()));
+
+    // All the bins are found before any of them is modified
+    std::vector<int> indices(static_cast<size_t>(values.total()));
+    for (int i = 0; i < values.rows; ++i)
+    {
+        for (int c = 0; c < values.cols; ++c)
+        {
+            const double value = values.at<double>(i, c);
+            const int bin      = binAt(value);
+            if (bin < 0 && !std::isnan(value))
+            {
+                return false;
+            }
+            indices[static_cast<size_t>(i) * values.cols + c] = bin;
+        }
+    }
+
+    for (int i = 0; i < values.rows; ++i)
+    {
+        for (int c = 0; c < values.cols; ++c)
+        {
+            const int bin = indices[static_cast<size_t>(i) * values.cols + c];
+            if (bin >= 0)
+            {
+                m_counts[c][bin] += p_weight;
+            }
+        }
+    }
+    return true;
+}
+
+void CMatrixHistogram::shift(const double p_offset)
+{
+    m_lower += p_offset;
+    m_upper += p_offset;
+}
+
+CMatrixHistogram CMatrixHistogram::compute(const cv::Mat &p_data, const int p_bins, const double p_lower, const double p_upper)
+{
+    static const BandCounter s_bandCounters[] = {countBand<uchar>, countBand<schar>, countBand<ushort>, countBand<short>, countBand<int>, countBand<float>, countBand<double>};
+
+    const int depth = p_data.depth();
+    if (p_data.empty() || depth > CV_64F || p_bins < 0)
+    {
+        return CMatrixHistogram();
+    }
+
+    try
+    {
+        double lower = p_lower;
+        double upper = p_upper;
+        if (!(lower < upper))
+        {
+            cv::minMaxLoc(p_data.reshape(1), &lower, &upper);
+        }
+
+        // Integer values: the range includes the maximum value, so that each bin holds a single value if possible
+        bool isDiscrete = false;
+        int bins        = p_bins;
+        if (depth < CV_32F && p_bins == 0)
+        {
+            lower             = std::floor(lower);
+            upper             = std::floor(upper) + 1;
+            const double span = upper - lower;
+            isDiscrete        = (span <= s_maxBins);
+            bins              = isDiscrete ? static_cast<int>(span) : s_maxBins;
+        }
+        else if (p_bins == 0)
+        {
+            bins = s_floatingPointBins;
+        }
+
+        if (!(lower < upper))
+        {
+            upper = lower + 1;
+        }
+
+        CMatrixHistogram histogram(p_data.channels(), bins, lower, upper);
+        histogram.m_isDiscrete = isDiscrete;
+
+        // Each stripe counts its bands in a private histogram, that is merged at the end
+        const BandCounter counter = s_bandCounters[depth];
+        const double scale        = bins / (upper - lower);
+        const int rows            = CParallelBands::rows(p_data);
+        const int bands           = (p_data.rows + rows - 1) / rows;
+        const int cn              = p_data.channels();
+        QMutex mutex;
+        cv::parallel_for_(
+            cv::Range(0, bands),
+            [&](const cv::Range &p_range)
+            {
+                std::vector<quint64> counts(static_cast<size_t>(cn) * bins, 0);
+                for (int band = p_range.start; band < p_range.end; ++band)
+                {
+                    counter(p_data, cv::Range(band * rows, qMin(p_data.rows, (band + 1) * rows)), lower, scale, bins, counts);
+                }
+
+                QMutexLocker locker(&mutex);
+                for (int c = 0; c < cn; ++c)
+                {
+                    quint64 *merged = histogram.m_counts[c].data();
+                    for (int i = 0; i < bins; ++i)
+                    {
+                        merged[i] += counts[static_cast<size_t>(c) * bins + i];
+                    }
+                }
+            },
+            qMax(1, qMin(bands, 2 * cv::getNumThreads())));
+
+        return histogram;
+    }
+    catch (cv::Exception &e)
+    {
+        qWarning() << "Can't compute histogram";
+        qWarning() << "-- error:" << e.what();
+    }
+
+    return CMatrixHistogram();
+}
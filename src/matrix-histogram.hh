@@ -0,0 +1,117 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file matrix-histogram.hh
+  \class CMatrixHistogram
+  \brief CMatrixHistogram counts the values of each channel of a matrix in their native type
+
+  The bins split the range [lower(), upper()) in bins() intervals of the same width,
+  the upper bound being counted in the last bin. Values out of the range and NaN are
+  not counted.
+
+  compute() scans the matrix by bands of rows in parallel: each band is counted
+  in a private histogram, and the private histograms are merged at the end.
+  Bin indices of a row are computed first, in a loop without dependencies that
+  the compiler can vectorize, and counted afterwards.
+
+  With an adaptive bin count, integer matrices get one bin per value as long as
+  their range has at most maxBins() values, which gives the exact distribution
+  of 8-bit and 16-bit data.
+*/
+class CMatrixHistogram
+{
+public:
+    /// Constructor.
+    CMatrixHistogram();
+
+    /// Constructor. Histogram of \a p_channels channels whose bins are all empty.
+    CMatrixHistogram(const int p_channels, const int p_bins, const double p_lower, const double p_upper);
+
+    /// Destructor.
+    ~CMatrixHistogram();
+
+    /*!
+    Returns the maximum number of bins of an adaptive histogram.
+  */
+    static int maxBins();
+
+    bool isEmpty() const;
+
+    int channels() const;
+    int bins() const;
+
+    double lower() const;
+    double upper() const;
+    double binWidth() const;
+
+    /*!
+    Returns the value represented by the bin \a p_bin:
+    the value itself if the bin holds a single integer value, its center otherwise.
+  */
+    double binValue(const int p_bin) const;
+
+    /*!
+    Returns the number of values in each bin of the channel \a p_channel.
+  */
+    const QVector<quint64> &counts(const int p_channel) const;
+
+    /*!
+    Returns the number of values counted in the channel \a p_channel.
+  */
+    quint64 total(const int p_channel) const;
+
+    /*!
+    Returns the bin of the value \a p_value, -1 if it is out of the range or NaN.
+  */
+    int binAt(const double p_value) const;
+
+    /*!
+    Adds \a p_weight to the bins of the values \a p_values, that have the channels of the histogram.
+    A negative weight removes values that were previously counted.
+    Returns \a false, without modifying the histogram, if a value other than NaN is out of the range.
+  */
+    bool accumulate(const cv::Mat &p_values, const int p_weight);
+
+    /*!
+    Moves the range of the bins by \a p_offset, after the same offset has been added to all the values.
+  */
+    void shift(const double p_offset);
+
+    /*!
+    Counts the values of each channel of \a p_data in \a p_bins bins over [\a p_lower, \a p_upper].
+    If \a p_bins is 0, the number of bins is adapted to the type and the range of the values.
+    If \a p_lower is not lower than \a p_upper, the range of the values of the matrix is used.
+  */
+    static CMatrixHistogram compute(const cv::Mat &p_data, const int p_bins = 0, const double p_lower = 0, const double p_upper = 0);
+
+private:
+    double m_lower;
+    double m_upper;
+    int m_bins;
+
+    // one bin per integer value
+    bool m_isDiscrete;
+    QVector<QVector<quint64>> m_counts;
+};
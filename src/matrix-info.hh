@@ -0,0 +1,127 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include "metadata.hh"
+
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file matrix-info.hh
+  \class CMatrixInfo
+  \brief CMatrixInfo describes the matrix stored in a file without its values
+
+  \sa CMatrixConverter::probe
+*/
+class CMatrixInfo
+{
+public:
+    CMatrixInfo() : m_rows(0), m_cols(0), m_type(-1), m_frameCount(1), m_metadata() { }
+
+    bool isValid() const
+    {
+        return m_rows > 0 && m_cols > 0 && m_type >= 0;
+    }
+
+    int rows() const
+    {
+        return m_rows;
+    }
+
+    int cols() const
+    {
+        return m_cols;
+    }
+
+    void setSize(const int p_rows, const int p_cols)
+    {
+        m_rows = p_rows;
+        m_cols = p_cols;
+    }
+
+    int type() const
+    {
+        return m_type;
+    }
+
+    void setType(const int p_type)
+    {
+        m_type = p_type;
+    }
+
+    int channels() const
+    {
+        return CV_MAT_CN(m_type);
+    }
+
+    int frameCount() const
+    {
+        return m_frameCount;
+    }
+
+    void setFrameCount(const int p_count)
+    {
+        m_frameCount = p_count;
+    }
+
+    /// Returns the size in bytes of the matrix values once loaded in memory (single frame).
+    qint64 byteSize() const
+    {
+        return isValid() ? static_cast<qint64>(m_rows) * m_cols * CV_ELEM_SIZE(m_type) : 0;
+    }
+
+    const CMetadata& metadata() const
+    {
+        return m_metadata;
+    }
+
+    CMetadata& metadata()
+    {
+        return m_metadata;
+    }
+
+    QString typeString() const
+    {
+        static const char* s_depths[] = {"8U", "8S", "16U", "16S", "32S", "32F", "64F", "16F"};
+        return QString("%1C%2").arg(s_depths[CV_MAT_DEPTH(m_type)]).arg(channels());
+    }
+
+    QString toString() const
+    {
+        if (!isValid())
+        {
+            return QString();
+        }
+
+        QString result = QString("%1 x %2 %3").arg(m_rows).arg(m_cols).arg(typeString());
+        if (m_frameCount > 1)
+        {
+            result += QString(" (%1 frames)").arg(m_frameCount);
+        }
+        return result;
+    }
+
+private:
+    int m_rows;
+    int m_cols;
+    int m_type;
+    int m_frameCount;
+    CMetadata m_metadata;
+};
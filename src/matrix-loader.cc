@@ -0,0 +1,158 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "matrix-loader.hh"
+
+#include "matrix-converter.hh"
+#include "matrix-model.hh"
+
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent>
+#include <atomic>
+
+// Interval between two updates of the progress
+static const int s_progressInterval = 100; // ms
+
+struct CMatrixLoader::LoadState
+{
+    // created by the task in its thread, then handed over to the thread of the loader
+    CMatrixConverter* converter;
+    std::atomic<bool> canceled;
+    std::atomic<int> progress;
+    bool loaded;
+
+    ~LoadState()
+    {
+        // the state may be released by the task: delete the converter from its own thread
+        if (converter != nullptr)
+        {
+            converter->deleteLater();
+        }
+    }
+};
+
+CMatrixLoader::CMatrixLoader(const QString& p_filePath, QObject* p_parent)
+    : QObject(p_parent)
+    , m_filePath(p_filePath)
+    , m_state(std::make_shared<LoadState>())
+    , m_watcher()
+    , m_timer(new QTimer(this))
+    , m_progress(-1)
+{
+    m_state->converter = nullptr;
+    m_state->canceled  = false;
+    m_state->progress  = 0;
+    m_state->loaded    = false;
+
+    m_timer->setInterval(s_progressInterval);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(updateProgress()));
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(taskFinished()));
+}
+
+CMatrixLoader::~CMatrixLoader()
+{
+    // The task keeps its own reference on the state: no need to wait for it
+    cancel();
+}
+
+const QString& CMatrixLoader::filePath() const
+{
+    return m_filePath;
+}
+
+void CMatrixLoader::start()
+{
+    std::shared_ptr<LoadState> state = m_state;
+    const QString filePath           = m_filePath;
+    QThread* loaderThread            = thread();
+
+    m_timer->start();
+    m_watcher.setFuture(QtConcurrent::run(
+        [state, filePath, loaderThread]()
+        {
+            // The converter is created, used and moved in this thread only
+            CMatrixConverter* converter = new CMatrixConverter;
+            LoadState* progressState    = state.get(); // alive as long as this task
+            converter->setMemoryMapping(true);
+            converter->setProgressHandler(
+                [progressState](qint64 p_bytes, qint64 p_total)
+                {
+                    if (p_total > 0)
+                    {
+                        progressState->progress = static_cast<int>(100 * qBound<qint64>(0, p_bytes, p_total) / p_total);
+                    }
+                    return !progressState->canceled;
+                });
+
+            const bool loaded = converter->load(filePath) && !state->canceled;
+            converter->setProgressHandler(nullptr);
+            converter->moveToThread(loaderThread);
+            state->converter = converter;
+            return loaded;
+        }));
+}
+
+bool CMatrixLoader::isCanceled() const
+{
+    return m_state->canceled;
+}
+
+void CMatrixLoader::cancel()
+{
+    m_state->canceled = true;
+}
+
+CMatrixModel* CMatrixLoader::takeModel()
+{
+    if (!m_state->loaded)
+    {
+        return nullptr;
+    }
+
+    m_state->loaded = false;
+    return new CMatrixModel(m_filePath, *m_state->converter);
+}
+
+void CMatrixLoader::updateProgress()
+{
+    const int percent = m_state->progress;
+    if (percent != m_progress)
+    {
+        m_progress = percent;
+        emit(progress(percent));
+    }
+}
+
+void CMatrixLoader::taskFinished()
+{
+    m_timer->stop();
+
+    m_state->loaded = m_watcher.result();
+    if (m_state->loaded)
+    {
+        m_state->progress = 100;
+        updateProgress();
+    }
+    else if (!isCanceled())
+    {
+        qWarning() << "Can't load file: " << m_filePath;
+    }
+
+    emit(finished(m_state->loaded));
+}
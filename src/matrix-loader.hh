@@ -0,0 +1,113 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class CMatrixModel;
+class QTimer;
+
+/*!
+  \file matrix-loader.hh
+  \class CMatrixLoader
+  \brief CMatrixLoader decodes a matrix file in a background thread
+
+  The file is decoded by a CMatrixConverter in the global thread pool
+  (see QThreadPool::globalInstance()), so that several loaders started
+  at the same time decode their files in parallel.
+
+  The progress reported by the converter is polled from the GUI thread
+  and emitted through progress(). The finished() signal is emitted once
+  the file has been decoded, canceled or failed to load.
+
+  Destroying a loader cancels it without waiting for the background task:
+  the task owns its state and releases it when it stops.
+  The converter is created in the task thread and moved to the thread of
+  the loader once the file is decoded, where it is deleted later.
+*/
+class CMatrixLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Constructor.
+    CMatrixLoader(const QString &p_filePath, QObject *p_parent = nullptr);
+
+    /// Destructor.
+    ~CMatrixLoader() override;
+
+    /*!
+    Returns the path of the file to decode.
+  */
+    const QString &filePath() const;
+
+    /*!
+    Starts decoding the file in the background.
+    \sa finished
+  */
+    void start();
+
+    /*!
+    Returns \a true if the loading has been canceled, \a false otherwise.
+    \sa cancel
+  */
+    bool isCanceled() const;
+
+    /*!
+    Returns a new model that holds the decoded matrix,
+    or \a nullptr if the loading is not finished or failed.
+    The caller takes ownership of the model.
+  */
+    CMatrixModel *takeModel();
+
+public slots:
+    /*!
+    Requests the background task to stop.
+    The finished() signal is still emitted when the task stops.
+  */
+    void cancel();
+
+signals:
+    /*!
+    This signal is emitted when the percentage of the file that has been read changes.
+  */
+    void progress(int p_percent);
+
+    /*!
+    This signal is emitted when the background task stops.
+    \a p_success is \a false if the file could not be loaded or if the loading was canceled.
+  */
+    void finished(bool p_success);
+
+private slots:
+    void updateProgress();
+    void taskFinished();
+
+private:
+    struct LoadState;
+
+    QString m_filePath;
+    std::shared_ptr<LoadState> m_state;
+    QFutureWatcher<bool> m_watcher;
+    QTimer *m_timer;
+    int m_progress;
+};
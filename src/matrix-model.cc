@@ -17,23 +17,141 @@
 //******************************************************************************
 #include "matrix-model.hh"
 
+#include "display-cache.hh"
+#include "edf.hh"
+#include "history.hh"
 #include "logger.hh"
+#include "mapped-file.hh"
+#include "matrix-comparator.hh"
 
 #include <QDebug>
 #include <QFile>
 #include <QImage>
 #include <QSettings>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QXmlStreamReader>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Longest representation of a value: -1.7976931348623157e+308
+static const int s_maxValueLength = 32;
+
+// Memory limit of the histories in bytes, read from the settings on first use
+static qint64 s_historyMemoryLimit = -1;
+
+template <typename T> static char* formatValue(char* p_first, char* p_last, const T p_value, const int p_precision)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        if (p_precision < 0)
+        {
+            return std::to_chars(p_first, p_last, p_value).ptr;
+        }
+        return std::to_chars(p_first, p_last, p_value, std::chars_format::general, p_precision).ptr;
+    }
+    else
+    {
+        // 8-bit values are printed as numbers, not characters
+        return std::to_chars(p_first, p_last, static_cast<int>(p_value)).ptr;
+    }
+}
+
+template <typename T, int CN> static QString formatCell(const cv::Mat& p_data, const int p_row, const int p_col, const int p_precision)
+{
+    char buffer[CN * (s_maxValueLength + 3)];
+    char* cursor    = buffer;
+    const T* values = p_data.ptr<T>(p_row) + p_col * CN;
+    for (int i = 0; i < CN; ++i)
+    {
+        if (i > 0)
+        {
+            std::memcpy(cursor, " | ", 3);
+            cursor += 3;
+        }
+        cursor = formatValue(cursor, buffer + sizeof(buffer), values[i], p_precision);
+    }
+    return QString::fromLatin1(buffer, static_cast<int>(cursor - buffer));
+}
+
+// Writes the rows \a p_rows of \a p_values as RGB pixels: value * alpha + beta, saturated to [0, 255]
+typedef void (*PixelRenderer)(const cv::Mat& p_values, uchar* p_pixels, const qsizetype p_stride, const cv::Range& p_rows, const double p_alpha, const double p_beta);
+
+template <typename T, int CN> static void renderPixels(const cv::Mat& p_values, uchar* p_pixels, const qsizetype p_stride, const cv::Range& p_rows, const double p_alpha, const double p_beta)
+{
+    // 8-bit values are looked up instead of being scaled
+    uchar lut[256];
+    if constexpr (sizeof(T) == 1)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            lut[i] = cv::saturate_cast<uchar>(static_cast<T>(i) * p_alpha + p_beta);
+        }
+    }
+
+    const auto scale = [&](const T p_value) -> uchar
+    {
+        if constexpr (sizeof(T) == 1)
+        {
+            return lut[static_cast<uchar>(p_value)];
+        }
+        else
+        {
+            return cv::saturate_cast<uchar>(p_value * p_alpha + p_beta);
+        }
+    };
+
+    for (int i = p_rows.start; i < p_rows.end; ++i)
+    {
+        const T* src = p_values.ptr<T>(i);
+        uchar* dst   = p_pixels + i * p_stride;
+        for (int j = 0; j < p_values.cols; ++j, src += CN, dst += 3)
+        {
+            if constexpr (CN < 3)
+            {
+                // gray levels from the first channel
+                dst[0] = dst[1] = dst[2] = scale(src[0]);
+            }
+            else
+            {
+                // BGR(A) to RGB
+                dst[0] = scale(src[2]);
+                dst[1] = scale(src[1]);
+                dst[2] = scale(src[0]);
+            }
+        }
+    }
+}
 
 CMatrixModel::CMatrixModel()
     : QAbstractTableModel()
     , m_filePath()
     , m_format(CMatrixConverter::Format_Unknown)
     , m_data()
+    , m_mapping()
+    , m_edfFile()
+    , m_frameEdits()
+    , m_frameHistories()
+    , m_isFrameModified(false)
     , m_metadata()
     , m_horizontalHeaderLabels()
     , m_verticalHeaderLabels()
+    , m_cellFormatter(nullptr)
+    , m_cellFormatterType(-1)
+    , m_displayCache(std::make_shared<CDisplayCache>())
+    , m_history(std::make_shared<CHistory>())
+    , m_isHistoryEnabled(true)
+    , m_statistics()
+    , m_statisticsGeneration(0)
+    , m_statisticsTaskGeneration(0)
+    , m_statisticsWatcher()
+    , m_isStatisticsUpdated(false)
 {
+    connectCaches();
 }
 
 CMatrixModel::CMatrixModel(const CMatrixModel& p_other)
@@ -41,10 +159,26 @@ CMatrixModel::CMatrixModel(const CMatrixModel& p_other)
     , m_filePath(p_other.filePath())
     , m_format(p_other.m_format)
     , m_data(p_other.data().clone())
+    , m_mapping()
+    , m_edfFile()
+    , m_frameEdits()
+    , m_frameHistories()
+    , m_isFrameModified(false)
     , m_metadata()
     , m_horizontalHeaderLabels(p_other.m_horizontalHeaderLabels)
     , m_verticalHeaderLabels(p_other.m_verticalHeaderLabels)
+    , m_cellFormatter(nullptr)
+    , m_cellFormatterType(-1)
+    , m_displayCache(std::make_shared<CDisplayCache>())
+    , m_history(std::make_shared<CHistory>())
+    , m_isHistoryEnabled(true)
+    , m_statistics()
+    , m_statisticsGeneration(0)
+    , m_statisticsTaskGeneration(0)
+    , m_statisticsWatcher()
+    , m_isStatisticsUpdated(false)
 {
+    connectCaches();
 }
 
 CMatrixModel::CMatrixModel(const QString& p_filePath)
@@ -52,14 +186,69 @@ CMatrixModel::CMatrixModel(const QString& p_filePath)
     , m_filePath(p_filePath)
     , m_format(CMatrixConverter::Format_Unknown)
     , m_data()
+    , m_mapping()
+    , m_edfFile()
+    , m_frameEdits()
+    , m_frameHistories()
+    , m_isFrameModified(false)
     , m_metadata()
     , m_horizontalHeaderLabels()
     , m_verticalHeaderLabels()
+    , m_cellFormatter(nullptr)
+    , m_cellFormatterType(-1)
+    , m_displayCache(std::make_shared<CDisplayCache>())
+    , m_history(std::make_shared<CHistory>())
+    , m_isHistoryEnabled(true)
+    , m_statistics()
+    , m_statisticsGeneration(0)
+    , m_statisticsTaskGeneration(0)
+    , m_statisticsWatcher()
+    , m_isStatisticsUpdated(false)
 {
-    CMatrixConverter converter(p_filePath);
+    connectCaches();
+    CMatrixConverter converter;
+    converter.setMemoryMapping(true);
+    if (!converter.load(p_filePath))
+    {
+        qWarning() << "Can't load file: " << p_filePath;
+    }
+
+    m_mapping = converter.mapping();
+    m_edfFile = converter.edfFile();
     setData(converter.data());
     setMetadata(converter.metadata());
-    m_format = converter.format();
+    m_format          = converter.format();
+    m_isFrameModified = false;
+}
+
+CMatrixModel::CMatrixModel(const QString& p_filePath, CMatrixConverter& p_converter)
+    : QAbstractTableModel()
+    , m_filePath(p_filePath)
+    , m_format(p_converter.format())
+    , m_data()
+    , m_mapping(p_converter.mapping())
+    , m_edfFile(p_converter.edfFile())
+    , m_frameEdits()
+    , m_frameHistories()
+    , m_isFrameModified(false)
+    , m_metadata()
+    , m_horizontalHeaderLabels()
+    , m_verticalHeaderLabels()
+    , m_cellFormatter(nullptr)
+    , m_cellFormatterType(-1)
+    , m_displayCache(std::make_shared<CDisplayCache>())
+    , m_history(std::make_shared<CHistory>())
+    , m_isHistoryEnabled(true)
+    , m_statistics()
+    , m_statisticsGeneration(0)
+    , m_statisticsTaskGeneration(0)
+    , m_statisticsWatcher()
+    , m_isStatisticsUpdated(false)
+{
+    connectCaches();
+    setData(p_converter.data());
+    setMetadata(p_converter.metadata());
+    m_isFrameModified = false;
 }
 
 CMatrixModel::CMatrixModel(const int p_rows, const int p_cols, const int p_type, const double p_value1, const double p_value2, const double p_value3)
@@ -67,10 +256,26 @@ CMatrixModel::CMatrixModel(const int p_rows, const int p_cols, const int p_type,
     , m_filePath()
     , m_format(CMatrixConverter::Format_Mfe)
     , m_data()
+    , m_mapping()
+    , m_edfFile()
+    , m_frameEdits()
+    , m_frameHistories()
+    , m_isFrameModified(false)
     , m_metadata()
     , m_horizontalHeaderLabels()
     , m_verticalHeaderLabels()
+    , m_cellFormatter(nullptr)
+    , m_cellFormatterType(-1)
+    , m_displayCache(std::make_shared<CDisplayCache>())
+    , m_history(std::make_shared<CHistory>())
+    , m_isHistoryEnabled(true)
+    , m_statistics()
+    , m_statisticsGeneration(0)
+    , m_statisticsTaskGeneration(0)
+    , m_statisticsWatcher()
+    , m_isStatisticsUpdated(false)
 {
+    connectCaches();
     try
     {
         const int nbChannels = p_type / 8 + 1;
@@ -125,12 +330,244 @@ cv::Mat CMatrixModel::data() const
     return m_data;
 }
 
+std::shared_ptr<CMappedFile> CMatrixModel::mapping() const
+{
+    return m_mapping;
+}
+
 void CMatrixModel::setData(const cv::Mat& p_matrix)
 {
+    const cv::Size previousSize = m_data.size();
+    const int previousType      = m_data.type();
+
+    // Replacing an empty matrix (loading) is not an edit
+    if (!m_data.empty())
+    {
+        recordSnapshot();
+    }
+
     m_data = p_matrix;
+    m_rowOrder.clear();
+    updateCellFormatter();
+    emitDataChanged(previousSize, previousType);
+}
+
+void CMatrixModel::emitDataChanged(const cv::Size& p_previousSize, const int p_previousType)
+{
+    // The data no longer point into the storage of structural edits
+    if (!isStorageView())
+    {
+        m_storage.release();
+    }
+
+    releaseUnusedMapping();
+
+    // Values changed in place: report the exact range of cells
+    if (!m_data.empty() && m_data.size() == p_previousSize && m_data.type() == p_previousType)
+    {
+        emit(dataChanged(index(0, 0), index(m_data.rows - 1, m_data.cols - 1)));
+        return;
+    }
+
+    // The dimensions or the type changed
     emit(dataChanged(QModelIndex(), QModelIndex()));
 }
 
+void CMatrixModel::emitHistoryChanged(const cv::Size& p_previousSize, const int p_previousType, const QRect& p_cells)
+{
+    updateCellFormatter();
+
+    if (p_cells.isValid())
+    {
+        emit(dataChanged(index(p_cells.top(), p_cells.left()), index(p_cells.bottom(), p_cells.right())));
+    }
+    else
+    {
+        m_rowOrder.clear();
+        emitDataChanged(p_previousSize, p_previousType);
+        if (m_data.size() != p_previousSize)
+        {
+            emit(layoutChanged());
+        }
+    }
+
+    emit(historyChanged());
+}
+
+void CMatrixModel::recordSnapshot()
+{
+    recordSnapshot(m_data);
+}
+
+void CMatrixModel::recordSnapshot(const cv::Mat& p_data)
+{
+    if (!m_isHistoryEnabled)
+    {
+        return;
+    }
+
+    m_history->setMemoryLimit(historyMemoryLimit());
+    if (!m_history->recordSnapshot(p_data))
+    {
+        emit(message(tr("The matrix is larger than the history memory limit: this edit can't be undone")));
+    }
+    emit(historyChanged());
+}
+
+qint64 CMatrixModel::historyMemoryLimit() const
+{
+    if (s_historyMemoryLimit < 0)
+    {
+        readHistorySettings();
+    }
+
+    // A single budget is shared with the edits and the histories of the other frames
+    qint64 limit = s_historyMemoryLimit;
+    for (const cv::Mat& edits : m_frameEdits)
+    {
+        limit -= static_cast<qint64>(edits.total() * edits.elemSize());
+    }
+    for (const std::shared_ptr<CHistory>& history : m_frameHistories)
+    {
+        limit -= history->memoryUsage();
+    }
+    return qMax<qint64>(0, limit);
+}
+
+void CMatrixModel::trimFrameHistories()
+{
+    // The edits of the other frames are kept: their histories are dropped first to fit in the budget
+    for (const std::shared_ptr<CHistory>& history : m_frameHistories)
+    {
+        if (historyMemoryLimit() >= m_history->memoryUsage())
+        {
+            break;
+        }
+        history->clear();
+    }
+    m_history->setMemoryLimit(historyMemoryLimit());
+}
+
+void CMatrixModel::readHistorySettings()
+{
+    QSettings settings;
+    settings.beginGroup("history");
+    s_historyMemoryLimit = settings.value("memory-limit", 512).toLongLong() * 1024 * 1024;
+    settings.endGroup();
+}
+
+bool CMatrixModel::canUndo() const
+{
+    return m_history->canUndo();
+}
+
+bool CMatrixModel::canRedo() const
+{
+    return m_history->canRedo();
+}
+
+bool CMatrixModel::isHistoryEnabled() const
+{
+    return m_isHistoryEnabled;
+}
+
+void CMatrixModel::setHistoryEnabled(const bool p_enabled)
+{
+    m_isHistoryEnabled = p_enabled;
+}
+
+void CMatrixModel::undo()
+{
+    const cv::Size previousSize = m_data.size();
+    const int previousType      = m_data.type();
+
+    QRect cells;
+    try
+    {
+        if (!m_history->undo(m_data, &cells))
+        {
+            emit(historyChanged());
+            return;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return;
+    }
+
+    emitHistoryChanged(previousSize, previousType, cells);
+}
+
+void CMatrixModel::redo()
+{
+    const cv::Size previousSize = m_data.size();
+    const int previousType      = m_data.type();
+
+    QRect cells;
+    try
+    {
+        if (!m_history->redo(m_data, &cells))
+        {
+            emit(historyChanged());
+            return;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return;
+    }
+
+    emitHistoryChanged(previousSize, previousType, cells);
+}
+
+void CMatrixModel::beginHistoryGroup()
+{
+    try
+    {
+        // the operations are then applied from the current data, without restoring the original ones
+        m_history->setMemoryLimit(historyMemoryLimit());
+        if (!m_history->beginGroup(m_data))
+        {
+            emit(message(tr("The matrix is larger than the history memory limit: the operations can't be undone")));
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+    }
+    emit(historyChanged());
+}
+
+void CMatrixModel::endHistoryGroup()
+{
+    m_history->endGroup();
+    emit(historyChanged());
+}
+
+bool CMatrixModel::restoreHistoryGroup()
+{
+    const cv::Size previousSize = m_data.size();
+    const int previousType      = m_data.type();
+
+    try
+    {
+        if (!m_history->restoreGroup(m_data))
+        {
+            return false;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return false;
+    }
+
+    emitHistoryChanged(previousSize, previousType, QRect());
+    return true;
+}
+
 const CMetadata& CMatrixModel::metadata() const
 {
     return m_metadata;
@@ -141,6 +578,81 @@ void CMatrixModel::setMetadata(const CMetadata& p_md)
     m_metadata = p_md;
 }
 
+int CMatrixModel::frameCount() const
+{
+    return m_edfFile ? m_edfFile->frameCount() : 1;
+}
+
+int CMatrixModel::frame() const
+{
+    return m_edfFile ? m_edfFile->currentFrame() : 0;
+}
+
+void CMatrixModel::setFrame(int p_frame)
+{
+    if (!m_edfFile || p_frame == frame())
+    {
+        return;
+    }
+
+    try
+    {
+        const int previous = frame();
+        if (!m_edfFile->readFrame(p_frame))
+        {
+            return;
+        }
+
+        // Edits of the previous frame and their history are kept until it is shown again
+        if (m_isFrameModified)
+        {
+            m_frameEdits.insert(previous, m_data);
+            m_frameHistories.insert(previous, m_history);
+        }
+
+        // Switching frame is not an edition of the matrix: reset the model instead of emitting dataChanged
+        const bool isFrameModified = m_frameEdits.contains(p_frame);
+        beginResetModel();
+        if (isFrameModified)
+        {
+            m_data    = m_frameEdits.take(p_frame);
+            m_history = m_frameHistories.take(p_frame);
+        }
+        else
+        {
+            m_data    = m_edfFile->data();
+            m_history = std::make_shared<CHistory>(m_history->memoryLimit());
+        }
+        m_mapping.reset();
+        m_storage.release();
+        m_metadata = m_edfFile->metadata();
+        m_rowOrder.clear();
+        endResetModel();
+
+        // the reset marks the frame as modified like structural edits do
+        m_isFrameModified = isFrameModified;
+        trimFrameHistories();
+        emit(historyChanged());
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return;
+    }
+
+    emit(frameChanged(p_frame));
+}
+
+bool CMatrixModel::hasFrameEdits() const
+{
+    return m_isFrameModified || !m_frameEdits.isEmpty();
+}
+
+void CMatrixModel::markFrameModified()
+{
+    m_isFrameModified = true;
+}
+
 int CMatrixModel::rowCount(const QModelIndex& p_parent) const
 {
     Q_UNUSED(p_parent);
@@ -163,88 +675,392 @@ QVariant CMatrixModel::data(const QModelIndex& p_index, int p_role) const
         case Qt::EditRole:
         case Qt::DisplayRole:
         {
+            if (m_cellFormatterType != m_data.type())
+            {
+                updateCellFormatter();
+            }
+
+            if (m_cellFormatter == nullptr)
+            {
+                return QVariant();
+            }
+
             const int r = p_index.row();
             const int c = p_index.column();
 
-            cv::Vec2b point2b;
-            cv::Vec3b point3b;
-            cv::Vec2s point2s;
-            cv::Vec3s point3s;
-            cv::Vec2s point2i;
-            cv::Vec3s point3i;
-            cv::Vec2f point2f;
-            cv::Vec3f point3f;
-            cv::Vec2d point2d;
-            cv::Vec3d point3d;
-
-            switch (type())
+            // Edit the exact value
+            if (p_role == Qt::EditRole)
             {
-                case CV_8UC1:
-                    return m_data.at<uchar>(r, c);
+                return m_cellFormatter(m_data, r, c, -1);
+            }
 
-                case CV_8UC2:
-                    point2b = m_data.at<cv::Vec2b>(r, c);
-                    return QString("%1 | %2").arg(point2b[0]).arg(point2b[1]);
+            QString value;
+            if (m_displayCache->value(r, c, value))
+            {
+                return value;
+            }
 
-                case CV_8UC3:
-                    point3b = m_data.at<cv::Vec3b>(r, c);
-                    return QString("%1 | %2 | %3").arg(point3b[0]).arg(point3b[1]).arg(point3b[2]);
+            // Format the whole tile: the neighbour cells are painted next
+            const QPoint tile             = CDisplayCache::tileAt(r, c);
+            const QRect cells             = CDisplayCache::tileCells(tile) & QRect(0, 0, m_data.cols, m_data.rows);
+            const quint64 generation      = m_displayCache->generation();
+            const QVector<QString> values = formatCells(m_data, m_cellFormatter, cells);
+            m_displayCache->insert(tile, cells.width(), values, generation);
+            return values.at((r - cells.top()) * cells.width() + (c - cells.left()));
+        }
 
-                case CV_16UC1:
-                    return m_data.at<unsigned short>(r, c);
+        default:
+            data(p_index, Qt::DisplayRole);
+    }
 
-                case CV_16UC2:
-                    point2s = m_data.at<cv::Vec2s>(r, c);
-                    return QString("%1 | %2").arg(point2s[0]).arg(point2s[1]);
+    return QVariant();
+}
 
-                case CV_16UC3:
-                    point3s = m_data.at<cv::Vec3s>(r, c);
-                    return QString("%1 | %2 | %3").arg(point3s[0]).arg(point3s[1]).arg(point3s[2]);
+QVector<QString> CMatrixModel::formatCells(const cv::Mat& p_data, const CellFormatter p_formatter, const QRect& p_cells)
+{
+    // Displayed values use the usual 6 significant digits
+    QVector<QString> values;
+    values.reserve(p_cells.width() * p_cells.height());
+    for (int r = p_cells.top(); r <= p_cells.bottom(); ++r)
+    {
+        for (int c = p_cells.left(); c <= p_cells.right(); ++c)
+        {
+            values.append(p_formatter(p_data, r, c, 6));
+        }
+    }
+    return values;
+}
 
-                case CV_32SC1:
-                    return m_data.at<int>(r, c);
+std::shared_ptr<CDisplayCache> CMatrixModel::displayCache() const
+{
+    return m_displayCache;
+}
 
-                case CV_32SC2:
-                    point2i = m_data.at<cv::Vec2i>(r, c);
-                    return QString("%1 | %2").arg(point2i[0]).arg(point2i[1]);
+void CMatrixModel::prefetch(const QRect& p_cells)
+{
+    if (m_cellFormatterType != m_data.type())
+    {
+        updateCellFormatter();
+    }
 
-                case CV_32SC3:
-                    point3i = m_data.at<cv::Vec3i>(r, c);
-                    return QString("%1 | %2 | %3").arg(point3i[0]).arg(point3i[1]).arg(point3i[2]);
+    const QRect cells = p_cells & QRect(0, 0, m_data.cols, m_data.rows);
+    if (cells.isEmpty() || m_cellFormatter == nullptr)
+    {
+        return;
+    }
 
-                case CV_32FC1:
-                    return m_data.at<float>(r, c);
+    // Only format the tiles that are not cached yet
+    QVector<QPoint> tiles;
+    const QPoint first = CDisplayCache::tileAt(cells.top(), cells.left());
+    const QPoint last  = CDisplayCache::tileAt(cells.bottom(), cells.right());
+    for (int y = first.y(); y <= last.y(); ++y)
+    {
+        for (int x = first.x(); x <= last.x(); ++x)
+        {
+            if (!m_displayCache->contains(QPoint(x, y)))
+            {
+                tiles.append(QPoint(x, y));
+            }
+        }
+    }
 
-                case CV_32FC2:
-                    point2f = m_data.at<cv::Vec2f>(r, c);
-                    return QString("%1 | %2").arg(point2f[0]).arg(point2f[1]);
+    if (tiles.isEmpty() || !m_displayCache->acquirePrefetch())
+    {
+        return;
+    }
 
-                case CV_32FC3:
-                    point3f = m_data.at<cv::Vec3f>(r, c);
-                    return QString("%1 | %2 | %3").arg(point3f[0]).arg(point3f[1]).arg(point3f[2]);
+    // The task shares the matrix buffer, its mapping and the cache: all of them outlive the model if needed.
+    // Values formatted while the data are modified are dropped by the next invalidation.
+    const std::shared_ptr<CDisplayCache> cache = m_displayCache;
+    const cv::Mat data                         = m_data;
+    const std::shared_ptr<CMappedFile> mapping = m_mapping;
+    const CellFormatter formatter              = m_cellFormatter;
+    const quint64 generation                   = cache->generation();
+    QThreadPool::globalInstance()->start(
+        [cache, data, mapping, formatter, tiles, generation]()
+        {
+            Q_UNUSED(mapping); // keeps the mapped file alive until the task is over
+            const QRect bounds(0, 0, data.cols, data.rows);
+            for (const QPoint& tile : tiles)
+            {
+                const QRect cells = CDisplayCache::tileCells(tile) & bounds;
+                if (!cache->insert(tile, cells.width(), formatCells(data, formatter, cells), generation))
+                {
+                    break; // invalidated in the meantime
+                }
+            }
+            cache->releasePrefetch();
+        });
+}
 
-                case CV_64FC1:
-                    return m_data.at<double>(r, c);
+void CMatrixModel::connectCaches()
+{
+    connect(this, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)), SLOT(invalidateDisplay(const QModelIndex&, const QModelIndex&)));
+    connect(this, SIGNAL(modelReset()), SLOT(clearDisplay()));
+    connect(this, SIGNAL(layoutChanged()), SLOT(clearDisplay()));
+    connect(this, SIGNAL(rowsInserted(const QModelIndex&, int, int)), SLOT(clearDisplay()));
+    connect(this, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), SLOT(clearDisplay()));
+    connect(this, SIGNAL(columnsInserted(const QModelIndex&, int, int)), SLOT(clearDisplay()));
+    connect(this, SIGNAL(columnsRemoved(const QModelIndex&, int, int)), SLOT(clearDisplay()));
+
+    connect(this, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)), SLOT(updateStatistics(const QModelIndex&, const QModelIndex&)));
+    connect(this, SIGNAL(modelReset()), SLOT(clearStatistics()));
+    connect(this, SIGNAL(layoutChanged()), SLOT(clearStatistics()));
+    connect(this, SIGNAL(rowsInserted(const QModelIndex&, int, int)), SLOT(clearStatistics()));
+    connect(this, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), SLOT(clearStatistics()));
+    connect(this, SIGNAL(columnsInserted(const QModelIndex&, int, int)), SLOT(clearStatistics()));
+    connect(this, SIGNAL(columnsRemoved(const QModelIndex&, int, int)), SLOT(clearStatistics()));
+    connect(&m_statisticsWatcher, SIGNAL(finished()), SLOT(statisticsComputed()));
+
+    connect(this, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)), SLOT(markFrameModified()));
+    connect(this, SIGNAL(modelReset()), SLOT(markFrameModified()));
+    connect(this, SIGNAL(rowsInserted(const QModelIndex&, int, int)), SLOT(markFrameModified()));
+    connect(this, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), SLOT(markFrameModified()));
+    connect(this, SIGNAL(columnsInserted(const QModelIndex&, int, int)), SLOT(markFrameModified()));
+    connect(this, SIGNAL(columnsRemoved(const QModelIndex&, int, int)), SLOT(markFrameModified()));
+}
 
-                case CV_64FC2:
-                    point2d = m_data.at<cv::Vec2d>(r, c);
-                    return QString("%1 | %2").arg(point2d[0]).arg(point2d[1]);
+void CMatrixModel::invalidateDisplay(const QModelIndex& p_topLeft, const QModelIndex& p_bottomRight)
+{
+    // An invalid range means that the whole matrix changed
+    if (!p_topLeft.isValid() || !p_bottomRight.isValid())
+    {
+        clearDisplay();
+        return;
+    }
 
-                case CV_64FC3:
-                    point3d = m_data.at<cv::Vec3d>(r, c);
-                    return QString("%1 | %2 | %3").arg(point3d[0]).arg(point3d[1]).arg(point3d[2]);
+    m_displayCache->invalidate(QRect(QPoint(p_topLeft.column(), p_topLeft.row()), QPoint(p_bottomRight.column(), p_bottomRight.row())));
+}
 
-                default:
-                    return QVariant();
-            }
-            break;
+void CMatrixModel::clearDisplay()
+{
+    m_displayCache->clear();
+}
+
+void CMatrixModel::updateStatistics(const QModelIndex& p_topLeft, const QModelIndex& p_bottomRight)
+{
+    Q_UNUSED(p_topLeft);
+    Q_UNUSED(p_bottomRight);
+
+    // Edits that do not update the statistics invalidate them
+    if (!m_isStatisticsUpdated)
+    {
+        clearStatistics();
+    }
+    m_isStatisticsUpdated = false;
+}
+
+void CMatrixModel::clearStatistics()
+{
+    // statistics being computed in background are dropped when they are over
+    m_statistics = CMatrixStatistics();
+    ++m_statisticsGeneration;
+}
+
+void CMatrixModel::replaceStatistics(const QRect& p_cells, const cv::Mat& p_before)
+{
+    const cv::Mat after   = m_data(cv::Rect(p_cells.x(), p_cells.y(), p_cells.width(), p_cells.height()));
+    const bool isValid    = m_statistics.isValid();
+    m_isStatisticsUpdated = isValid && m_statistics.replace(p_before, after, p_cells.topLeft());
+    if (m_isStatisticsUpdated)
+    {
+        // statistics being computed in background are older than the updated ones
+        ++m_statisticsGeneration;
+    }
+    else if (isValid)
+    {
+        // An extremum has been replaced: the statistics are computed again in background
+        // and statisticsChanged() is emitted once they are over, the edit does not clear them again
+        clearStatistics();
+        startStatistics();
+        m_isStatisticsUpdated = true;
+    }
+}
+
+void CMatrixModel::transformStatistics(const double p_scale, const double p_offset, const int p_channel)
+{
+    // Single precision values are rounded to float while the statistics are transformed in double:
+    // they would drift from the values of the cells
+    if (m_data.depth() == CV_32F)
+    {
+        return;
+    }
+
+    // Integer values are saturated and rounded: the transformation must keep them exact
+    if (m_statistics.isValid() && m_data.depth() < CV_32F)
+    {
+        double typeMin = 0, typeMax = 0;
+        switch (m_data.depth())
+        {
+            case CV_8U:
+                typeMax = std::numeric_limits<uchar>::max();
+                break;
+            case CV_8S:
+                typeMin = std::numeric_limits<schar>::min();
+                typeMax = std::numeric_limits<schar>::max();
+                break;
+            case CV_16U:
+                typeMax = std::numeric_limits<ushort>::max();
+                break;
+            case CV_16S:
+                typeMin = std::numeric_limits<short>::min();
+                typeMax = std::numeric_limits<short>::max();
+                break;
+            default:
+                typeMin = std::numeric_limits<int>::min();
+                typeMax = std::numeric_limits<int>::max();
+                break;
         }
 
-        default:
-            data(p_index, Qt::DisplayRole);
+        const double min = m_statistics.min() * p_scale + p_offset;
+        const double max = m_statistics.max() * p_scale + p_offset;
+        if (p_scale != std::round(p_scale) || p_offset != std::round(p_offset) || qMin(min, max) < typeMin || qMax(min, max) > typeMax)
+        {
+            return;
+        }
     }
 
-    return QVariant();
+    m_isStatisticsUpdated = m_statistics.isValid() && m_statistics.transform(p_scale, p_offset, p_channel);
+    if (m_isStatisticsUpdated)
+    {
+        // statistics being computed in background are older than the transformed ones
+        ++m_statisticsGeneration;
+    }
+}
+
+void CMatrixModel::statisticsComputed()
+{
+    if (m_statisticsTaskGeneration != m_statisticsGeneration)
+    {
+        // the matrix changed in the meantime, unless the statistics are already up to date
+        if (!m_statistics.isValid())
+        {
+            startStatistics();
+        }
+        return;
+    }
+
+    m_statistics = m_statisticsWatcher.result();
+    if (m_statistics.isValid())
+    {
+        emit(statisticsChanged());
+    }
+}
+
+void CMatrixModel::startStatistics() const
+{
+    if (m_statisticsWatcher.isRunning())
+    {
+        return;
+    }
+
+    // The task shares the matrix buffer and its mapping: both outlive the model if needed.
+    const cv::Mat data                         = m_data;
+    const std::shared_ptr<CMappedFile> mapping = m_mapping;
+    m_statisticsTaskGeneration                 = m_statisticsGeneration;
+    m_statisticsWatcher.setFuture(QtConcurrent::run(
+        [data, mapping]()
+        {
+            Q_UNUSED(mapping); // keeps the mapped file alive until the task is over
+            return CMatrixStatistics::compute(data);
+        }));
+}
+
+void CMatrixModel::clearCaches()
+{
+    clearDisplay();
+    clearStatistics();
+    m_isStatisticsUpdated = false;
+}
+
+bool CMatrixModel::hasStatistics() const
+{
+    return m_statistics.isValid();
+}
+
+const CMatrixStatistics& CMatrixModel::statistics() const
+{
+    if (!m_statistics.isValid() && !m_data.empty())
+    {
+        // statistics being computed in background are dropped when they are over
+        m_statistics = CMatrixStatistics::compute(m_data);
+        ++m_statisticsGeneration;
+    }
+    return m_statistics;
+}
+
+bool CMatrixModel::valueRange(double* p_min, double* p_max) const
+{
+    *p_min = 0;
+    *p_max = 0;
+    if (m_data.empty())
+    {
+        return false;
+    }
+
+    if (m_statistics.isValid())
+    {
+        *p_min = m_statistics.min();
+        *p_max = m_statistics.max();
+        return true;
+    }
+
+    // Small matrices are reduced at once, large ones are estimated from one cell every (step x step)
+    const size_t sampleSize = 1 << 20;
+    const int step          = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(m_data.total()) / sampleSize)));
+    if (step <= 1)
+    {
+        *p_min = statistics().min();
+        *p_max = statistics().max();
+        return m_statistics.isValid();
+    }
+
+    startStatistics();
+    try
+    {
+        cv::Mat sample;
+        cv::resize(m_data, sample, cv::Size((m_data.cols + step - 1) / step, (m_data.rows + step - 1) / step), 0, 0, cv::INTER_NEAREST);
+        cv::minMaxLoc(sample.reshape(1), p_min, p_max);
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+    }
+    return false;
+}
+
+CMatrixHistogram CMatrixModel::histogram(const int p_bins) const
+{
+    const CMatrixStatistics& stats = statistics();
+    if (!stats.isValid())
+    {
+        return CMatrixHistogram();
+    }
+
+    if (stats.histogram().isEmpty() || stats.histogramBins() != p_bins)
+    {
+        // The range of the statistics saves a pass over the values
+        m_statistics.setHistogram(CMatrixHistogram::compute(m_data, p_bins, stats.min(), stats.max()), p_bins);
+    }
+    return m_statistics.histogram();
+}
+
+void CMatrixModel::updateCellFormatter() const
+{
+    static const CellFormatter s_cellFormatters[][4] = {
+        {formatCell<uchar, 1>, formatCell<uchar, 2>, formatCell<uchar, 3>, formatCell<uchar, 4>},
+        {formatCell<schar, 1>, formatCell<schar, 2>, formatCell<schar, 3>, formatCell<schar, 4>},
+        {formatCell<ushort, 1>, formatCell<ushort, 2>, formatCell<ushort, 3>, formatCell<ushort, 4>},
+        {formatCell<short, 1>, formatCell<short, 2>, formatCell<short, 3>, formatCell<short, 4>},
+        {formatCell<int, 1>, formatCell<int, 2>, formatCell<int, 3>, formatCell<int, 4>},
+        {formatCell<float, 1>, formatCell<float, 2>, formatCell<float, 3>, formatCell<float, 4>},
+        {formatCell<double, 1>, formatCell<double, 2>, formatCell<double, 3>, formatCell<double, 4>}};
+
+    const int depth = m_data.depth();
+    const int cn    = m_data.channels();
+
+    m_cellFormatterType = m_data.type();
+    m_cellFormatter     = (depth <= CV_64F && cn <= 4) ? s_cellFormatters[depth][cn - 1] : nullptr;
 }
 
 bool CMatrixModel::setData(const QModelIndex& p_index, const QVariant& p_value, int p_role)
@@ -269,6 +1085,15 @@ bool CMatrixModel::setData(const QModelIndex& p_index, const QVariant& p_value,
     const int r = p_index.row();
     const int c = p_index.column();
 
+    // the values recorded by the history are not modified in place
+    if (m_history->isShared(m_data))
+    {
+        m_data = m_data.clone();
+        m_storage.release();
+    }
+
+    const QByteArray before(reinterpret_cast<const char*>(m_data.ptr(r, c)), static_cast<int>(m_data.elemSize()));
+
     switch (type())
     {
         case CV_8UC1:
@@ -337,57 +1162,198 @@ bool CMatrixModel::setData(const QModelIndex& p_index, const QVariant& p_value,
             return false;
     }
 
-    emit(dataChanged(QModelIndex(), QModelIndex()));
-    return true;
-}
+    if (m_isHistoryEnabled)
+    {
+        const QByteArray after(reinterpret_cast<const char*>(m_data.ptr(r, c)), static_cast<int>(m_data.elemSize()));
+        m_history->recordCellEdit(QPoint(c, r), before, after);
+        emit(historyChanged());
+    }
+
+    replaceStatistics(QRect(c, r, 1, 1), cv::Mat(1, 1, m_data.type(), const_cast<char*>(before.constData())));
+    emit(dataChanged(p_index, p_index));
+    return true;
+}
+
+QVariant CMatrixModel::headerData(int p_section, Qt::Orientation p_orientation, int p_role) const
+{
+    if (p_role == Qt::DisplayRole)
+    {
+        if (p_orientation == Qt::Horizontal)
+        {
+            return p_section < m_horizontalHeaderLabels.size() ? m_horizontalHeaderLabels.at(p_section) : QString::number(p_section);
+        }
+
+        if (p_orientation == Qt::Vertical)
+        {
+            return p_section < m_verticalHeaderLabels.size() ? m_verticalHeaderLabels.at(p_section) : QString::number(p_section);
+        }
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags CMatrixModel::flags(const QModelIndex& p_index) const
+{
+    Q_UNUSED(p_index);
+    return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
+}
+
+bool CMatrixModel::removeRows(int p_row, int p_count, const QModelIndex& p_parent)
+{
+    Q_UNUSED(p_parent);
+    return removeRowRanges(QVector<QPair<int, int>>() << qMakePair(p_row, p_count));
+}
+
+bool CMatrixModel::removeColumns(int p_column, int p_count, const QModelIndex& p_parent)
+{
+    Q_UNUSED(p_parent);
+    return removeColumnRanges(QVector<QPair<int, int>>() << qMakePair(p_column, p_count));
+}
+
+bool CMatrixModel::removeRowRanges(const QVector<QPair<int, int>>& p_ranges)
+{
+    const QVector<QPair<int, int>> ranges = normalizeRanges(p_ranges, m_data.rows);
+    if (ranges.isEmpty())
+    {
+        return false;
+    }
+
+    try
+    {
+        // the history keeps the current buffer: the storage is detached from it
+        const cv::Mat before = m_isHistoryEnabled ? m_data : cv::Mat();
+        prepareStorage();
+        recordSnapshot(before);
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return false;
+    }
+
+    // A single range is a regular removal, several ranges reset the views
+    if (ranges.size() == 1)
+    {
+        QAbstractTableModel::beginRemoveRows(QModelIndex(), ranges[0].first, ranges[0].first + ranges[0].second - 1);
+    }
+    else
+    {
+        QAbstractTableModel::beginResetModel();
+    }
+
+    // Move the kept rows up, in a single pass
+    const size_t rowSize = static_cast<size_t>(m_data.cols) * m_data.elemSize();
+    uchar* base          = m_storage.data;
+    int row              = ranges[0].first;
+    for (int i = 0; i < ranges.size(); ++i)
+    {
+        const int keptBegin = ranges[i].first + ranges[i].second;
+        const int keptEnd   = (i + 1 < ranges.size()) ? ranges[i + 1].first : m_data.rows;
+        if (keptEnd > keptBegin)
+        {
+            memmove(base + row * rowSize, base + keptBegin * rowSize, (keptEnd - keptBegin) * rowSize);
+            row += keptEnd - keptBegin;
+        }
+    }
+    setStorageView(row, m_data.cols);
+    m_rowOrder.clear();
+
+    if (ranges.size() == 1)
+    {
+        QAbstractTableModel::endRemoveRows();
+    }
+    else
+    {
+        QAbstractTableModel::endResetModel();
+    }
+
+    return true;
+}
+
+bool CMatrixModel::removeColumnRanges(const QVector<QPair<int, int>>& p_ranges)
+{
+    const QVector<QPair<int, int>> ranges = normalizeRanges(p_ranges, m_data.cols);
+    if (ranges.isEmpty())
+    {
+        return false;
+    }
+
+    try
+    {
+        // the history keeps the current buffer: the storage is detached from it
+        const cv::Mat before = m_isHistoryEnabled ? m_data : cv::Mat();
+        prepareStorage();
+        recordSnapshot(before);
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
+        return false;
+    }
+
+    // A single range is a regular removal, several ranges reset the views
+    if (ranges.size() == 1)
+    {
+        QAbstractTableModel::beginRemoveColumns(QModelIndex(), ranges[0].first, ranges[0].first + ranges[0].second - 1);
+    }
+    else
+    {
+        QAbstractTableModel::beginResetModel();
+    }
 
-QVariant CMatrixModel::headerData(int p_section, Qt::Orientation p_orientation, int p_role) const
-{
-    if (p_role == Qt::DisplayRole)
+    // Segments of kept columns of each row
+    QVector<QPair<int, int>> kept;
+    int cols = 0;
+    for (int i = -1; i < ranges.size(); ++i)
     {
-        if (p_orientation == Qt::Horizontal)
+        const int keptBegin = (i < 0) ? 0 : ranges[i].first + ranges[i].second;
+        const int keptEnd   = (i + 1 < ranges.size()) ? ranges[i + 1].first : m_data.cols;
+        if (keptEnd > keptBegin)
         {
-            return p_section < m_horizontalHeaderLabels.size() ? m_horizontalHeaderLabels.at(p_section) : QString::number(p_section);
+            kept << qMakePair(keptBegin, keptEnd - keptBegin);
+            cols += keptEnd - keptBegin;
         }
+    }
 
-        if (p_orientation == Qt::Vertical)
+    // Compact the rows from top to bottom: values only move to lower addresses
+    const size_t elemSize = m_data.elemSize();
+    uchar* base           = m_storage.data;
+    uchar* dst            = base;
+    for (int r = 0; r < m_data.rows; ++r)
+    {
+        const uchar* row = base + static_cast<size_t>(r) * m_data.cols * elemSize;
+        for (const QPair<int, int>& segment : kept)
         {
-            return p_section < m_verticalHeaderLabels.size() ? m_verticalHeaderLabels.at(p_section) : QString::number(p_section);
+            memmove(dst, row + segment.first * elemSize, segment.second * elemSize);
+            dst += segment.second * elemSize;
         }
     }
-    return QVariant();
-}
+    setStorageView(m_data.rows, cols);
 
-Qt::ItemFlags CMatrixModel::flags(const QModelIndex& p_index) const
-{
-    Q_UNUSED(p_index);
-    return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
+    if (ranges.size() == 1)
+    {
+        QAbstractTableModel::endRemoveColumns();
+    }
+    else
+    {
+        QAbstractTableModel::endResetModel();
+    }
+
+    return true;
 }
 
-bool CMatrixModel::removeRows(int p_row, int p_count, const QModelIndex& p_parent)
+bool CMatrixModel::insertRows(int p_row, int p_count, const QModelIndex& p_parent)
 {
-    QAbstractTableModel::beginRemoveRows(p_parent, p_row, p_row + p_count - 1);
+    if (p_row < 0 || p_row > m_data.rows || p_count <= 0)
+    {
+        return false;
+    }
 
     try
     {
-        // allocate output
-        cv::Mat dst(m_data.rows - p_count, m_data.cols, m_data.type());
-
-        // copy top part of the matrix
-        if (p_row > 0)
-        {
-            cv::Mat top = dst.rowRange(0, p_row);
-            m_data.rowRange(0, p_row).copyTo(top);
-        }
-
-        // copy bottom part of the matrix
-        if (p_row + p_count < m_data.rows)
-        {
-            cv::Mat bottom = dst.rowRange(p_row, dst.rows);
-            m_data.rowRange(p_row + p_count, m_data.rows).copyTo(bottom);
-        }
-
-        m_data = dst;
+        // the history keeps the current buffer: the storage is detached from it
+        const cv::Mat before = m_isHistoryEnabled ? m_data : cv::Mat();
+        reserveStorage(static_cast<size_t>(m_data.rows + p_count) * m_data.cols);
+        recordSnapshot(before);
     }
     catch (cv::Exception& e)
     {
@@ -395,35 +1361,37 @@ bool CMatrixModel::removeRows(int p_row, int p_count, const QModelIndex& p_paren
         return false;
     }
 
-    QAbstractTableModel::endRemoveRows();
+    QAbstractTableModel::beginInsertRows(p_parent, p_row, p_row + p_count - 1);
+
+    // Move the bottom part of the matrix down and clear the new rows
+    const size_t rowSize = static_cast<size_t>(m_data.cols) * m_data.elemSize();
+    uchar* base          = m_storage.data;
+    if (rowSize > 0)
+    {
+        memmove(base + (p_row + p_count) * rowSize, base + p_row * rowSize, (m_data.rows - p_row) * rowSize);
+        memset(base + p_row * rowSize, 0, p_count * rowSize);
+    }
+    setStorageView(m_data.rows + p_count, m_data.cols);
+    m_rowOrder.clear();
+
+    QAbstractTableModel::endInsertRows();
 
     return true;
 }
 
-bool CMatrixModel::removeColumns(int p_column, int p_count, const QModelIndex& p_parent)
+bool CMatrixModel::insertColumns(int p_column, int p_count, const QModelIndex& p_parent)
 {
-    QAbstractTableModel::beginRemoveColumns(p_parent, p_column, p_column + p_count - 1);
+    if (p_column < 0 || p_column > m_data.cols || p_count <= 0)
+    {
+        return false;
+    }
 
     try
     {
-        // allocate output
-        cv::Mat dst(m_data.rows, m_data.cols - p_count, m_data.type());
-
-        // copy left part of the matrix
-        if (p_column > 0)
-        {
-            cv::Mat left = dst.colRange(0, p_column);
-            m_data.colRange(0, p_column).copyTo(left);
-        }
-
-        // copy right part of the matrix
-        if (p_column + p_count < m_data.cols)
-        {
-            cv::Mat right = dst.colRange(p_column, dst.cols);
-            m_data.colRange(p_column + p_count, m_data.cols).copyTo(right);
-        }
-
-        m_data = dst;
+        // the history keeps the current buffer: the storage is detached from it
+        const cv::Mat before = m_isHistoryEnabled ? m_data : cv::Mat();
+        reserveStorage(static_cast<size_t>(m_data.cols + p_count) * m_data.rows);
+        recordSnapshot(before);
     }
     catch (cv::Exception& e)
     {
@@ -431,71 +1399,183 @@ bool CMatrixModel::removeColumns(int p_column, int p_count, const QModelIndex& p
         return false;
     }
 
-    QAbstractTableModel::endRemoveColumns();
+    QAbstractTableModel::beginInsertColumns(p_parent, p_column, p_column + p_count - 1);
+
+    // Expand the rows from bottom to top: values only move to higher addresses
+    const size_t elemSize = m_data.elemSize();
+    const int cols        = m_data.cols + p_count;
+    uchar* base           = m_storage.data;
+    for (int r = m_data.rows - 1; r >= 0; --r)
+    {
+        const uchar* src = base + static_cast<size_t>(r) * m_data.cols * elemSize;
+        uchar* dst       = base + static_cast<size_t>(r) * cols * elemSize;
+
+        // right part first: the left part may overlap its source
+        memmove(dst + (p_column + p_count) * elemSize, src + p_column * elemSize, (m_data.cols - p_column) * elemSize);
+        memmove(dst, src, p_column * elemSize);
+        memset(dst + p_column * elemSize, 0, p_count * elemSize);
+    }
+    setStorageView(m_data.rows, cols);
+
+    QAbstractTableModel::endInsertColumns();
 
     return true;
 }
 
-bool CMatrixModel::insertRows(int p_row, int p_count, const QModelIndex& p_parent)
+QVector<QPair<int, int>> CMatrixModel::normalizeRanges(const QVector<QPair<int, int>>& p_ranges, const int p_size)
 {
-    QAbstractTableModel::beginInsertRows(p_parent, p_row, p_row + p_count - 1);
-
-    try
+    QVector<QPair<int, int>> ranges;
+    for (const QPair<int, int>& range : p_ranges)
     {
-        // allocate output
-        cv::Mat dst = cv::Mat::zeros(m_data.rows + p_count, m_data.cols, m_data.type());
-
-        // copy top part of the matrix
-        if (p_row > 0)
+        if (range.first < 0 || range.second <= 0 || range.first + range.second > p_size)
         {
-            cv::Mat top = dst.rowRange(0, p_row);
-            m_data.rowRange(0, p_row).copyTo(top);
+            return QVector<QPair<int, int>>();
         }
+        ranges << range;
+    }
 
-        // copy bottom part of the matrix
-        if (p_row < m_data.rows)
+    // Sort and merge overlapping or adjacent ranges
+    std::sort(ranges.begin(), ranges.end());
+
+    QVector<QPair<int, int>> merged;
+    for (const QPair<int, int>& range : ranges)
+    {
+        if (!merged.isEmpty() && range.first <= merged.last().first + merged.last().second)
+        {
+            const int end        = std::max(merged.last().first + merged.last().second, range.first + range.second);
+            merged.last().second = end - merged.last().first;
+        }
+        else
         {
-            cv::Mat bottom = dst.rowRange(p_row + p_count, dst.rows);
-            m_data.rowRange(p_row, m_data.rows).copyTo(bottom);
+            merged << range;
         }
+    }
+    return merged;
+}
 
-        m_data = dst;
+bool CMatrixModel::isStorageView() const
+{
+    return !m_storage.empty() && m_storage.data == m_data.data && m_storage.type() == m_data.type() && m_data.isContinuous()
+           && m_data.total() <= m_storage.total();
+}
+
+bool CMatrixModel::isStorageShared() const
+{
+    // Background tasks (prefetch, statistics, image tiles) read their own reference on the buffer,
+    // external buffers (mapped files) are shared with them through the mapping
+    const int references = isStorageView() ? 2 : 1;
+    return m_data.u == nullptr || CV_XADD(&m_data.u->refcount, 0) > references;
+}
+
+void CMatrixModel::prepareStorage()
+{
+    if (m_data.empty())
+    {
+        return;
     }
-    catch (cv::Exception& e)
+
+    const bool isShared = isStorageShared();
+    if (isStorageView() && !isShared)
     {
-        qWarning() << e;
-        return false;
+        return;
     }
 
-    QAbstractTableModel::endInsertRows();
+    // The values are edited in place from now on: a buffer still read elsewhere is detached first
+    const cv::Mat continuous = (m_data.isContinuous() && !isShared) ? m_data : m_data.clone();
+    m_storage                = continuous.reshape(0, 1);
+    m_data                   = continuous;
+}
 
-    return true;
+void CMatrixModel::reserveStorage(const size_t p_total)
+{
+    if (isStorageView() && !isStorageShared() && p_total <= m_storage.total())
+    {
+        return;
+    }
+
+    // Grow geometrically to amortize successive insertions,
+    // a shared buffer is detached straight into the new storage
+    const size_t total    = m_data.total();
+    const size_t capacity = std::max(p_total, total + total / 2);
+
+    cv::Mat storage(1, static_cast<int>(capacity), m_data.type());
+    if (total > 0)
+    {
+        cv::Mat values = storage.colRange(0, static_cast<int>(total)).reshape(0, m_data.rows);
+        m_data.copyTo(values);
+    }
+
+    const int rows = m_data.rows;
+    const int cols = m_data.cols;
+    m_storage      = storage;
+    setStorageView(rows, cols);
 }
 
-bool CMatrixModel::insertColumns(int p_column, int p_count, const QModelIndex& p_parent)
+void CMatrixModel::releaseUnusedMapping()
 {
-    QAbstractTableModel::beginInsertColumns(p_parent, p_column, p_column + p_count - 1);
+    // the file stays mapped as long as the data point into it
+    if (m_mapping && !m_mapping->contains(m_data.data))
+    {
+        m_mapping.reset();
+    }
+}
 
-    try
+void CMatrixModel::setStorageView(const int p_rows, const int p_cols)
+{
+    const int type  = m_data.type();
+    const int total = p_rows * p_cols;
+    if (total == 0 || m_storage.empty())
+    {
+        m_data = cv::Mat(p_rows, p_cols, type);
+    }
+    else
+    {
+        m_data = m_storage.colRange(0, total).reshape(0, p_rows);
+    }
+
+    releaseUnusedMapping();
+}
+
+void CMatrixModel::sort(int p_column, Qt::SortOrder p_order)
+{
+    // A negative column restores the original order, as in QSortFilterProxyModel
+    if (p_column < 0)
     {
-        // allocate output
-        cv::Mat dst = cv::Mat::zeros(m_data.rows, m_data.cols + p_count, m_data.type());
+        restoreOrder();
+        return;
+    }
+
+    // Multiple channels are sorted by their first channel
+    sortRows(QVector<CMatrixSorter::SortKey>() << CMatrixSorter::SortKey{p_column, 0, p_order});
+}
 
-        // copy left part of the matrix
-        if (p_column > 0)
+bool CMatrixModel::sortRows(const QVector<CMatrixSorter::SortKey>& p_keys)
+{
+    try
+    {
+        std::vector<int> order;
+        if (!CMatrixSorter::sortIndex(m_data, p_keys, order))
         {
-            cv::Mat left = dst.colRange(0, p_column);
-            m_data.colRange(0, p_column).copyTo(left);
+            qWarning() << tr("Can't sort matrix of type %1 by the given keys").arg(typeString(true));
+            return false;
         }
 
-        // copy right part of the matrix
-        if (p_column < m_data.cols)
+        const cv::Mat sorted = CMatrixSorter::gatherRows(m_data, order);
+        recordSnapshot();
+
+        // Compose with the previous sorts to keep the original index of each row
+        if (m_rowOrder.size() == order.size())
         {
-            cv::Mat right = dst.colRange(p_column + p_count, dst.cols);
-            m_data.colRange(p_column, m_data.cols).copyTo(right);
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                order[i] = m_rowOrder[order[i]];
+            }
         }
+        m_rowOrder.swap(order);
 
-        m_data = dst;
+        m_data = sorted;
+        m_mapping.reset();
+        emitDataChanged(m_data.size(), m_data.type());
     }
     catch (cv::Exception& e)
     {
@@ -503,32 +1583,34 @@ bool CMatrixModel::insertColumns(int p_column, int p_count, const QModelIndex& p
         return false;
     }
 
-    QAbstractTableModel::endInsertColumns();
-
     return true;
 }
 
-void CMatrixModel::sort(int p_column, Qt::SortOrder p_order)
+bool CMatrixModel::canRestoreOrder() const
+{
+    return !m_rowOrder.empty() && static_cast<int>(m_rowOrder.size()) == m_data.rows;
+}
+
+void CMatrixModel::restoreOrder()
 {
-    if (channels() != 1)
+    if (!canRestoreOrder())
     {
-        qWarning() << tr("Sorting matrix with multiple channels is not implemented yet");
         return;
     }
 
-    const int cvOrder = (p_order == Qt::AscendingOrder) ? cv::SORT_ASCENDING : cv::SORT_DESCENDING;
-
-    cv::Mat sortedData(m_data.size(), m_data.type());
-    cv::Mat sortedColumnIndex;
-    cv::sortIdx(m_data.col(p_column), sortedColumnIndex, cv::SORT_EVERY_COLUMN | cvOrder);
-    for (int i = 0; i < sortedColumnIndex.rows; ++i)
+    try
     {
-        cv::Mat tmp = sortedData.row(i);
-        m_data.row(sortedColumnIndex.at<int>(i, 0)).copyTo(tmp);
+        const cv::Mat unsorted = CMatrixSorter::scatterRows(m_data, m_rowOrder);
+        recordSnapshot();
+        m_data = unsorted;
+        m_rowOrder.clear();
+        m_mapping.reset();
+        emitDataChanged(m_data.size(), m_data.type());
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << e;
     }
-    sortedData.assignTo(m_data);
-
-    emit(dataChanged(QModelIndex(), QModelIndex()));
 }
 
 int CMatrixModel::channels() const
@@ -679,41 +1761,42 @@ int CMatrixModel::countNonZeros() const
 
 void CMatrixModel::minMaxLoc(double* p_minVal, double* p_maxVal, QPoint* p_minLoc, QPoint* p_maxLoc)
 {
-    try
+    // First channel, read from the statistics
+    const CMatrixStatistics& stats = statistics();
+    if (!stats.isValid())
     {
-        cv::Point minLoc, maxLoc;
-        cv::minMaxLoc(m_data, p_minVal, p_maxVal, &minLoc, &maxLoc);
-        if (p_minLoc != nullptr)
-        {
-            p_minLoc->setX(minLoc.x);
-            p_minLoc->setY(minLoc.y);
-        }
+        return;
+    }
 
-        if (p_maxLoc != nullptr)
-        {
-            p_maxLoc->setX(maxLoc.x);
-            p_maxLoc->setY(maxLoc.y);
-        }
+    const CMatrixStatistics::ChannelStatistics& channel = stats.channel(0);
+    *p_minVal                                           = channel.min;
+    if (p_maxVal != nullptr)
+    {
+        *p_maxVal = channel.max;
     }
-    catch (cv::Exception& e)
+
+    if (p_minLoc != nullptr)
     {
-        qWarning() << e;
+        *p_minLoc = channel.minCell;
+    }
+
+    if (p_maxLoc != nullptr)
+    {
+        *p_maxLoc = channel.maxCell;
     }
 }
 
 void CMatrixModel::meanStdDev(double* p_mean, double* p_stddev)
 {
-    try
+    // First channel, read from the statistics
+    const CMatrixStatistics& stats = statistics();
+    if (!stats.isValid())
     {
-        cv::Scalar mean, stddev;
-        cv::meanStdDev(m_data, mean, stddev);
-        *p_mean   = mean[0];
-        *p_stddev = stddev[0];
-    }
-    catch (cv::Exception& e)
-    {
-        qWarning() << e;
+        return;
     }
+
+    *p_mean   = stats.channel(0).mean();
+    *p_stddev = stats.channel(0).standardDeviation();
 }
 
 void CMatrixModel::convertTo(const int p_type, const double p_alpha, const double p_beta)
@@ -722,8 +1805,14 @@ void CMatrixModel::convertTo(const int p_type, const double p_alpha, const doubl
     {
         try
         {
-            m_data.convertTo(m_data, p_type, p_alpha, p_beta);
-            emit(dataChanged(QModelIndex(), QModelIndex()));
+            const cv::Size previousSize = m_data.size();
+            const int previousType      = m_data.type();
+
+            cv::Mat result;
+            m_data.convertTo(result, p_type, p_alpha, p_beta);
+            recordSnapshot();
+            m_data = result;
+            emitDataChanged(previousSize, previousType);
         }
         catch (cv::Exception& e)
         {
@@ -738,7 +1827,10 @@ void CMatrixModel::add(const double p_value)
     {
         try
         {
-            setData(m_data + p_value);
+            // the scalar is only added to the first channel
+            const cv::Mat result = m_data + p_value;
+            transformStatistics(1, p_value, 0);
+            setData(result);
         }
         catch (cv::Exception& e)
         {
@@ -753,7 +1845,9 @@ void CMatrixModel::multiply(const double p_value)
     {
         try
         {
-            setData(m_data * p_value);
+            const cv::Mat result = m_data * p_value;
+            transformStatistics(p_value, 0, -1);
+            setData(result);
         }
         catch (cv::Exception& e)
         {
@@ -766,7 +1860,10 @@ void CMatrixModel::transpose()
 {
     try
     {
-        m_data = m_data.t();
+        const cv::Mat result = m_data.t();
+        recordSnapshot();
+        m_data = result;
+        m_rowOrder.clear();
         emit(dataChanged(QModelIndex(), QModelIndex()));
         emit(layoutChanged());
     }
@@ -780,8 +1877,15 @@ void CMatrixModel::mulTranspose()
 {
     try
     {
-        cv::mulTransposed(m_data, m_data, false);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::mulTransposed(m_data, result, false);
+        recordSnapshot();
+        m_data = result;
+        m_rowOrder.clear();
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -793,8 +1897,15 @@ void CMatrixModel::verticalFlip()
 {
     try
     {
-        cv::flip(m_data, m_data, 0);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::flip(m_data, result, 0);
+        recordSnapshot();
+        m_data = result;
+        std::reverse(m_rowOrder.begin(), m_rowOrder.end());
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -806,8 +1917,14 @@ void CMatrixModel::horizontalFlip()
 {
     try
     {
-        cv::flip(m_data, m_data, 1);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::flip(m_data, result, 1);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -819,14 +1936,19 @@ void CMatrixModel::rotate(const QPointF& p_center, const double p_angleDg, const
 {
     try
     {
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
         const cv::Point2f rotationCenter(p_center.x(), p_center.y());
         cv::Mat rotation = getRotationMatrix2D(rotationCenter, p_angleDg, p_scaleFactor);
 
         cv::Mat dst;
         cv::warpAffine(m_data, dst, rotation, m_data.size());
+        recordSnapshot();
         m_data = dst;
+        m_rowOrder.clear();
 
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -838,8 +1960,14 @@ void CMatrixModel::normalize(const double p_alpha, const double p_beta, const in
 {
     try
     {
-        cv::normalize(m_data, m_data, p_alpha, p_beta, p_norm);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::normalize(m_data, result, p_alpha, p_beta, p_norm);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -851,8 +1979,14 @@ void CMatrixModel::absdiff(const cv::Mat& p_other)
 {
     try
     {
-        cv::absdiff(m_data, p_other, m_data);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::absdiff(m_data, p_other, result);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -864,8 +1998,13 @@ void CMatrixModel::multiplyElements(const cv::Mat& p_other)
 {
     try
     {
-        m_data = m_data.mul(p_other);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        const cv::Mat result = m_data.mul(p_other);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -877,8 +2016,14 @@ void CMatrixModel::multiplyMatrix(const cv::Mat& p_other)
 {
     try
     {
-        m_data = m_data * p_other;
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        const cv::Mat result = m_data * p_other;
+        recordSnapshot();
+        m_data = result;
+        m_rowOrder.clear();
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -890,8 +2035,14 @@ void CMatrixModel::applyColorMap(const int p_colorMap)
 {
     try
     {
-        cv::applyColorMap(m_data, m_data, p_colorMap);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::applyColorMap(m_data, result, p_colorMap);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -903,8 +2054,14 @@ void CMatrixModel::threshold(const double p_threshold, const double p_maxValue,
 {
     try
     {
-        cv::threshold(m_data, m_data, p_threshold, p_maxValue, p_type);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::threshold(m_data, result, p_threshold, p_maxValue, p_type);
+        recordSnapshot();
+        m_data = result;
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -922,8 +2079,15 @@ void CMatrixModel::merge(const QStringList& p_channels)
 
     try
     {
-        cv::merge(layers, m_data);
-        emit(dataChanged(QModelIndex(), QModelIndex()));
+        const cv::Size previousSize = m_data.size();
+        const int previousType      = m_data.type();
+
+        cv::Mat result;
+        cv::merge(layers, result);
+        recordSnapshot();
+        m_data = result;
+        m_rowOrder.clear();
+        emitDataChanged(previousSize, previousType);
     }
     catch (cv::Exception& e)
     {
@@ -932,50 +2096,105 @@ void CMatrixModel::merge(const QStringList& p_channels)
 }
 
 QImage* CMatrixModel::toQImage() const
+{
+    QImage* image = new QImage;
+    toQImage(*image);
+    return image;
+}
+
+void CMatrixModel::toQImage(QImage& p_image) const
 {
     if (m_data.empty())
     {
-        return new QImage;
+        p_image = QImage();
+        return;
+    }
+
+    double min = 0, max = 0;
+    if (imageRange(&min, &max) && !m_statistics.isValid())
+    {
+        // the image is not a preview: stretch it with the exact range
+        min = statistics().min();
+        max = statistics().max();
     }
 
+    // Reuse the buffer of the image if it has the right dimensions
+    if (p_image.format() != QImage::Format_RGB888 || p_image.width() != m_data.cols || p_image.height() != m_data.rows)
+    {
+        p_image = QImage(m_data.cols, m_data.rows, QImage::Format_RGB888);
+    }
+
+    if (!renderImage(p_image, QRect(0, 0, m_data.cols, m_data.rows), min, max))
+    {
+        p_image = QImage();
+    }
+}
+
+bool CMatrixModel::imageRange(double* p_min, double* p_max) const
+{
     QSettings settings;
     settings.beginGroup("image");
     bool stretch = settings.value("stretch-dynamic", true).toBool();
     settings.endGroup();
 
-    cv::Mat imgData;
-    if (stretch)
+    *p_min = 0;
+    *p_max = 255;
+    if (stretch && !m_data.empty())
     {
-        double min = 0, max = 0;
-        cv::minMaxLoc(m_data, &min, &max);
-        cv::Mat tmp = m_data - min;
-        imgData     = tmp * 255 / (max - min);
+        // min and max over all channels, possibly estimated until the exact range is known
+        valueRange(p_min, p_max);
     }
-    else
+    return stretch;
+}
+
+bool CMatrixModel::renderImage(QImage& p_image, const QRect& p_cells, const double p_min, const double p_max) const
+{
+    const QRect cells = p_cells & QRect(0, 0, m_data.cols, m_data.rows);
+    if (cells.isEmpty() || p_image.width() != m_data.cols || p_image.height() != m_data.rows)
     {
-        imgData = m_data.clone();
+        return false;
     }
 
-    // Convert matrix data to RGB
-    try
+    return renderImage(m_data(cv::Rect(cells.x(), cells.y(), cells.width(), cells.height())), p_image, cells.topLeft(), p_min, p_max);
+}
+
+bool CMatrixModel::renderImage(const cv::Mat& p_values, QImage& p_image, const QPoint& p_position, const double p_min, const double p_max)
+{
+    static const PixelRenderer s_pixelRenderers[][4] = {
+        {renderPixels<uchar, 1>, renderPixels<uchar, 2>, renderPixels<uchar, 3>, renderPixels<uchar, 4>},
+        {renderPixels<schar, 1>, renderPixels<schar, 2>, renderPixels<schar, 3>, renderPixels<schar, 4>},
+        {renderPixels<ushort, 1>, renderPixels<ushort, 2>, renderPixels<ushort, 3>, renderPixels<ushort, 4>},
+        {renderPixels<short, 1>, renderPixels<short, 2>, renderPixels<short, 3>, renderPixels<short, 4>},
+        {renderPixels<int, 1>, renderPixels<int, 2>, renderPixels<int, 3>, renderPixels<int, 4>},
+        {renderPixels<float, 1>, renderPixels<float, 2>, renderPixels<float, 3>, renderPixels<float, 4>},
+        {renderPixels<double, 1>, renderPixels<double, 2>, renderPixels<double, 3>, renderPixels<double, 4>}};
+
+    if (p_values.empty() || p_image.format() != QImage::Format_RGB888 || !p_image.rect().contains(QRect(p_position, QSize(p_values.cols, p_values.rows))))
     {
-        imgData.convertTo(imgData, CV_8U);
-        cv::cvtColor(imgData, imgData, channels() < 3 ? cv::COLOR_GRAY2RGB : cv::COLOR_BGR2RGB);
+        return false;
     }
-    catch (cv::Exception& e)
+
+    const int depth = p_values.depth();
+    const int cn    = p_values.channels();
+    if (depth > CV_64F || cn > 4)
     {
         qWarning() << tr("Can't convert color space");
-        qWarning() << e;
-        return new QImage;
+        qWarning() << "-- error: unsupported type" << p_values.type();
+        return false;
     }
 
-    QImage* image = new QImage(imgData.cols, imgData.rows, QImage::Format_RGB888);
-    for (int i = 0; i < imgData.rows; ++i)
-    {
-        memcpy(image->scanLine(i), imgData.ptr(i), image->bytesPerLine());
-    }
+    // Values in [min, max] are mapped to [0, 255] in a single pass that writes the scanlines directly.
+    // The pixels are accessed from the first scanline: scanLine() may detach the image, which is not thread-safe.
+    const double alpha         = (p_max > p_min) ? 255. / (p_max - p_min) : 0;
+    const double beta          = -p_min * alpha;
+    const PixelRenderer render = s_pixelRenderers[depth][cn - 1];
+    const qsizetype stride     = p_image.bytesPerLine();
+    uchar* pixels              = p_image.scanLine(p_position.y()) + p_position.x() * 3;
+    const double stripes       = static_cast<double>(p_values.total()) / (1 << 16);
+    cv::parallel_for_(
+        cv::Range(0, p_values.rows), [&](const cv::Range& p_rows) { render(p_values, pixels, stride, p_rows, alpha, beta); }, qMax(1., stripes));
 
-    return image;
+    return true;
 }
 
 QString CMatrixModel::valueDescription() const
@@ -996,43 +2215,7 @@ CMatrixModel* CMatrixModel::clone() const
 
 bool CMatrixModel::compare(CMatrixModel* p_model, CMatrixModel* p_other)
 {
-    cv::Mat m1 = p_model->data();
-    cv::Mat m2 = p_other->data();
-
-    if (m1.empty() && m2.empty())
-    {
-        return true;
-    }
-
-    if (m1.channels() != m2.channels() || m1.type() != m2.type() || m1.rows != m2.rows || m1.cols != m2.cols)
-    {
-        return false;
-    }
-
-    m1.convertTo(m1, CV_64F);
-    m2.convertTo(m2, CV_64F);
-
-    std::vector<cv::Mat> channels1, channels2;
-    cv::split(m1, channels1);
-    cv::split(m2, channels2);
-
-    for (int channel = 0; channel < m1.channels(); ++channel)
-    {
-        for (int r = 0; r < m1.rows; ++r)
-        {
-            for (int c = 0; c < m1.cols; ++c)
-            {
-                const double v1 = channels1[channel].at<double>(r, c);
-                const double v2 = channels2[channel].at<double>(r, c);
-                if (v1 != v2)
-                {
-                    return false;
-                }
-            }
-        }
-    }
-
-    return true;
+    return CMatrixComparator::equal(p_model->data(), p_other->data());
 }
 
 QPointF CMatrixModel::center() const
@@ -19,19 +19,48 @@
 #pragma once
 
 #include "matrix-converter.hh"
+#include "matrix-histogram.hh"
+#include "matrix-sorter.hh"
+#include "matrix-statistics.hh"
 #include "metadata.hh"
 
 #include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPair>
+#include <QRect>
 #include <QStringList>
+#include <QVector>
+#include <memory>
 #include <opencv2/opencv.hpp>
 
 /*!
   \file matrix-model.hh
   \class CMatrixModel
   \brief CMatrixModel is a model that represent matrix data
+
+  When loaded from a file that supports it, the matrix data point into
+  a private memory mapping of the file that is kept alive by the model.
+
+  Rows and columns are inserted and removed in place: the matrix then views
+  a flat buffer with spare capacity so that successive edits do not reallocate.
+
+  Multi-frame files (EDF stacks) expose their frames through frameCount()
+  and setFrame(): only the current frame is decoded.
+
+  The dataChanged() signal covers the exact range of modified cells.
+  An invalid range means that the dimensions or the type of the matrix changed.
+
+  Edits of the matrix are recorded in a CHistory so that they can be undone
+  and redone. Cell edits are recorded as deltas, other operations as snapshots
+  of the matrix that share their unchanged blocks.
 */
 
 class QImage;
+class CDisplayCache;
+class CEdfFile;
+class CHistory;
+class CMappedFile;
 
 class CMatrixModel : public QAbstractTableModel
 {
@@ -47,6 +76,9 @@ public:
     /// Loader constructor.
     CMatrixModel(const QString &p_filePath);
 
+    /// Constructor from the matrix already loaded by \a p_converter from \a p_filePath.
+    CMatrixModel(const QString &p_filePath, CMatrixConverter &p_converter);
+
     /// OpenCV wrapper constructor.
     CMatrixModel(const int p_rows, const int p_cols, const int p_type, const double p_value1, const double p_value2, const double p_value3);
 
@@ -63,9 +95,24 @@ public:
     cv::Mat data() const;
     void setData(const cv::Mat &p_matrix);
 
+    /*!
+    Returns the mapped file the data point into, if any.
+    Threads that keep reading data() must hold it until they are over.
+  */
+    std::shared_ptr<CMappedFile> mapping() const;
+
     const CMetadata &metadata() const;
     void setMetadata(const CMetadata &p_md);
 
+    int frameCount() const;
+    int frame() const;
+
+    /*!
+    Returns \a true if a frame of a multi-frame file has been edited.
+    Edits are kept for each frame when switching frames.
+  */
+    bool hasFrameEdits() const;
+
     int rowCount(const QModelIndex &p_parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &p_parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &p_index, int p_role = Qt::DisplayRole) const override;
@@ -81,14 +128,116 @@ public:
     bool insertRows(int p_row, int p_count, const QModelIndex &p_parent = QModelIndex()) override;
     bool insertColumns(int p_column, int p_count, const QModelIndex &p_parent = QModelIndex()) override;
 
+    /*!
+    Removes the rows of the ranges \a p_ranges, given as (first row, count) pairs, in a single pass.
+    The values are moved in place: the matrix is not reallocated.
+    Returns \a false if a range is out of the matrix.
+  */
+    bool removeRowRanges(const QVector<QPair<int, int>> &p_ranges);
+
+    /*!
+    Removes the columns of the ranges \a p_ranges, given as (first column, count) pairs, in a single pass.
+    The values are moved in place: the matrix is not reallocated.
+    Returns \a false if a range is out of the matrix.
+  */
+    bool removeColumnRanges(const QVector<QPair<int, int>> &p_ranges);
+
+    /*!
+    Sorts the rows of the matrix by \a p_keys, the first key being the most significant one.
+    The sort is stable: sorting successively by several columns orders the rows by the last one first.
+    Returns \a false if a key is out of the matrix.
+    \sa restoreOrder
+  */
+    bool sortRows(const QVector<CMatrixSorter::SortKey> &p_keys);
+
+    /*!
+    Returns \a true if the rows have been sorted and their original order can be restored.
+  */
+    bool canRestoreOrder() const;
+
     void setProfile(const QString &p_profile);
 
     QImage *toQImage() const;
 
+    /*!
+    Renders the matrix in \a p_image, whose buffer is reused if it has the dimensions of the matrix.
+    \sa renderImage
+  */
+    void toQImage(QImage &p_image) const;
+
+    /*!
+    Sets the range of values that are mapped to [0, 255] when the matrix is displayed as an image:
+    the minimum and maximum values if the dynamic is stretched (see the preferences), [0, 255] otherwise.
+    Returns \a true if the dynamic is stretched.
+    \sa valueRange
+  */
+    bool imageRange(double *p_min, double *p_max) const;
+
+    /*!
+    Sets the minimum and maximum values of the matrix over all channels, read from the statistics.
+    If the statistics are not known yet, the range of a subsample of the matrix is returned,
+    the statistics are computed in background and statisticsChanged() is emitted.
+    Returns \a true if the range is exact.
+  */
+    bool valueRange(double *p_min, double *p_max) const;
+
+    /*!
+    Returns the statistics of the channels of the matrix, computed first if they are not known.
+    The statistics are cached: cell edits and scalar operations update them
+    without scanning the matrix, other operations invalidate them.
+    \sa CMatrixStatistics
+  */
+    const CMatrixStatistics &statistics() const;
+
+    /*!
+    Returns \a true if the statistics are known, without computing them.
+    \sa statistics
+  */
+    bool hasStatistics() const;
+
+    /*!
+    Returns the histograms of the channels of the matrix, computed from the values in their native type.
+    \a p_bins is the number of bins, 0 to adapt it to the type and the range of the values.
+    The histogram is cached with the statistics.
+    \sa CMatrixHistogram
+  */
+    CMatrixHistogram histogram(const int p_bins = 0) const;
+
+    /*!
+    Drops the cached display values, statistics and histogram so that they are computed again from the matrix.
+    Useful when the matrix has been replaced while the signals of the model were blocked.
+  */
+    void clearCaches();
+
+    /*!
+    Writes the cells \a p_cells of the matrix as RGB pixels at the same position in \a p_image,
+    mapping the values of [\a p_min, \a p_max] to [0, 255].
+    \a p_image must be a QImage::Format_RGB888 image with the dimensions of the matrix.
+    \sa toQImage, imageRange
+  */
+    bool renderImage(QImage &p_image, const QRect &p_cells, const double p_min, const double p_max) const;
+
+    /*!
+    Writes the values \a p_values as RGB pixels in \a p_image, starting at \a p_position,
+    mapping the values of [\a p_min, \a p_max] to [0, 255].
+    \a p_image must be a QImage::Format_RGB888 image that contains the written pixels.
+  */
+    static bool renderImage(const cv::Mat &p_values, QImage &p_image, const QPoint &p_position, const double p_min, const double p_max);
+
     QString valueDescription() const;
 
+    /*!
+    Returns \a true if the matrices of \a p_model and \a p_other have the same dimensions, type and values.
+    \sa CMatrixComparator
+  */
     static bool compare(CMatrixModel *p_model, CMatrixModel *p_other);
 
+    /*!
+    Reads the history settings again, for instance after the preferences are modified.
+    They are otherwise read once and shared by all the models.
+  */
+    static void readHistorySettings();
+
     // OpenCV wrappers
     int channels() const;
     int type() const;
@@ -102,8 +251,69 @@ public:
 
     QPointF center() const;
 
+    /*!
+    Returns the cache of the displayed values of the cells.
+  */
+    std::shared_ptr<CDisplayCache> displayCache() const;
+
+    /*!
+    Formats in background the displayed values of \a p_cells that are not cached yet.
+    Cells are given as a QRect whose x is the column and y is the row.
+  */
+    void prefetch(const QRect &p_cells);
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    bool isHistoryEnabled() const;
+
+    /*!
+    Enables or disables the recording of the edits in the history.
+    Disabling the history does not discard the edits already recorded.
+  */
+    void setHistoryEnabled(const bool p_enabled);
+
+    /*!
+    Begins a group of edits that are undone as a single one.
+    Undo and redo are disabled until the group ends.
+    \sa endHistoryGroup, restoreHistoryGroup
+  */
+    void beginHistoryGroup();
+    void endHistoryGroup();
+
+    /*!
+    Restores the matrix as it was when the current history group began.
+    Returns \a false if no group is open.
+  */
+    bool restoreHistoryGroup();
+
+signals:
+    void frameChanged(int p_frame);
+    void historyChanged();
+
+    /*!
+    This signal is emitted with a \a p_message for the user, for instance when an edit can't be undone.
+  */
+    void message(const QString &p_message);
+
+    /*!
+    This signal is emitted when the statistics have been computed in background.
+    \sa valueRange
+  */
+    void statisticsChanged();
+
 public slots:
 
+    // history
+    void undo();
+    void redo();
+
+    // sort
+    void restoreOrder();
+
+    // frames
+    void setFrame(int p_frame);
+
     // format
     void convertTo(const int p_type, const double p_alpha, const double p_beta);
 
@@ -140,11 +350,79 @@ public slots:
 
     void threshold(const double p_threshold, const double p_maxValue, const int p_type);
 
+private slots:
+    void invalidateDisplay(const QModelIndex &p_topLeft, const QModelIndex &p_bottomRight);
+    void clearDisplay();
+    void updateStatistics(const QModelIndex &p_topLeft, const QModelIndex &p_bottomRight);
+    void clearStatistics();
+    void statisticsComputed();
+    void markFrameModified();
+
 private:
+    /// Formats the value of a cell with \a p_precision significant digits (-1 for the shortest exact representation).
+    typedef QString (*CellFormatter)(const cv::Mat &p_data, const int p_row, const int p_col, const int p_precision);
+
+    void updateCellFormatter() const;
+    void emitDataChanged(const cv::Size &p_previousSize, const int p_previousType);
+    void emitHistoryChanged(const cv::Size &p_previousSize, const int p_previousType, const QRect &p_cells);
+    void recordSnapshot();
+    void recordSnapshot(const cv::Mat &p_data);
+    qint64 historyMemoryLimit() const;
+    void trimFrameHistories();
+    void connectCaches();
+
+    bool isStorageView() const;
+    bool isStorageShared() const;
+    void prepareStorage();
+    void reserveStorage(const size_t p_total);
+    void setStorageView(const int p_rows, const int p_cols);
+    void releaseUnusedMapping();
+
+    static QVector<QPair<int, int>> normalizeRanges(const QVector<QPair<int, int>> &p_ranges, const int p_size);
+
+    static QVector<QString> formatCells(const cv::Mat &p_data, const CellFormatter p_formatter, const QRect &p_cells);
+
+    void startStatistics() const;
+    void replaceStatistics(const QRect &p_cells, const cv::Mat &p_before);
+    void transformStatistics(const double p_scale, const double p_offset, const int p_channel);
+
     QString m_filePath;
     CMatrixConverter::FileFormat m_format;
     cv::Mat m_data;
+    std::shared_ptr<CMappedFile> m_mapping;
+
+    // flat buffer with spare capacity that m_data views after rows/columns are inserted or removed
+    cv::Mat m_storage;
+    std::shared_ptr<CEdfFile> m_edfFile;
+
+    // edited frames of a multi-frame file and their history, kept while another frame is shown
+    QHash<int, cv::Mat> m_frameEdits;
+    QHash<int, std::shared_ptr<CHistory>> m_frameHistories;
+    bool m_isFrameModified;
     CMetadata m_metadata;
     QStringList m_horizontalHeaderLabels;
     QStringList m_verticalHeaderLabels;
+
+    // formatter of the cells, selected from the type of the matrix
+    mutable CellFormatter m_cellFormatter;
+    mutable int m_cellFormatterType;
+
+    // formatted values of the displayed cells
+    std::shared_ptr<CDisplayCache> m_displayCache;
+
+    // undo/redo history of the edits
+    std::shared_ptr<CHistory> m_history;
+    bool m_isHistoryEnabled;
+
+    // original index of each row since the matrix was sorted, empty if it was not
+    std::vector<int> m_rowOrder;
+
+    // statistics of the values, shared by the stretch of the image, the histogram and the properties
+    mutable CMatrixStatistics m_statistics;
+    mutable quint64 m_statisticsGeneration;
+    mutable quint64 m_statisticsTaskGeneration;
+    mutable QFutureWatcher<CMatrixStatistics> m_statisticsWatcher;
+
+    // the statistics have already been updated for the next dataChanged()
+    bool m_isStatisticsUpdated;
 };
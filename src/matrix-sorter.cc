@@ -0,0 +1,299 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "matrix-sorter.hh"
+
+#include <algorithm>
+#include <cstring>
+
+// Below this number of rows per thread, the radix passes are not split
+static const int s_minChunkRows = 1 << 16;
+
+// Number of rows moved by each task of gatherRows / scatterRows
+static const int s_blockRows = 4096;
+
+// Order preserving conversions of the values into unsigned integers
+static inline quint8 orderedKey(const uchar p_value)
+{
+    return p_value;
+}
+
+static inline quint8 orderedKey(const schar p_value)
+{
+    return static_cast<quint8>(p_value) ^ 0x80;
+}
+
+static inline quint16 orderedKey(const ushort p_value)
+{
+    return p_value;
+}
+
+static inline quint16 orderedKey(const short p_value)
+{
+    return static_cast<quint16>(p_value) ^ 0x8000;
+}
+
+static inline quint32 orderedKey(const int p_value)
+{
+    return static_cast<quint32>(p_value) ^ 0x80000000u;
+}
+
+static inline quint32 orderedKey(const float p_value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &p_value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+static inline quint64 orderedKey(const double p_value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &p_value, sizeof(bits));
+    return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+}
+
+static inline int chunkBegin(const int p_size, const int p_chunk, const int p_chunks)
+{
+    return static_cast<int>(static_cast<qint64>(p_size) * p_chunk / p_chunks);
+}
+
+template <typename K>
+static void radixSort(std::vector<K>& p_keys, std::vector<int>& p_index)
+{
+    const int size   = static_cast<int>(p_keys.size());
+    const int chunks = std::max(1, std::min(cv::getNumThreads(), size / s_minChunkRows));
+
+    std::vector<K> keys(size);
+    std::vector<int> index(size);
+    std::vector<int> offsets(chunks * 256);
+
+    for (int shift = 0; shift < 8 * static_cast<int>(sizeof(K)); shift += 8)
+    {
+        // Histogram of the digit, per chunk
+        std::fill(offsets.begin(), offsets.end(), 0);
+        cv::parallel_for_(cv::Range(0, chunks),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int c = p_range.start; c < p_range.end; ++c)
+                              {
+                                  int* counts     = offsets.data() + c * 256;
+                                  const int first = chunkBegin(size, c, chunks);
+                                  const int last  = chunkBegin(size, c + 1, chunks);
+                                  for (int i = first; i < last; ++i)
+                                  {
+                                      ++counts[(p_keys[i] >> shift) & 0xff];
+                                  }
+                              }
+                          });
+
+        // Skip the digits that are shared by all the keys
+        bool isShared = false;
+        for (int b = 0; b < 256 && !isShared; ++b)
+        {
+            int count = 0;
+            for (int c = 0; c < chunks; ++c)
+            {
+                count += offsets[c * 256 + b];
+            }
+            isShared = (count == size);
+        }
+        if (isShared)
+        {
+            continue;
+        }
+
+        // Chunks of a bucket are written in order, which keeps the sort stable
+        int offset = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            for (int c = 0; c < chunks; ++c)
+            {
+                const int count      = offsets[c * 256 + b];
+                offsets[c * 256 + b] = offset;
+                offset += count;
+            }
+        }
+
+        cv::parallel_for_(cv::Range(0, chunks),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int c = p_range.start; c < p_range.end; ++c)
+                              {
+                                  int* positions  = offsets.data() + c * 256;
+                                  const int first = chunkBegin(size, c, chunks);
+                                  const int last  = chunkBegin(size, c + 1, chunks);
+                                  for (int i = first; i < last; ++i)
+                                  {
+                                      const int position = positions[(p_keys[i] >> shift) & 0xff]++;
+                                      keys[position]     = p_keys[i];
+                                      index[position]    = p_index[i];
+                                  }
+                              }
+                          });
+
+        p_keys.swap(keys);
+        p_index.swap(index);
+    }
+}
+
+template <typename T, typename K>
+static void sortByKey(const cv::Mat& p_data, const CMatrixSorter::SortKey& p_key, std::vector<int>& p_index)
+{
+    const int offset       = p_key.column * p_data.channels() + p_key.channel;
+    const bool isAscending = (p_key.order == Qt::AscendingOrder);
+
+    // Keys are read in the current order of the rows, descending orders invert them
+    std::vector<K> keys(p_index.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(p_index.size())),
+                      [&](const cv::Range& p_range)
+                      {
+                          for (int i = p_range.start; i < p_range.end; ++i)
+                          {
+                              const K key = orderedKey(p_data.ptr<T>(p_index[i])[offset]);
+                              keys[i]     = isAscending ? key : static_cast<K>(~key);
+                          }
+                      });
+
+    radixSort(keys, p_index);
+}
+
+bool CMatrixSorter::sortIndex(const cv::Mat& p_data, const QVector<SortKey>& p_keys, std::vector<int>& p_index)
+{
+    if (p_keys.isEmpty())
+    {
+        return false;
+    }
+
+    for (const SortKey& key : p_keys)
+    {
+        if (key.column < 0 || key.column >= p_data.cols || key.channel < 0 || key.channel >= p_data.channels())
+        {
+            return false;
+        }
+    }
+
+    p_index.resize(p_data.rows);
+    for (int i = 0; i < p_data.rows; ++i)
+    {
+        p_index[i] = i;
+    }
+
+    // Least significant key first: each stable pass keeps the order of the previous ones for equal keys
+    for (int k = p_keys.size() - 1; k >= 0; --k)
+    {
+        switch (p_data.depth())
+        {
+            case CV_8U:
+                sortByKey<uchar, quint8>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_8S:
+                sortByKey<schar, quint8>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_16U:
+                sortByKey<ushort, quint16>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_16S:
+                sortByKey<short, quint16>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_32S:
+                sortByKey<int, quint32>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_32F:
+                sortByKey<float, quint32>(p_data, p_keys[k], p_index);
+                break;
+
+            case CV_64F:
+                sortByKey<double, quint64>(p_data, p_keys[k], p_index);
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+cv::Mat CMatrixSorter::gatherRows(const cv::Mat& p_data, const std::vector<int>& p_order)
+{
+    return permuteRows(p_data, p_order, false);
+}
+
+cv::Mat CMatrixSorter::scatterRows(const cv::Mat& p_data, const std::vector<int>& p_order)
+{
+    return permuteRows(p_data, p_order, true);
+}
+
+template <size_t N>
+static void moveRows(const cv::Mat& p_src, cv::Mat& p_dst, const std::vector<int>& p_order, const cv::Range& p_rows, const bool p_scatter)
+{
+    // Fixed size copies of narrow rows are compiled into plain moves
+    for (int i = p_rows.start; i < p_rows.end; ++i)
+    {
+        std::memcpy(p_dst.ptr(p_scatter ? p_order[i] : i), p_src.ptr(p_scatter ? i : p_order[i]), N);
+    }
+}
+
+cv::Mat CMatrixSorter::permuteRows(const cv::Mat& p_data, const std::vector<int>& p_order, const bool p_scatter)
+{
+    CV_Assert(static_cast<int>(p_order.size()) == p_data.rows);
+
+    cv::Mat result(p_data.size(), p_data.type());
+
+    const size_t rowSize = p_data.cols * p_data.elemSize();
+    const int blocks     = (p_data.rows + s_blockRows - 1) / s_blockRows;
+    cv::parallel_for_(cv::Range(0, blocks),
+                      [&](const cv::Range& p_range)
+                      {
+                          for (int b = p_range.start; b < p_range.end; ++b)
+                          {
+                              const cv::Range rows(b * s_blockRows, std::min(p_data.rows, (b + 1) * s_blockRows));
+                              switch (rowSize)
+                              {
+                                  case 1:
+                                      moveRows<1>(p_data, result, p_order, rows, p_scatter);
+                                      break;
+
+                                  case 2:
+                                      moveRows<2>(p_data, result, p_order, rows, p_scatter);
+                                      break;
+
+                                  case 4:
+                                      moveRows<4>(p_data, result, p_order, rows, p_scatter);
+                                      break;
+
+                                  case 8:
+                                      moveRows<8>(p_data, result, p_order, rows, p_scatter);
+                                      break;
+
+                                  default:
+                                      for (int i = rows.start; i < rows.end; ++i)
+                                      {
+                                          std::memcpy(result.ptr(p_scatter ? p_order[i] : i), p_data.ptr(p_scatter ? i : p_order[i]), rowSize);
+                                      }
+                                      break;
+                              }
+                          }
+                      });
+
+    return result;
+}
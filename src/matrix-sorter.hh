@@ -0,0 +1,73 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QVector>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/*!
+  \file matrix-sorter.hh
+  \class CMatrixSorter
+  \brief CMatrixSorter sorts the rows of a matrix by the values of some of its cells
+
+  Rows are sorted by a list of keys: a column, a channel of this column and
+  an order. The first key is the most significant one, the next keys only
+  order the rows whose previous keys are equal.
+
+  Values of each key are converted into unsigned integers that preserve their
+  order (negative values, floating point values) and the indices of the rows
+  are sorted with a parallel least significant digit radix sort, one byte per
+  pass. The sort is stable: rows with equal keys keep their relative order.
+
+  The rows themselves are only moved once, by gatherRows(), from the sorted
+  indices. scatterRows() applies the inverse permutation, which restores
+  the original order of sorted rows.
+*/
+class CMatrixSorter
+{
+public:
+    struct SortKey
+    {
+        int column;
+        int channel;
+        Qt::SortOrder order;
+    };
+
+    /*!
+    Sets \a p_index to the indices of the rows of \a p_data sorted by \a p_keys:
+    the row i of the sorted matrix is the row p_index[i] of \a p_data.
+    Returns \a false if a key is out of the matrix or if the type of the matrix is not supported.
+  */
+    static bool sortIndex(const cv::Mat &p_data, const QVector<SortKey> &p_keys, std::vector<int> &p_index);
+
+    /*!
+    Returns the matrix whose row i is the row p_order[i] of \a p_data.
+  */
+    static cv::Mat gatherRows(const cv::Mat &p_data, const std::vector<int> &p_order);
+
+    /*!
+    Returns the matrix whose row p_order[i] is the row i of \a p_data.
+    This is the inverse of gatherRows().
+  */
+    static cv::Mat scatterRows(const cv::Mat &p_data, const std::vector<int> &p_order);
+
+private:
+    static cv::Mat permuteRows(const cv::Mat &p_data, const std::vector<int> &p_order, const bool p_scatter);
+};
@@ -0,0 +1,316 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+#include "matrix-statistics.hh"
+
+#include "parallel-bands.hh"
+
+#include <QRect>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+typedef void (*BandReducer)(const cv::Mat &p_data, const int p_firstRow, QVector<CMatrixStatistics::ChannelStatistics> &p_channels);
+
+static CMatrixStatistics::ChannelStatistics emptyChannel()
+{
+    return CMatrixStatistics::ChannelStatistics{0, 0, 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), QPoint(), QPoint()};
+}
+
+// Accounts for the value of a cell
+static inline void addValue(CMatrixStatistics::ChannelStatistics &p_channel, const double p_value, const int p_row, const int p_col)
+{
+    ++p_channel.count;
+    p_channel.sum += p_value;
+    p_channel.sumSquares += p_value * p_value;
+    if (p_value < p_channel.min)
+    {
+        p_channel.min     = p_value;
+        p_channel.minCell = QPoint(p_col, p_row);
+    }
+    if (p_value > p_channel.max)
+    {
+        p_channel.max     = p_value;
+        p_channel.maxCell = QPoint(p_col, p_row);
+    }
+}
+
+template <typename T>
+static void reduceBand(const cv::Mat &p_data, const int p_firstRow, QVector<CMatrixStatistics::ChannelStatistics> &p_channels)
+{
+    const int cn = p_data.channels();
+    for (int i = 0; i < p_data.rows; ++i)
+    {
+        const T *row = p_data.ptr<T>(i);
+        for (int j = 0; j < p_data.cols; ++j)
+        {
+            for (int c = 0; c < cn; ++c)
+            {
+                const double value = static_cast<double>(row[j * cn + c]);
+                if (!std::isnan(value))
+                {
+                    addValue(p_channels[c], value, p_firstRow + i, j);
+                }
+            }
+        }
+    }
+}
+
+// Merges the statistics of a band into the statistics of the previous bands:
+// the first extremum in row-major order is kept
+static void mergeChannel(CMatrixStatistics::ChannelStatistics &p_channel, const CMatrixStatistics::ChannelStatistics &p_band)
+{
+    p_channel.count += p_band.count;
+    p_channel.sum += p_band.sum;
+    p_channel.sumSquares += p_band.sumSquares;
+    if (p_band.min < p_channel.min)
+    {
+        p_channel.min     = p_band.min;
+        p_channel.minCell = p_band.minCell;
+    }
+    if (p_band.max > p_channel.max)
+    {
+        p_channel.max     = p_band.max;
+        p_channel.maxCell = p_band.maxCell;
+    }
+}
+
+double CMatrixStatistics::ChannelStatistics::mean() const
+{
+    return (count == 0) ? 0 : sum / count;
+}
+
+double CMatrixStatistics::ChannelStatistics::standardDeviation() const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const double average = mean();
+    return std::sqrt(qMax(0., sumSquares / count - average * average));
+}
+
+CMatrixStatistics::CMatrixStatistics() : m_isValid(false), m_channels(), m_histogram(), m_histogramBins(0) { }
+
+CMatrixStatistics::~CMatrixStatistics() { }
+
+bool CMatrixStatistics::isValid() const
+{
+    return m_isValid;
+}
+
+int CMatrixStatistics::channels() const
+{
+    return m_channels.size();
+}
+
+const CMatrixStatistics::ChannelStatistics &CMatrixStatistics::channel(const int p_channel) const
+{
+    return m_channels.at(p_channel);
+}
+
+double CMatrixStatistics::min() const
+{
+    double min = std::numeric_limits<double>::infinity();
+    for (const ChannelStatistics &channel : m_channels)
+    {
+        min = qMin(min, channel.min);
+    }
+    return min;
+}
+
+double CMatrixStatistics::max() const
+{
+    double max = -std::numeric_limits<double>::infinity();
+    for (const ChannelStatistics &channel : m_channels)
+    {
+        max = qMax(max, channel.max);
+    }
+    return max;
+}
+
+const CMatrixHistogram &CMatrixStatistics::histogram() const
+{
+    return m_histogram;
+}
+
+int CMatrixStatistics::histogramBins() const
+{
+    return m_histogramBins;
+}
+
+void CMatrixStatistics::setHistogram(const CMatrixHistogram &p_histogram, const int p_bins)
+{
+    m_histogram     = p_histogram;
+    m_histogramBins = p_bins;
+}
+
+CMatrixStatistics CMatrixStatistics::compute(const cv::Mat &p_data)
+{
+    static const BandReducer s_bandReducers[] = {reduceBand<uchar>, reduceBand<schar>, reduceBand<ushort>, reduceBand<short>, reduceBand<int>, reduceBand<float>, reduceBand<double>};
+
+    CMatrixStatistics statistics;
+    const int depth = p_data.depth();
+    if (p_data.empty() || depth > CV_64F)
+    {
+        return statistics;
+    }
+
+    // Bands are reduced in parallel, their statistics are merged in order
+    const BandReducer reducer = s_bandReducers[depth];
+    const int cn              = p_data.channels();
+    const int rows            = CParallelBands::rows(p_data);
+    const int bands           = (p_data.rows + rows - 1) / rows;
+    std::vector<QVector<ChannelStatistics>> bandChannels(bands, QVector<ChannelStatistics>(cn, emptyChannel()));
+    cv::parallel_for_(cv::Range(0, bands),
+                      [&](const cv::Range &p_range)
+                      {
+                          for (int band = p_range.start; band < p_range.end; ++band)
+                          {
+                              const int first = band * rows;
+                              reducer(p_data.rowRange(first, qMin(p_data.rows, first + rows)), first, bandChannels[band]);
+                          }
+                      });
+
+    statistics.m_channels = QVector<ChannelStatistics>(cn, emptyChannel());
+    for (const QVector<ChannelStatistics> &band : bandChannels)
+    {
+        for (int c = 0; c < cn; ++c)
+        {
+            mergeChannel(statistics.m_channels[c], band[c]);
+        }
+    }
+
+    statistics.m_isValid = true;
+    return statistics;
+}
+
+bool CMatrixStatistics::replace(const cv::Mat &p_before, const cv::Mat &p_after, const QPoint &p_position)
+{
+    const int cn = p_after.channels();
+    if (!m_isValid || p_before.size() != p_after.size() || p_before.type() != p_after.type() || cn != channels())
+    {
+        return false;
+    }
+
+    cv::Mat before, after;
+    p_before.convertTo(before, CV_64F);
+    p_after.convertTo(after, CV_64F);
+
+    const QRect cells(p_position, QSize(p_after.cols, p_after.rows));
+    for (int c = 0; c < cn; ++c)
+    {
+        ChannelStatistics &channel = m_channels[c];
+        ChannelStatistics removed  = emptyChannel();
+        ChannelStatistics added    = emptyChannel();
+        for (int i = 0; i < after.rows; ++i)
+        {
+            const double *previous = before.ptr<double>(i);
+            const double *current  = after.ptr<double>(i);
+            for (int j = 0; j < after.cols; ++j)
+            {
+                if (!std::isnan(previous[j * cn + c]))
+                {
+                    addValue(removed, previous[j * cn + c], cells.y() + i, cells.x() + j);
+                }
+                if (!std::isnan(current[j * cn + c]))
+                {
+                    addValue(added, current[j * cn + c], cells.y() + i, cells.x() + j);
+                }
+            }
+        }
+
+        // An extremum that has been replaced by a value within the range must be searched again
+        if ((cells.contains(channel.minCell) && added.min > channel.min) || (cells.contains(channel.maxCell) && added.max < channel.max))
+        {
+            m_isValid = false;
+            return false;
+        }
+
+        channel.count = channel.count - removed.count + added.count;
+        channel.sum += added.sum - removed.sum;
+        channel.sumSquares += added.sumSquares - removed.sumSquares;
+        if (added.min <= channel.min)
+        {
+            channel.min     = added.min;
+            channel.minCell = added.minCell;
+        }
+        if (added.max >= channel.max)
+        {
+            channel.max     = added.max;
+            channel.maxCell = added.maxCell;
+        }
+    }
+
+    // The histogram is dropped if the new values are out of its range
+    if (!m_histogram.isEmpty() && !(m_histogram.accumulate(p_before, -1) && m_histogram.accumulate(p_after, 1)))
+    {
+        m_histogram = CMatrixHistogram();
+    }
+
+    return true;
+}
+
+bool CMatrixStatistics::transform(const double p_scale, const double p_offset, const int p_channel)
+{
+    if (!m_isValid || p_channel >= channels())
+    {
+        return false;
+    }
+
+    for (int c = 0; c < channels(); ++c)
+    {
+        if (p_channel >= 0 && c != p_channel)
+        {
+            continue;
+        }
+
+        // value * 0 is NaN for infinite values: the count changes
+        ChannelStatistics &channel = m_channels[c];
+        if (channel.count > 0 && (!std::isfinite(channel.min) || !std::isfinite(channel.max)))
+        {
+            m_isValid = false;
+            return false;
+        }
+
+        const double sum   = channel.sum;
+        const double count = static_cast<double>(channel.count);
+        channel.sum        = p_scale * sum + p_offset * count;
+        channel.sumSquares = p_scale * p_scale * channel.sumSquares + 2 * p_scale * p_offset * sum + p_offset * p_offset * count;
+        channel.min        = channel.min * p_scale + p_offset;
+        channel.max        = channel.max * p_scale + p_offset;
+        if (p_scale < 0)
+        {
+            std::swap(channel.min, channel.max);
+            std::swap(channel.minCell, channel.maxCell);
+        }
+    }
+
+    // The bins only move with an offset common to all the channels
+    if (p_scale == 1 && (p_channel < 0 || channels() == 1))
+    {
+        m_histogram.shift(p_offset);
+    }
+    else
+    {
+        m_histogram = CMatrixHistogram();
+    }
+
+    return true;
+}
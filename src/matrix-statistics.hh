@@ -0,0 +1,120 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include "matrix-histogram.hh"
+
+#include <QPoint>
+#include <QVector>
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file matrix-statistics.hh
+  \class CMatrixStatistics
+  \brief CMatrixStatistics holds the sufficient statistics of the channels of a matrix
+
+  For each channel: the number of values, their sum and sum of squares, from which
+  the mean and the standard deviation are derived, and the minimum and maximum values
+  with their cells (x is the column, y is the row). NaN values are not counted.
+  A histogram of the values may be attached to the statistics.
+
+  compute() scans the matrix by bands of rows in parallel.
+  The statistics are then maintained without scanning the matrix again:
+  replace() accounts for modified cells given their previous and new values,
+  and transform() for an affine transformation of the values.
+  Both return \a false when the statistics can't be updated that way, for example
+  when the cell that holds the minimum is replaced by a larger value.
+*/
+class CMatrixStatistics
+{
+public:
+    struct ChannelStatistics
+    {
+        quint64 count;
+        double sum;
+        double sumSquares;
+
+        double min;
+        double max;
+        QPoint minCell;
+        QPoint maxCell;
+
+        double mean() const;
+        double standardDeviation() const;
+    };
+
+    /// Constructor.
+    CMatrixStatistics();
+
+    /// Destructor.
+    ~CMatrixStatistics();
+
+    bool isValid() const;
+    int channels() const;
+
+    const ChannelStatistics &channel(const int p_channel) const;
+
+    /*!
+    Returns the minimum value over all channels.
+  */
+    double min() const;
+
+    /*!
+    Returns the maximum value over all channels.
+  */
+    double max() const;
+
+    /*!
+    Returns the attached histogram, empty if there is none.
+  */
+    const CMatrixHistogram &histogram() const;
+
+    /*!
+    Returns the number of bins requested for the attached histogram, 0 for an adaptive number.
+  */
+    int histogramBins() const;
+
+    void setHistogram(const CMatrixHistogram &p_histogram, const int p_bins);
+
+    /*!
+    Computes the statistics of \a p_data, without histogram.
+  */
+    static CMatrixStatistics compute(const cv::Mat &p_data);
+
+    /*!
+    Updates the statistics after the values \a p_before of the cells at \a p_position
+    have been replaced by \a p_after, both of the type of the matrix.
+    Returns \a false if the statistics must be computed again.
+  */
+    bool replace(const cv::Mat &p_before, const cv::Mat &p_after, const QPoint &p_position);
+
+    /*!
+    Updates the statistics after the values of the channel \a p_channel (all channels if -1)
+    have been transformed into value * \a p_scale + \a p_offset.
+    Returns \a false if the statistics must be computed again.
+  */
+    bool transform(const double p_scale, const double p_offset, const int p_channel = -1);
+
+private:
+    bool m_isValid;
+    QVector<ChannelStatistics> m_channels;
+    CMatrixHistogram m_histogram;
+    int m_histogramBins;
+};
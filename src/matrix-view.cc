@@ -18,6 +18,7 @@
 #include "matrix-view.hh"
 
 #include "main-window.hh"
+#include "matrix-model.hh"
 #include "position.hh"
 #include "properties-dialog.hh"
 
@@ -26,6 +27,7 @@
 #include <QDebug>
 #include <QHeaderView>
 #include <QMenu>
+#include <QScrollBar>
 #include <QSettings>
 
 CMatrixView::CMatrixView(QWidget *p_parent)
@@ -35,6 +37,7 @@ CMatrixView::CMatrixView(QWidget *p_parent)
     , m_propertiesAct(nullptr)
     , m_isSortingEnabled(false)
     , m_currentSelection()
+    , m_lastScroll()
 {
     setAlternatingRowColors(true);
     setShowGrid(true);
@@ -62,6 +65,9 @@ CMatrixView::CMatrixView(QWidget *p_parent)
     m_propertiesAct->setIcon(QIcon::fromTheme("document-properties"));
     m_propertiesAct->setStatusTip(tr("Display properties of the matrix"));
     connect(m_propertiesAct, SIGNAL(triggered()), SLOT(properties()));
+
+    connect(horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(prefetchCells()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(prefetchCells()));
 }
 
 CMatrixView::~CMatrixView()
@@ -203,6 +209,24 @@ void CMatrixView::horizontalHeaderContextMenu(const QPoint &p_pos)
     connect(action, SIGNAL(triggered()), this, SLOT(removeOtherColumns()));
     menu->addAction(action);
 
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    if (matrixModel != nullptr)
+    {
+        menu->addSeparator();
+        for (int channel = 0; matrixModel->channels() > 1 && channel < matrixModel->channels(); ++channel)
+        {
+            action = new QAction(tr("Sort by channel %1").arg(channel + 1), this);
+            action->setData(channel);
+            connect(action, SIGNAL(triggered()), this, SLOT(sortByChannel()));
+            menu->addAction(action);
+        }
+
+        action = new QAction(tr("Restore original order"), this);
+        action->setEnabled(matrixModel->canRestoreOrder());
+        connect(action, SIGNAL(triggered()), this, SLOT(restoreOrder()));
+        menu->addAction(action);
+    }
+
     menu->exec(mapToGlobal(p_pos));
     delete menu;
 
@@ -229,19 +253,21 @@ void CMatrixView::removeCurrentColumn()
 
 void CMatrixView::removeOtherRows()
 {
-    bool success  = true;
     const int idx = m_currentSelection.row();
 
-    // remove top part
+    // remove top and bottom parts in a single pass
+    QVector<QPair<int, int>> ranges;
     if (idx > 0)
     {
-        success = success && model()->removeRows(0, idx);
+        ranges << qMakePair(0, idx);
+    }
+    if (idx + 1 < model()->rowCount())
+    {
+        ranges << qMakePair(idx + 1, model()->rowCount() - idx - 1);
     }
 
-    // remove bottom part
-    success = success && model()->removeRows(1, model()->rowCount() - 1);
-
-    if (!success)
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    if (matrixModel == nullptr || (!ranges.isEmpty() && !matrixModel->removeRowRanges(ranges)))
     {
         qWarning() << "Can't remove all other rows than " << idx;
     }
@@ -249,19 +275,21 @@ void CMatrixView::removeOtherRows()
 
 void CMatrixView::removeOtherColumns()
 {
-    bool success  = true;
     const int idx = m_currentSelection.column();
 
-    // remove left part
+    // remove left and right parts in a single pass
+    QVector<QPair<int, int>> ranges;
     if (idx > 0)
     {
-        success = success && model()->removeColumns(0, idx);
+        ranges << qMakePair(0, idx);
+    }
+    if (idx + 1 < model()->columnCount())
+    {
+        ranges << qMakePair(idx + 1, model()->columnCount() - idx - 1);
     }
 
-    // remove right part
-    success = success && model()->removeColumns(1, model()->columnCount() - 1);
-
-    if (!success)
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    if (matrixModel == nullptr || (!ranges.isEmpty() && !matrixModel->removeColumnRanges(ranges)))
     {
         qWarning() << "Can't remove all other columns than " << idx;
     }
@@ -294,3 +322,62 @@ void CMatrixView::enableSortByColumn(int p_column)
         m_isSortingEnabled = true;
     }
 }
+
+void CMatrixView::sortByChannel()
+{
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    QAction *action           = qobject_cast<QAction *>(sender());
+    if (matrixModel == nullptr || action == nullptr)
+    {
+        return;
+    }
+
+    const CMatrixSorter::SortKey key{m_currentSelection.column(), action->data().toInt(), Qt::AscendingOrder};
+    if (!matrixModel->sortRows(QVector<CMatrixSorter::SortKey>() << key))
+    {
+        qWarning() << "Can't sort rows by column " << key.column << " channel " << key.channel;
+    }
+}
+
+void CMatrixView::restoreOrder()
+{
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    if (matrixModel != nullptr)
+    {
+        matrixModel->restoreOrder();
+    }
+
+    // Restoring the order also clears the sort indicator of the header
+    horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+}
+
+void CMatrixView::prefetchCells()
+{
+    CMatrixModel *matrixModel = qobject_cast<CMatrixModel *>(model());
+    if (matrixModel == nullptr)
+    {
+        return;
+    }
+
+    const int top  = rowAt(0);
+    const int left = columnAt(0);
+    if (top < 0 || left < 0)
+    {
+        return;
+    }
+
+    int bottom = rowAt(viewport()->height() - 1);
+    int right  = columnAt(viewport()->width() - 1);
+    bottom     = (bottom < 0) ? model()->rowCount() - 1 : bottom;
+    right      = (right < 0) ? model()->columnCount() - 1 : right;
+
+    // Format the next viewport in the scroll direction before it is displayed
+    const QPoint scroll(horizontalScrollBar()->value(), verticalScrollBar()->value());
+    const QPoint delta = scroll - m_lastScroll;
+    m_lastScroll       = scroll;
+
+    const QRect visible(QPoint(left, top), QPoint(right, bottom));
+    const int dx = (delta.x() > 0) ? 1 : (delta.x() < 0 ? -1 : 0);
+    const int dy = (delta.y() > 0) ? 1 : (delta.y() < 0 ? -1 : 0);
+    matrixModel->prefetch(visible.translated(dx * visible.width(), dy * visible.height()));
+}
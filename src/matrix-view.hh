@@ -77,6 +77,10 @@ private slots:
     void insertColumnBeforeCurrent();
 
     void enableSortByColumn(int col);
+    void sortByChannel();
+    void restoreOrder();
+
+    void prefetchCells();
 
 private:
     CMainWindow *m_parent;
@@ -87,4 +91,7 @@ private:
     bool m_isSortingEnabled;
 
     QModelIndex m_currentSelection;
+
+    // scroll position of the last prefetch
+    QPoint m_lastScroll;
 };
@@ -18,11 +18,32 @@
 
 #include "mfe.hh"
 
+#include "mapped-file.hh"
+
+#include <QByteArray>
 #include <QDataStream>
 #include <QDebug>
 #include <QFile>
+#include <atomic>
+
+#if defined(ZSTD_ENABLED)
+#    include <zstd.h>
+#endif
+
+// Size of the index entries of version 2 files
+static const int s_chunkEntrySize = 20;
 
-MatrixFormatExchange::MatrixFormatExchange() : m_header(), m_comment(""), m_data() { }
+MatrixFormatExchange::MatrixFormatExchange()
+    : m_header()
+    , m_comment("")
+    , m_data()
+    , m_mapping()
+    , m_version(1)
+    , m_source()
+    , m_bandRows(0)
+    , m_chunks()
+{
+}
 
 MatrixFormatExchange::~MatrixFormatExchange() { }
 
@@ -65,6 +86,31 @@ std::string MatrixFormatExchange::toString() const
     return stream.str();
 }
 
+int MatrixFormatExchange::rows() const
+{
+    return static_cast<int>(m_header.rows);
+}
+
+int MatrixFormatExchange::cols() const
+{
+    return static_cast<int>(m_header.cols);
+}
+
+int MatrixFormatExchange::type() const
+{
+    return static_cast<int>(m_header.type);
+}
+
+int MatrixFormatExchange::version() const
+{
+    return m_version;
+}
+
+void MatrixFormatExchange::setVersion(const int p_version)
+{
+    m_version = p_version;
+}
+
 bool MatrixFormatExchange::write(const QString& p_path)
 {
     QFile file(p_path);
@@ -77,6 +123,7 @@ bool MatrixFormatExchange::write(const QString& p_path)
     QDataStream stream(&file);
 
     // header
+    m_header.format[2] = (m_version == 2) ? '2' : 'E';
     m_header.write(stream);
 
     // comment
@@ -87,6 +134,11 @@ bool MatrixFormatExchange::write(const QString& p_path)
     }
 
     // data
+    if (m_version == 2)
+    {
+        return writeChunks(stream);
+    }
+
     if (stream.writeRawData(reinterpret_cast<char*>(m_data.data), m_data.rows * m_data.cols * m_data.elemSize()) == -1)
     {
         qWarning() << "Can't write MFE data";
@@ -98,8 +150,20 @@ bool MatrixFormatExchange::write(const QString& p_path)
     return true;
 }
 
-bool MatrixFormatExchange::read(const QString& p_path)
+std::shared_ptr<CMappedFile> MatrixFormatExchange::mapping() const
 {
+    return m_mapping;
+}
+
+bool MatrixFormatExchange::read(const QString& p_path, const bool p_mapped)
+{
+    m_mapping.reset();
+
+    if (p_mapped)
+    {
+        return readMapped(p_path);
+    }
+
     QFile file(p_path);
     if (!file.open(QIODevice::ReadOnly))
     {
@@ -117,6 +181,20 @@ bool MatrixFormatExchange::read(const QString& p_path)
         return false;
     }
 
+    if (m_header.format[2] == '2')
+    {
+        // compressed chunks are decoded from a mapping of the file
+        file.close();
+        if (!open(p_path))
+        {
+            return false;
+        }
+
+        m_data = readRows(0, m_header.rows);
+        m_source.reset();
+        return !m_data.empty();
+    }
+
     // comment
     size = m_header.offset - m_header.size();
     std::vector<char> info(size + 1);
@@ -142,3 +220,450 @@ bool MatrixFormatExchange::read(const QString& p_path)
 
     return true;
 }
+
+bool MatrixFormatExchange::readMapped(const QString& p_path)
+{
+    if (!open(p_path))
+    {
+        return false;
+    }
+
+    if (m_header.format[2] == '2')
+    {
+        // compressed values can't be used in place
+        m_data = readRows(0, m_header.rows);
+        m_source.reset();
+        return !m_data.empty();
+    }
+
+    std::shared_ptr<CMappedFile> mapping = m_source;
+    m_source.reset();
+
+    const int type        = static_cast<int>(m_header.type);
+    const qint64 dataSize = (qint64) m_header.rows * m_header.cols * CV_ELEM_SIZE(type);
+    uchar* values         = mapping->data() + m_header.offset;
+
+#if !defined(Q_PROCESSOR_X86)
+    // The data offset depends on the comment length: values may not be aligned
+    // on their natural boundary, which is only supported by x86 processors.
+    if (reinterpret_cast<quintptr>(values) % CV_ELEM_SIZE1(type) != 0)
+    {
+        m_data.create(m_header.rows, m_header.cols, type);
+        std::memcpy(m_data.data, values, dataSize);
+        return true;
+    }
+#else
+    Q_UNUSED(dataSize);
+#endif
+
+    m_data    = cv::Mat(m_header.rows, m_header.cols, type, values);
+    m_mapping = mapping;
+
+    return true;
+}
+
+bool MatrixFormatExchange::open(const QString& p_path)
+{
+    m_source.reset();
+    m_chunks.clear();
+    m_bandRows = 0;
+
+    std::shared_ptr<CMappedFile> mapping = std::make_shared<CMappedFile>(p_path);
+    if (!mapping->isValid())
+    {
+        qWarning() << "Can't read from file:" << p_path;
+        return false;
+    }
+
+    // header
+    const int headerSize = m_header.size();
+    if (mapping->size() < headerSize)
+    {
+        qWarning() << "Error decoding MFE header: file is too small";
+        return false;
+    }
+
+    const QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char*>(mapping->data()), headerSize);
+    QDataStream stream(header);
+    if (!m_header.read(stream))
+    {
+        qWarning() << "Error decoding MFE header";
+        return false;
+    }
+
+    if (m_header.offset < (uint32_t) headerSize || m_header.offset > mapping->size())
+    {
+        qWarning() << "Error decoding MFE header: invalid data offset" << m_header.offset;
+        return false;
+    }
+
+    // comment
+    const char* comment = reinterpret_cast<const char*>(mapping->data() + headerSize);
+    setComment(std::string(comment, m_header.offset - headerSize));
+
+    const int type        = static_cast<int>(m_header.type);
+    const qint64 dataSize = (qint64) m_header.rows * m_header.cols * CV_ELEM_SIZE(type);
+
+    m_version = (m_header.format[2] == '2') ? 2 : 1;
+    if (m_version == 1)
+    {
+        // data
+        if (m_header.offset + dataSize > mapping->size())
+        {
+            qWarning() << "Error decoding MFE data: file is truncated";
+            return false;
+        }
+
+        m_source = mapping;
+        return true;
+    }
+
+    // chunk index
+    const uchar* index = mapping->data() + m_header.offset;
+    uint32_t chunkCount = 0;
+    if (m_header.offset + 8 > mapping->size())
+    {
+        qWarning() << "Error decoding MFE chunk index: file is truncated";
+        return false;
+    }
+    std::memcpy(&m_bandRows, index, sizeof(m_bandRows));
+    std::memcpy(&chunkCount, index + 4, sizeof(chunkCount));
+    index += 8;
+
+    const uint32_t expectedCount = (m_bandRows > 0) ? (m_header.rows + m_bandRows - 1) / m_bandRows : 0;
+    if (m_bandRows == 0 || chunkCount != expectedCount || m_header.offset + 8 + (qint64) chunkCount * s_chunkEntrySize > mapping->size())
+    {
+        qWarning() << "Error decoding MFE chunk index: invalid band size" << m_bandRows << "or chunk count" << chunkCount;
+        return false;
+    }
+
+    m_chunks.resize(chunkCount);
+    for (MFEChunk& chunk : m_chunks)
+    {
+        std::memcpy(&chunk.offset, index, sizeof(chunk.offset));
+        std::memcpy(&chunk.size, index + 8, sizeof(chunk.size));
+        std::memcpy(&chunk.codec, index + 16, sizeof(chunk.codec));
+        index += s_chunkEntrySize;
+
+        if (chunk.offset + chunk.size > (uint64_t) mapping->size())
+        {
+            qWarning() << "Error decoding MFE chunk index: file is truncated";
+            m_chunks.clear();
+            return false;
+        }
+    }
+
+    m_source = mapping;
+    return true;
+}
+
+cv::Mat MatrixFormatExchange::readRows(const int p_first, const int p_count) const
+{
+    if (!m_source)
+    {
+        qWarning() << "Can't decode MFE values: no file opened";
+        return cv::Mat();
+    }
+
+    const int rows = static_cast<int>(m_header.rows);
+    const int type = static_cast<int>(m_header.type);
+    if (p_first < 0 || p_count <= 0 || p_first > rows - p_count || m_header.cols == 0)
+    {
+        return cv::Mat();
+    }
+
+    if (m_chunks.empty())
+    {
+        // version 1: values are stored as is
+        const size_t offset = m_header.offset + (size_t) p_first * m_header.cols * CV_ELEM_SIZE(type);
+        const cv::Mat values(p_count, m_header.cols, type, m_source->data() + offset);
+        return values.clone();
+    }
+
+    // bands are decoded in parallel, straight into the rows of the matrix when they are fully read
+    cv::Mat result(p_count, m_header.cols, type);
+    const size_t rowSize = (size_t) m_header.cols * CV_ELEM_SIZE(type);
+    const int firstChunk = p_first / m_bandRows;
+    const int lastChunk  = (p_first + p_count - 1) / m_bandRows;
+
+    std::atomic<bool> valid(true);
+    cv::parallel_for_(cv::Range(firstChunk, lastChunk + 1),
+                      [&](const cv::Range& p_range)
+                      {
+                          std::vector<uchar> band;
+                          for (int i = p_range.start; i < p_range.end; ++i)
+                          {
+                              const int bandStart = i * m_bandRows;
+                              const int bandRows  = std::min<int>(m_bandRows, rows - bandStart);
+                              const int first     = std::max(bandStart, p_first);
+                              const int last      = std::min(bandStart + bandRows, p_first + p_count);
+                              if (first == bandStart && last == bandStart + bandRows)
+                              {
+                                  if (!decodeChunk(i, result.ptr(bandStart - p_first), bandRows * rowSize))
+                                  {
+                                      valid = false;
+                                      return;
+                                  }
+                                  continue;
+                              }
+
+                              band.resize(bandRows * rowSize);
+                              if (!decodeChunk(i, band.data(), band.size()))
+                              {
+                                  valid = false;
+                                  return;
+                              }
+                              std::memcpy(result.ptr(first - p_first), band.data() + (first - bandStart) * rowSize, (last - first) * rowSize);
+                          }
+                      });
+
+    if (!valid)
+    {
+        qWarning() << "Error decoding MFE data: invalid chunk";
+        return cv::Mat();
+    }
+
+    return result;
+}
+
+bool MatrixFormatExchange::writeChunks(QDataStream& p_stream)
+{
+    // bands of about 1MB
+    const size_t rowSize      = m_data.cols * m_data.elemSize();
+    const uint32_t bandRows   = (uint32_t) std::max<size_t>(1, (1 << 20) / std::max<size_t>(1, rowSize));
+    const uint32_t chunkCount = (m_data.rows + bandRows - 1) / bandRows;
+
+    std::vector<QByteArray> chunks(chunkCount);
+    std::vector<MFEChunk> entries(chunkCount);
+    cv::parallel_for_(cv::Range(0, (int) chunkCount),
+                      [&](const cv::Range& p_range)
+                      {
+                          for (int i = p_range.start; i < p_range.end; ++i)
+                          {
+                              const int first = i * bandRows;
+                              const int rows  = std::min<int>(bandRows, m_data.rows - first);
+                              chunks[i]       = encodeChunk(m_data.ptr(first), rows * rowSize, m_data.elemSize1(), entries[i].codec);
+                              entries[i].size = chunks[i].size();
+                          }
+                      });
+
+    // index
+    uint64_t offset = (uint64_t) m_header.offset + 8 + (uint64_t) chunkCount * s_chunkEntrySize;
+    for (MFEChunk& entry : entries)
+    {
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    if (p_stream.writeRawData(reinterpret_cast<const char*>(&bandRows), sizeof(bandRows)) == -1
+        || p_stream.writeRawData(reinterpret_cast<const char*>(&chunkCount), sizeof(chunkCount)) == -1)
+    {
+        qWarning() << "Can't write MFE chunk index";
+        return false;
+    }
+
+    for (const MFEChunk& entry : entries)
+    {
+        if (p_stream.writeRawData(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset)) == -1
+            || p_stream.writeRawData(reinterpret_cast<const char*>(&entry.size), sizeof(entry.size)) == -1
+            || p_stream.writeRawData(reinterpret_cast<const char*>(&entry.codec), sizeof(entry.codec)) == -1)
+        {
+            qWarning() << "Can't write MFE chunk index";
+            return false;
+        }
+    }
+
+    // chunks
+    for (const QByteArray& chunk : chunks)
+    {
+        if (p_stream.writeRawData(chunk.constData(), chunk.size()) == -1)
+        {
+            qWarning() << "Can't write MFE data";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QByteArray MatrixFormatExchange::encodeChunk(const uchar* p_src, const size_t p_size, const size_t p_elemSize1, uint32_t& p_codec)
+{
+    // grouping the bytes of same significance makes smooth data compress much better
+    std::vector<uchar> shuffled(p_size);
+    shuffle(p_src, shuffled.data(), p_size, p_elemSize1);
+
+    QByteArray result;
+#if defined(ZSTD_ENABLED)
+    p_codec = Codec_ShuffleZstd;
+    result.resize((int) ZSTD_compressBound(p_size));
+    const size_t size = ZSTD_compress(result.data(), result.size(), shuffled.data(), p_size, 3);
+    if (ZSTD_isError(size))
+    {
+        result.clear();
+    }
+    else
+    {
+        result.resize((int) size);
+    }
+#else
+    p_codec = Codec_ShuffleRle;
+    packBits(shuffled.data(), p_size, result);
+#endif
+
+    if (result.isEmpty() || (size_t) result.size() >= p_size)
+    {
+        // not worth compressing
+        p_codec = Codec_None;
+        return QByteArray(reinterpret_cast<const char*>(p_src), (int) p_size);
+    }
+
+    return result;
+}
+
+bool MatrixFormatExchange::decodeChunk(const size_t p_index, uchar* p_dst, const size_t p_size) const
+{
+    const MFEChunk& chunk = m_chunks[p_index];
+    const uchar* src      = m_source->data() + chunk.offset;
+
+    switch (chunk.codec)
+    {
+        case Codec_None:
+            if (chunk.size != p_size)
+            {
+                return false;
+            }
+            std::memcpy(p_dst, src, p_size);
+            return true;
+
+        case Codec_ShuffleRle:
+        {
+            std::vector<uchar> shuffled(p_size);
+            if (!unpackBits(src, chunk.size, shuffled.data(), p_size))
+            {
+                return false;
+            }
+            unshuffle(shuffled.data(), p_dst, p_size, CV_ELEM_SIZE1(m_header.type));
+            return true;
+        }
+
+        case Codec_ShuffleZstd:
+        {
+#if defined(ZSTD_ENABLED)
+            std::vector<uchar> shuffled(p_size);
+            const size_t size = ZSTD_decompress(shuffled.data(), p_size, src, chunk.size);
+            if (ZSTD_isError(size) || size != p_size)
+            {
+                return false;
+            }
+            unshuffle(shuffled.data(), p_dst, p_size, CV_ELEM_SIZE1(m_header.type));
+            return true;
+#else
+            qWarning() << "Can't decode MFE chunk: zstd support is not enabled";
+            return false;
+#endif
+        }
+
+        default:
+            qWarning() << "Can't decode MFE chunk: unknown codec" << chunk.codec;
+            return false;
+    }
+}
+
+void MatrixFormatExchange::shuffle(const uchar* p_src, uchar* p_dst, const size_t p_size, const size_t p_elemSize1)
+{
+    const size_t count = p_size / p_elemSize1;
+    for (size_t b = 0; b < p_elemSize1; ++b)
+    {
+        uchar* dst = p_dst + b * count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] = p_src[i * p_elemSize1 + b];
+        }
+    }
+}
+
+void MatrixFormatExchange::unshuffle(const uchar* p_src, uchar* p_dst, const size_t p_size, const size_t p_elemSize1)
+{
+    const size_t count = p_size / p_elemSize1;
+    for (size_t b = 0; b < p_elemSize1; ++b)
+    {
+        const uchar* src = p_src + b * count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            p_dst[i * p_elemSize1 + b] = src[i];
+        }
+    }
+}
+
+void MatrixFormatExchange::packBits(const uchar* p_src, const size_t p_size, QByteArray& p_dst)
+{
+    // PackBits: a control byte n in [0, 127] is followed by n + 1 literal bytes,
+    // a control byte n in [-127, -1] is followed by one byte repeated 1 - n times.
+    p_dst.reserve((int) (p_size / 4));
+
+    size_t i = 0;
+    while (i < p_size)
+    {
+        size_t run = 1;
+        while (i + run < p_size && run < 128 && p_src[i + run] == p_src[i])
+        {
+            ++run;
+        }
+
+        if (run >= 3)
+        {
+            p_dst.append(static_cast<char>(1 - (int) run));
+            p_dst.append(static_cast<char>(p_src[i]));
+            i += run;
+            continue;
+        }
+
+        // literal bytes until the next run of at least 3 bytes
+        const size_t start = i;
+        while (i < p_size && i - start < 128)
+        {
+            if (i + 2 < p_size && p_src[i] == p_src[i + 1] && p_src[i] == p_src[i + 2])
+            {
+                break;
+            }
+            ++i;
+        }
+        p_dst.append(static_cast<char>(i - start - 1));
+        p_dst.append(reinterpret_cast<const char*>(p_src + start), (int) (i - start));
+    }
+}
+
+bool MatrixFormatExchange::unpackBits(const uchar* p_src, const size_t p_srcSize, uchar* p_dst, const size_t p_dstSize)
+{
+    const uchar* src = p_src;
+    const uchar* end = p_src + p_srcSize;
+    size_t written   = 0;
+
+    while (src < end)
+    {
+        const int control = static_cast<signed char>(*src++);
+        if (control >= 0)
+        {
+            const size_t length = control + 1;
+            if (src + length > end || written + length > p_dstSize)
+            {
+                return false;
+            }
+            std::memcpy(p_dst + written, src, length);
+            src += length;
+            written += length;
+        }
+        else if (control != -128)
+        {
+            const size_t length = 1 - control;
+            if (src >= end || written + length > p_dstSize)
+            {
+                return false;
+            }
+            std::memset(p_dst + written, *src++, length);
+            written += length;
+        }
+    }
+
+    return written == p_dstSize;
+}
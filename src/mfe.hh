@@ -25,9 +25,12 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <sstream>
 
+class CMappedFile;
+
 /**
  * @class MatrixFormatExchange
  * @brief Matrix Format Exchange for Matlab/C++ data
@@ -41,6 +44,20 @@
  *  \li comment (string of variable length)
  *  \li data    (matrix values)
  *
+ * Version 2 files (format tag "MF2") store the values as independently
+ * compressed bands of rows:
+ *
+ *  \li header  (same as version 1, the offset points after the comment)
+ *  \li comment (string of variable length)
+ *  \li index   (rows per band, number of chunks, then offset, size and codec of each chunk @see MFEChunk)
+ *  \li chunks  (compressed bands of rows)
+ *
+ * Each chunk is byte-shuffled (the n-th byte of all values are stored together)
+ * then compressed with zstd when available or a PackBits run-length encoding otherwise.
+ * Chunks that do not compress are stored as is.
+ * Chunks are decoded in parallel, directly into the rows of the matrix.
+ * A range of rows can be read with readRows(): only the chunks it touches are decoded.
+ *
  * Example:
  *
  * \code
@@ -60,6 +77,21 @@
  *   cv::Mat n = mfe.GetData();
  *   std::cout << "comment: " << mfe.GetComment() << std::endl;
  *
+ *   // read matrix in MFE format without copying its values:
+ *   // the matrix points into the memory mapped file
+ *   MatrixFormatExchange mfe;
+ *   mfe.read("/tmp/matrix.mfe", true);
+ *   cv::Mat n = mfe.data(); // valid as long as mfe.mapping() is alive
+ *
+ *   // write matrix in compressed MFE version 2 format
+ *   mfe.setVersion(2);
+ *   mfe.write("/tmp/matrix.mfe");
+ *
+ *   // decode the first row only
+ *   MatrixFormatExchange mfe;
+ *   mfe.open("/tmp/matrix.mfe");
+ *   cv::Mat row = mfe.readRows(0, 1);
+ *
  *   // Compare matrix
  *   cv::Mat diff;
  *   cv::absdiff(m, n, diff);
@@ -209,6 +241,22 @@ private:
         uint32_t depth;
     };
 
+    /// Entry of the chunk index of MFE version 2 files (20 bytes)
+    struct MFEChunk
+    {
+        uint64_t offset; ///< absolute position of the chunk in the file
+        uint64_t size;   ///< size in bytes of the chunk in the file
+        uint32_t codec;  ///< @see Codec
+    };
+
+public:
+    enum Codec
+    {
+        Codec_None        = 0,
+        Codec_ShuffleRle  = 1,
+        Codec_ShuffleZstd = 2
+    };
+
 public:
     MatrixFormatExchange();
 
@@ -224,12 +272,74 @@ public:
 
     std::string toString() const;
 
+    /// Return the number of rows, columns and the type of the matrix described by the header
+    int rows() const;
+    int cols() const;
+    int type() const;
+
+    /// Return the version of the format used by write(): 1 (default) or 2 (compressed chunks)
+    int version() const;
+
+    void setVersion(const int p_version);
+
     bool write(const QString& p_path);
 
-    bool read(const QString& p_path);
+    /**
+     * @brief Read a matrix from a MFE file
+     * @param p_path the path of the MFE file
+     * @param p_mapped if true, the file is mapped in memory and the matrix points
+     *        directly into the mapped region instead of being copied
+     *
+     * In mapped mode, the matrix values are only valid as long as the mapping
+     * returned by mapping() is alive.
+     */
+    bool read(const QString& p_path, const bool p_mapped = false);
+
+    /// Return the memory mapping of the last file read in mapped mode, if any
+    std::shared_ptr<CMappedFile> mapping() const;
+
+    /**
+     * @brief Open a MFE file without decoding its values
+     *
+     * Only the header, the comment and the chunk index are read,
+     * which is enough to describe the matrix without loading it.
+     * Values are decoded on demand with readRows().
+     */
+    bool open(const QString& p_path);
+
+    /**
+     * @brief Decode \a p_count rows from the row \a p_first of the file opened with open()
+     *
+     * Only the chunks that intersect the rows are decompressed, in parallel.
+     * Returns an empty matrix on error.
+     */
+    cv::Mat readRows(const int p_first, const int p_count) const;
 
 private:
+
+    bool readMapped(const QString& p_path);
+
+    bool writeChunks(QDataStream& p_stream);
+
+    bool decodeChunk(const size_t p_index, uchar* p_dst, const size_t p_size) const;
+
+    static QByteArray encodeChunk(const uchar* p_src, const size_t p_size, const size_t p_elemSize1, uint32_t& p_codec);
+
+    static void shuffle(const uchar* p_src, uchar* p_dst, const size_t p_size, const size_t p_elemSize1);
+    static void unshuffle(const uchar* p_src, uchar* p_dst, const size_t p_size, const size_t p_elemSize1);
+
+    static void packBits(const uchar* p_src, const size_t p_size, QByteArray& p_dst);
+    static bool unpackBits(const uchar* p_src, const size_t p_srcSize, uchar* p_dst, const size_t p_dstSize);
+
     MFEHeader m_header;
     std::string m_comment;
     cv::Mat m_data;
+    std::shared_ptr<CMappedFile> m_mapping;
+
+    int m_version;
+
+    // file opened with open()
+    std::shared_ptr<CMappedFile> m_source;
+    uint32_t m_bandRows;
+    std::vector<MFEChunk> m_chunks;
 };
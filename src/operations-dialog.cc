@@ -34,7 +34,6 @@
 COperationsDialog::COperationsDialog(QWidget *p_parent)
     : QDialog(p_parent)
     , m_parent(qobject_cast<CMainWindow *>(p_parent))
-    , m_backup(model()->clone())
     , m_categoriesWidget(new QListWidget)
     , m_operationsWidget(new QStackedWidget)
 {
@@ -81,13 +80,14 @@ COperationsDialog::COperationsDialog(QWidget *p_parent)
     setLayout(mainLayout);
     adjustSize();
 
-    // save a backup of the model data
-    // that can be restored by the reset button
+    // the operations applied in the dialog are undone as a single edit,
+    // the original data can be restored by the reset button
+    model()->beginHistoryGroup();
 }
 
 COperationsDialog::~COperationsDialog()
 {
-    delete m_backup;
+    model()->endHistoryGroup();
 }
 
 QSize COperationsDialog::sizeHint() const
@@ -97,7 +97,7 @@ QSize COperationsDialog::sizeHint() const
 
 void COperationsDialog::reset()
 {
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
 
     for (int i = 0; i < m_operationsWidget->count(); ++i)
     {
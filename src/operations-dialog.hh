@@ -73,7 +73,6 @@ private:
     void createIcons();
 
     CMainWindow *m_parent;
-    CMatrixModel *m_backup;
 
     // Operations widgets
     QListWidget *m_categoriesWidget;
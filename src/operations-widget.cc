@@ -39,7 +39,6 @@ COperationWidget::COperationWidget(const QString& p_title, CMatrixModel* p_model
     : QWidget(p_parent)
     , m_parent(qobject_cast<CMainWindow*>(p_parent))
     , m_wasModified(false)
-    , m_backup(p_model->clone())
     , m_applyButton(new QPushButton(tr("Apply"), this))
     , m_openPath(QDir::homePath())
     , m_savePath(QDir::homePath())
@@ -66,10 +65,7 @@ COperationWidget::COperationWidget(const QString& p_title, CMatrixModel* p_model
     adjustSize();
 }
 
-COperationWidget::~COperationWidget()
-{
-    delete m_backup;
-}
+COperationWidget::~COperationWidget() { }
 
 const QString& COperationWidget::title() const
 {
@@ -224,7 +220,7 @@ void CRotationWidget::reset()
 
 void CRotationWidget::apply()
 {
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
 
     model()->rotate(m_centerWidget->point(), m_angleWidget->value(), m_scaleWidget->value());
 }
@@ -264,7 +260,7 @@ void CNormalizeWidget::reset()
 
 void CNormalizeWidget::apply()
 {
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
 
     int norm = 0;
     if (m_normWidget->currentText() == "L1")
@@ -382,7 +378,8 @@ void CColorMapWidget::apply()
     qWarning() << tr("Minimum required OpenCV version: 2.4");
     return;
 #else
-    cv::Mat m = m_backup->data().clone();
+    model()->restoreHistoryGroup();
+    cv::Mat m = model()->data().clone();
 
     if (model()->channels() == 1)
     {
@@ -503,7 +500,7 @@ void CThresholdWidget::reset()
 
 void CThresholdWidget::apply()
 {
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
 
     int type = 0;
     if (m_typeWidget->currentText() == "BINARY")
@@ -587,7 +584,7 @@ void CMatrixWidget::absDiff()
         return;
     }
 
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
     CMatrixModel other(m_fileChooserWidget->path());
     model()->absdiff(other.data());
 
@@ -679,7 +676,7 @@ void CChannelsWidget::apply()
         return;
     }
 
-    model()->setData(m_backup->data().clone());
+    model()->restoreHistoryGroup();
 
     QStringList paths;
     paths << m_blueOpenPath;
@@ -40,6 +40,9 @@ class CFileChooser;
   A COperationWidget defines an interface to the CMatrixModel with apply() and
   reset() actions. It owns the layout but derived classes can append their
   own widgets through the addParameter() method.
+
+  Operations that are always applied on the original data restore it from
+  the history group opened by the COperationsDialog.
 */
 class COperationWidget : public QWidget
 {
@@ -70,7 +73,6 @@ private:
     bool m_wasModified;
 
 protected:
-    CMatrixModel *m_backup;
     QPushButton *m_applyButton;
 
     QString m_openPath;
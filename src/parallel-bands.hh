@@ -0,0 +1,48 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+
+/*!
+  \file parallel-bands.hh
+  \class CParallelBands
+  \brief CParallelBands splits a matrix in bands of rows that are processed by parallel tasks
+
+  Bands of about bandSize() bytes are large enough to amortize the tasks,
+  and small enough to balance them between the threads.
+*/
+class CParallelBands
+{
+public:
+    static size_t bandSize()
+    {
+        return 1 << 20;
+    }
+
+    /*!
+    Returns the number of rows of the bands of \a p_data, at least one.
+  */
+    static int rows(const cv::Mat &p_data)
+    {
+        const size_t rowSize = qMax<size_t>(1, p_data.cols * p_data.elemSize());
+        return static_cast<int>(qMax<size_t>(1, bandSize() / rowSize));
+    }
+};
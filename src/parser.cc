@@ -19,6 +19,7 @@
 #include "parser.hh"
 
 #include "matrix-converter.hh"
+#include "raw.hh"
 
 #include <QApplication>
 #include <QDebug>
@@ -136,6 +137,44 @@ int CParser::execute()
         {
             converter.setRawHeight(QString(m_command[++i]).toInt()); //option value
         }
+        else if (arg == "--raw-type")
+        {
+            const QString name = QString(m_command[++i]); //option value
+            const int type     = CRawFile::typeFromName(name);
+            if (type < 0)
+            {
+                qWarning() << QObject::tr("Invalid raw type [%1]. Run [%2 -h] for usage information.").arg(name).arg(QCoreApplication::applicationName());
+                return -1;
+            }
+            converter.setRawType(type);
+        }
+        else if (arg == "--raw-bayer")
+        {
+            const QString name = QString(m_command[++i]); //option value
+            const int pattern  = CRawFile::bayerPatternFromName(name);
+            if (pattern < 0)
+            {
+                qWarning() << QObject::tr("Invalid Bayer pattern [%1]. Run [%2 -h] for usage information.").arg(name).arg(QCoreApplication::applicationName());
+                return -1;
+            }
+            converter.setRawBayerPattern(pattern);
+        }
+        else if (arg == "--raw-header-size")
+        {
+            converter.setRawHeaderSize(QString(m_command[++i]).toInt()); //option value
+        }
+        else if (arg == "--raw-big-endian")
+        {
+            converter.setRawLittleEndian(false);
+        }
+        else if (arg == "--mfe-version")
+        {
+            converter.setMfeVersion(QString(m_command[++i]).toInt()); //option value
+        }
+        else if (arg == "--threads")
+        {
+            cv::setNumThreads(QString(m_command[++i]).toInt()); //option value
+        }
         else if (QFile(arg).exists())
         {
             // -------------------------------------------
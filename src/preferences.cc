@@ -152,7 +152,11 @@ void Page::setLayout(QLayout *p_layout)
 
 // Display Page
 
-DisplayPage::DisplayPage(QWidget *p_parent) : Page(p_parent), m_statusBarCheckBox(nullptr), m_toolBarCheckBox(nullptr)
+DisplayPage::DisplayPage(QWidget *p_parent)
+    : Page(p_parent)
+    , m_statusBarCheckBox(nullptr)
+    , m_toolBarCheckBox(nullptr)
+    , m_historyMemoryLimit(new QSpinBox)
 {
     QGroupBox *displayApplicationGroupBox = new QGroupBox(tr("Application"));
     m_statusBarCheckBox                   = new QCheckBox(tr("Status bar"));
@@ -163,8 +167,17 @@ DisplayPage::DisplayPage(QWidget *p_parent) : Page(p_parent), m_statusBarCheckBo
     displayApplicationLayout->addWidget(m_toolBarCheckBox);
     displayApplicationGroupBox->setLayout(displayApplicationLayout);
 
+    QGroupBox *historyGroupBox = new QGroupBox(tr("Undo history"));
+    m_historyMemoryLimit->setRange(0, 65536);
+    m_historyMemoryLimit->setSuffix(tr(" MiB"));
+
+    QFormLayout *historyLayout = new QFormLayout;
+    historyLayout->addRow(tr("Memory limit:"), m_historyMemoryLimit);
+    historyGroupBox->setLayout(historyLayout);
+
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->addWidget(displayApplicationGroupBox);
+    mainLayout->addWidget(historyGroupBox);
     mainLayout->addStretch(1);
     setLayout(mainLayout);
 
@@ -178,6 +191,10 @@ void DisplayPage::readSettings()
     m_statusBarCheckBox->setChecked(settings.value("statusBar", true).toBool());
     m_toolBarCheckBox->setChecked(settings.value("toolBar", true).toBool());
     settings.endGroup();
+
+    settings.beginGroup("history");
+    m_historyMemoryLimit->setValue(settings.value("memory-limit", 512).toInt());
+    settings.endGroup();
 }
 
 void DisplayPage::writeSettings()
@@ -187,6 +204,10 @@ void DisplayPage::writeSettings()
     settings.setValue("statusBar", m_statusBarCheckBox->isChecked());
     settings.setValue("toolBar", m_toolBarCheckBox->isChecked());
     settings.endGroup();
+
+    settings.beginGroup("history");
+    settings.setValue("memory-limit", m_historyMemoryLimit->value());
+    settings.endGroup();
 }
 
 // Image Page
@@ -194,34 +215,62 @@ void DisplayPage::writeSettings()
 ImagePage::ImagePage(QWidget *p_parent)
     : Page(p_parent)
     , m_stretchDynamic(new QCheckBox)
+    , m_histogramBins(new QSpinBox)
     , m_rawType(new QComboBox)
     , m_rawWidth(new QSpinBox)
     , m_rawHeight(new QSpinBox)
     , m_rawLittleEndianByteOrder(new QCheckBox)
+    , m_rawBayerPattern(new QComboBox)
+    , m_rawHeaderSize(new QSpinBox)
 {
     QGroupBox *displayGroupBox = new QGroupBox(tr("Display options"));
 
     m_stretchDynamic->setEnabled(true);
 
+    // 0: one bin per value for integer data, up to 65536 bins
+    m_histogramBins->setRange(0, 65536);
+    m_histogramBins->setSpecialValueText(tr("Adaptive"));
+
     QFormLayout *displayLayout = new QFormLayout;
     displayLayout->addRow(tr("Stretch dynamic"), m_stretchDynamic);
+    displayLayout->addRow(tr("Histogram bins"), m_histogramBins);
     displayGroupBox->setLayout(displayLayout);
 
     QGroupBox *rawGroupBox = new QGroupBox(tr("Raw images"));
 
+    // same order as CRawFile::Type
     m_rawType->addItem(tr("16-bit unsigned"));
+    m_rawType->addItem(tr("8-bit unsigned"));
+    m_rawType->addItem(tr("10-bit unpacked"));
+    m_rawType->addItem(tr("10-bit packed (MIPI)"));
+    m_rawType->addItem(tr("12-bit unpacked"));
+    m_rawType->addItem(tr("12-bit packed (MIPI)"));
+    m_rawType->addItem(tr("14-bit unpacked"));
+    m_rawType->addItem(tr("14-bit packed (MIPI)"));
 
     m_rawWidth->setMaximum(20000);
 
     m_rawHeight->setMaximum(20000);
 
-    m_rawLittleEndianByteOrder->setEnabled(false);
+    m_rawLittleEndianByteOrder->setEnabled(true);
+
+    // same order as CRawFile::BayerPattern
+    m_rawBayerPattern->addItem(tr("None"));
+    m_rawBayerPattern->addItem(tr("RGGB"));
+    m_rawBayerPattern->addItem(tr("BGGR"));
+    m_rawBayerPattern->addItem(tr("GRBG"));
+    m_rawBayerPattern->addItem(tr("GBRG"));
+
+    m_rawHeaderSize->setMaximum(1 << 20);
+    m_rawHeaderSize->setSuffix(tr(" bytes"));
 
     QFormLayout *rawLayout = new QFormLayout;
     rawLayout->addRow(tr("Type"), m_rawType);
     rawLayout->addRow(tr("Width"), m_rawWidth);
     rawLayout->addRow(tr("Height"), m_rawHeight);
     rawLayout->addRow(tr("Little-endian byte order"), m_rawLittleEndianByteOrder);
+    rawLayout->addRow(tr("Bayer pattern"), m_rawBayerPattern);
+    rawLayout->addRow(tr("Header size"), m_rawHeaderSize);
     rawGroupBox->setLayout(rawLayout);
 
     QBoxLayout *mainLayout = new QVBoxLayout;
@@ -238,10 +287,13 @@ void ImagePage::readSettings()
     QSettings settings;
     settings.beginGroup("image");
     m_stretchDynamic->setChecked(settings.value("stretch-dynamic", true).toBool());
+    m_histogramBins->setValue(settings.value("histogram-bins", 0).toInt());
     m_rawType->setCurrentIndex(settings.value("raw-type", 0).toInt());
     m_rawWidth->setValue(settings.value("raw-width", 2160).toInt());
     m_rawHeight->setValue(settings.value("raw-height", 1944).toInt());
     m_rawLittleEndianByteOrder->setChecked(settings.value("raw-little-endian", true).toBool());
+    m_rawBayerPattern->setCurrentIndex(settings.value("raw-bayer-pattern", 0).toInt());
+    m_rawHeaderSize->setValue(settings.value("raw-header-size", 0).toInt());
     settings.endGroup();
 }
 
@@ -250,9 +302,12 @@ void ImagePage::writeSettings()
     QSettings settings;
     settings.beginGroup("image");
     settings.setValue("stretch-dynamic", m_stretchDynamic->isChecked());
+    settings.setValue("histogram-bins", m_histogramBins->value());
     settings.setValue("raw-type", m_rawType->currentIndex());
     settings.setValue("raw-width", m_rawWidth->value());
     settings.setValue("raw-height", m_rawHeight->value());
     settings.setValue("raw-little-endian", m_rawLittleEndianByteOrder->isChecked());
+    settings.setValue("raw-bayer-pattern", m_rawBayerPattern->currentIndex());
+    settings.setValue("raw-header-size", m_rawHeaderSize->value());
     settings.endGroup();
 }
@@ -123,6 +123,7 @@ private:
 
     QCheckBox *m_statusBarCheckBox;
     QCheckBox *m_toolBarCheckBox;
+    QSpinBox *m_historyMemoryLimit;
 };
 
 /**
@@ -142,9 +143,12 @@ private:
     void writeSettings() override;
 
     QCheckBox *m_stretchDynamic;
+    QSpinBox *m_histogramBins;
 
     QComboBox *m_rawType;
     QSpinBox *m_rawWidth;
     QSpinBox *m_rawHeight;
     QCheckBox *m_rawLittleEndianByteOrder;
+    QComboBox *m_rawBayerPattern;
+    QSpinBox *m_rawHeaderSize;
 };
@@ -0,0 +1,448 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#include "raw.hh"
+
+#include "mapped-file.hh"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include <vector>
+
+CRawFile::CRawFile()
+    : m_data()
+    , m_mapping()
+    , m_type(Type_Raw16)
+    , m_width(0)
+    , m_height(0)
+    , m_littleEndian(true)
+    , m_bayerPattern(Bayer_None)
+    , m_headerSize(0)
+{
+}
+
+CRawFile::~CRawFile() { }
+
+cv::Mat CRawFile::data() const
+{
+    return m_data;
+}
+
+void CRawFile::setData(const cv::Mat& p_mat)
+{
+    m_data = p_mat;
+}
+
+void CRawFile::setType(const int p_type)
+{
+    m_type = p_type;
+}
+
+void CRawFile::setSize(const int p_width, const int p_height)
+{
+    m_width  = p_width;
+    m_height = p_height;
+}
+
+void CRawFile::setLittleEndian(const bool p_value)
+{
+    m_littleEndian = p_value;
+}
+
+void CRawFile::setBayerPattern(const int p_pattern)
+{
+    m_bayerPattern = p_pattern;
+}
+
+void CRawFile::setHeaderSize(const qint64 p_bytes)
+{
+    m_headerSize = p_bytes;
+}
+
+std::shared_ptr<CMappedFile> CRawFile::mapping() const
+{
+    return m_mapping;
+}
+
+int CRawFile::bitDepth(const int p_type)
+{
+    switch (p_type)
+    {
+        case Type_Raw8:
+            return 8;
+
+        case Type_Raw10:
+        case Type_Raw10Packed:
+            return 10;
+
+        case Type_Raw12:
+        case Type_Raw12Packed:
+            return 12;
+
+        case Type_Raw14:
+        case Type_Raw14Packed:
+            return 14;
+
+        default:
+            return 16;
+    }
+}
+
+bool CRawFile::isPacked(const int p_type)
+{
+    return p_type == Type_Raw10Packed || p_type == Type_Raw12Packed || p_type == Type_Raw14Packed;
+}
+
+qint64 CRawFile::rowSize(const int p_type, const int p_width)
+{
+    if (isPacked(p_type))
+    {
+        return static_cast<qint64>(p_width) * bitDepth(p_type) / 8;
+    }
+    return static_cast<qint64>(p_width) * (bitDepth(p_type) == 8 ? 1 : 2);
+}
+
+int CRawFile::typeFromName(const QString& p_name)
+{
+    static const QHash<QString, int> s_types {{"raw8", Type_Raw8},
+                                              {"raw10", Type_Raw10},
+                                              {"raw10p", Type_Raw10Packed},
+                                              {"raw12", Type_Raw12},
+                                              {"raw12p", Type_Raw12Packed},
+                                              {"raw14", Type_Raw14},
+                                              {"raw14p", Type_Raw14Packed},
+                                              {"raw16", Type_Raw16}};
+    return s_types.value(p_name.toLower(), -1);
+}
+
+int CRawFile::bayerPatternFromName(const QString& p_name)
+{
+    static const QHash<QString, int> s_patterns {{"none", Bayer_None}, {"rggb", Bayer_RGGB}, {"bggr", Bayer_BGGR}, {"grbg", Bayer_GRBG}, {"gbrg", Bayer_GBRG}};
+    return s_patterns.value(p_name.toLower(), -1);
+}
+
+void CRawFile::unpackRow(const uchar* p_src, uchar* p_dst, const int p_width) const
+{
+    // Branch-free loops over fixed-size pixel groups so that the compiler can vectorize them
+    ushort* dst = reinterpret_cast<ushort*>(p_dst);
+    switch (m_type)
+    {
+        case Type_Raw8:
+            std::memcpy(p_dst, p_src, static_cast<size_t>(p_width));
+            break;
+
+        case Type_Raw10Packed:
+            for (int i = 0; i < p_width / 4; ++i)
+            {
+                const uchar* b = p_src + 5 * i;
+                ushort* p      = dst + 4 * i;
+                p[0]           = static_cast<ushort>((b[0] << 2) | (b[4] & 0x03));
+                p[1]           = static_cast<ushort>((b[1] << 2) | ((b[4] >> 2) & 0x03));
+                p[2]           = static_cast<ushort>((b[2] << 2) | ((b[4] >> 4) & 0x03));
+                p[3]           = static_cast<ushort>((b[3] << 2) | (b[4] >> 6));
+            }
+            break;
+
+        case Type_Raw12Packed:
+            for (int i = 0; i < p_width / 2; ++i)
+            {
+                const uchar* b = p_src + 3 * i;
+                ushort* p      = dst + 2 * i;
+                p[0]           = static_cast<ushort>((b[0] << 4) | (b[2] & 0x0F));
+                p[1]           = static_cast<ushort>((b[1] << 4) | (b[2] >> 4));
+            }
+            break;
+
+        case Type_Raw14Packed:
+            for (int i = 0; i < p_width / 4; ++i)
+            {
+                const uchar* b = p_src + 7 * i;
+                ushort* p      = dst + 4 * i;
+                p[0]           = static_cast<ushort>((b[0] << 6) | (b[4] & 0x3F));
+                p[1]           = static_cast<ushort>((b[1] << 6) | (b[4] >> 6) | ((b[5] & 0x0F) << 2));
+                p[2]           = static_cast<ushort>((b[2] << 6) | (b[5] >> 4) | ((b[6] & 0x03) << 4));
+                p[3]           = static_cast<ushort>((b[3] << 6) | (b[6] >> 2));
+            }
+            break;
+
+        default:
+            // unpacked 16-bit words
+            if (m_littleEndian)
+            {
+                qFromLittleEndian<quint16>(p_src, p_width, p_dst);
+            }
+            else
+            {
+                qFromBigEndian<quint16>(p_src, p_width, p_dst);
+            }
+            break;
+    }
+}
+
+void CRawFile::packRow(const uchar* p_src, uchar* p_dst, const int p_width) const
+{
+    const ushort* src = reinterpret_cast<const ushort*>(p_src);
+    switch (m_type)
+    {
+        case Type_Raw8:
+            std::memcpy(p_dst, p_src, static_cast<size_t>(p_width));
+            break;
+
+        case Type_Raw10Packed:
+            for (int i = 0; i < p_width / 4; ++i)
+            {
+                const ushort* p = src + 4 * i;
+                uchar* b        = p_dst + 5 * i;
+                b[0]            = static_cast<uchar>(p[0] >> 2);
+                b[1]            = static_cast<uchar>(p[1] >> 2);
+                b[2]            = static_cast<uchar>(p[2] >> 2);
+                b[3]            = static_cast<uchar>(p[3] >> 2);
+                b[4]            = static_cast<uchar>((p[0] & 0x03) | ((p[1] & 0x03) << 2) | ((p[2] & 0x03) << 4) | ((p[3] & 0x03) << 6));
+            }
+            break;
+
+        case Type_Raw12Packed:
+            for (int i = 0; i < p_width / 2; ++i)
+            {
+                const ushort* p = src + 2 * i;
+                uchar* b        = p_dst + 3 * i;
+                b[0]            = static_cast<uchar>(p[0] >> 4);
+                b[1]            = static_cast<uchar>(p[1] >> 4);
+                b[2]            = static_cast<uchar>((p[0] & 0x0F) | ((p[1] & 0x0F) << 4));
+            }
+            break;
+
+        case Type_Raw14Packed:
+            for (int i = 0; i < p_width / 4; ++i)
+            {
+                const ushort* p = src + 4 * i;
+                uchar* b        = p_dst + 7 * i;
+                b[0]            = static_cast<uchar>(p[0] >> 6);
+                b[1]            = static_cast<uchar>(p[1] >> 6);
+                b[2]            = static_cast<uchar>(p[2] >> 6);
+                b[3]            = static_cast<uchar>(p[3] >> 6);
+                b[4]            = static_cast<uchar>((p[0] & 0x3F) | ((p[1] & 0x03) << 6));
+                b[5]            = static_cast<uchar>(((p[1] >> 2) & 0x0F) | ((p[2] & 0x0F) << 4));
+                b[6]            = static_cast<uchar>(((p[2] >> 4) & 0x03) | ((p[3] & 0x3F) << 2));
+            }
+            break;
+
+        default:
+            // unpacked 16-bit words
+            if (m_littleEndian)
+            {
+                qToLittleEndian<quint16>(p_src, p_width, p_dst);
+            }
+            else
+            {
+                qToBigEndian<quint16>(p_src, p_width, p_dst);
+            }
+            break;
+    }
+}
+
+bool CRawFile::read(const QString& p_path, const bool p_keepMapping)
+{
+    static const QHash<int, int> s_demosaicCodes {{Bayer_RGGB, cv::COLOR_BayerBG2BGR},
+                                                  {Bayer_BGGR, cv::COLOR_BayerRG2BGR},
+                                                  {Bayer_GRBG, cv::COLOR_BayerGB2BGR},
+                                                  {Bayer_GBRG, cv::COLOR_BayerGR2BGR}};
+
+    m_data.release();
+    m_mapping.reset();
+
+    if (m_width <= 0 || m_height <= 0)
+    {
+        qWarning() << "Invalid raw image dimensions:" << m_width << "x" << m_height;
+        return false;
+    }
+
+    if ((m_type == Type_Raw12Packed && m_width % 2 != 0) || ((m_type == Type_Raw10Packed || m_type == Type_Raw14Packed) && m_width % 4 != 0))
+    {
+        qWarning() << "Invalid raw image width" << m_width << "for packed layout with" << bitDepth(m_type) << "bits per pixel";
+        return false;
+    }
+
+    auto mapping = std::make_shared<CMappedFile>(p_path);
+    if (!mapping->isValid())
+    {
+        qWarning() << "Can't open raw image file in read mode:" << p_path;
+        return false;
+    }
+
+    const qint64 rowBytes = rowSize(m_type, m_width);
+    const qint64 expected = m_headerSize + rowBytes * m_height;
+    if (mapping->size() < expected)
+    {
+        qWarning() << "Can't read raw image file:" << p_path;
+        qWarning() << "-- error: file is too small (expected" << expected << "bytes, got" << mapping->size() << ")";
+        return false;
+    }
+
+    try
+    {
+        const uchar* src = mapping->data() + m_headerSize;
+        const int depth  = (bitDepth(m_type) == 8) ? CV_8U : CV_16U;
+
+        const bool nativeByteOrder = (depth == CV_8U) || (m_littleEndian == (Q_BYTE_ORDER == Q_LITTLE_ENDIAN));
+        const bool aligned         = (reinterpret_cast<quintptr>(src) % CV_ELEM_SIZE(depth)) == 0;
+        if (p_keepMapping && !isPacked(m_type) && nativeByteOrder && aligned && m_bayerPattern == Bayer_None)
+        {
+            // Pixels can be used as is: point into the mapped file
+            m_data    = cv::Mat(m_height, m_width, depth, const_cast<uchar*>(src));
+            m_mapping = mapping;
+            return true;
+        }
+
+        cv::Mat image(m_height, m_width, depth);
+        cv::parallel_for_(cv::Range(0, m_height),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int r = p_range.start; r < p_range.end; ++r)
+                              {
+                                  unpackRow(src + r * rowBytes, image.ptr(r), m_width);
+                              }
+                          });
+
+        if (s_demosaicCodes.contains(m_bayerPattern))
+        {
+            cv::cvtColor(image, m_data, s_demosaicCodes.value(m_bayerPattern));
+        }
+        else
+        {
+            m_data = image;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "OpenCV error while reading raw image";
+        qWarning() << "file: " << p_path;
+        qWarning() << "error: " << e.what();
+        m_data.release();
+        return false;
+    }
+
+    return true;
+}
+
+cv::Mat CRawFile::mosaic(const cv::Mat& p_bgr) const
+{
+    // Channel sampled at (row % 2, col % 2) for each pattern, in BGR order
+    static const QHash<int, QVector<int>> s_channels {{Bayer_RGGB, {2, 1, 1, 0}}, {Bayer_BGGR, {0, 1, 1, 2}}, {Bayer_GRBG, {1, 2, 0, 1}}, {Bayer_GBRG, {1, 0, 2, 1}}};
+
+    const QVector<int> channels = s_channels.value(m_bayerPattern);
+
+    std::vector<cv::Mat> planes;
+    cv::split(p_bgr, planes);
+
+    cv::Mat result(p_bgr.rows, p_bgr.cols, p_bgr.depth());
+    for (int i = 0; i < 4; ++i)
+    {
+        const int y0 = i / 2;
+        const int x0 = i % 2;
+        for (int r = y0; r < result.rows; r += 2)
+        {
+            const cv::Mat plane = planes[channels[i]].row(r);
+            cv::Mat row         = result.row(r);
+            for (int c = x0; c < result.cols; c += 2)
+            {
+                std::memcpy(row.ptr(0, c), plane.ptr(0, c), result.elemSize());
+            }
+        }
+    }
+    return result;
+}
+
+bool CRawFile::write(const QString& p_path) const
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Can't write raw image file:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    try
+    {
+        cv::Mat image = m_data;
+        if (image.channels() == 3 && m_bayerPattern != Bayer_None)
+        {
+            image = mosaic(image);
+        }
+
+        if (image.channels() != 1)
+        {
+            qWarning() << "Can't write raw image file:" << p_path;
+            qWarning() << "-- error: raw images must have a single channel or a Bayer pattern";
+            return false;
+        }
+
+        // Saturate values to the number of bits of the layout
+        const int bits  = bitDepth(m_type);
+        const int depth = (bits == 8) ? CV_8U : CV_16U;
+        if (image.depth() != depth)
+        {
+            image.convertTo(image, depth);
+        }
+        if (bits != 8 && bits != 16)
+        {
+            cv::min(image, (1 << bits) - 1, image);
+        }
+
+        if ((m_type == Type_Raw12Packed && image.cols % 2 != 0) || ((m_type == Type_Raw10Packed || m_type == Type_Raw14Packed) && image.cols % 4 != 0))
+        {
+            qWarning() << "Can't write raw image file:" << p_path;
+            qWarning() << "-- error: invalid width" << image.cols << "for packed layout with" << bits << "bits per pixel";
+            return false;
+        }
+
+        const qint64 rowBytes = rowSize(m_type, image.cols);
+        std::vector<uchar> buffer(static_cast<size_t>(m_headerSize + rowBytes * image.rows), 0);
+        uchar* dst = buffer.data() + m_headerSize;
+        cv::parallel_for_(cv::Range(0, image.rows),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int r = p_range.start; r < p_range.end; ++r)
+                              {
+                                  packRow(image.ptr(r), dst + r * rowBytes, image.cols);
+                              }
+                          });
+
+        const qint64 size = static_cast<qint64>(buffer.size());
+        if (file.write(reinterpret_cast<const char*>(buffer.data()), size) != size)
+        {
+            qWarning() << "Can't write raw image file:" << p_path;
+            qWarning() << "-- error:" << file.errorString();
+            return false;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "OpenCV error while writing raw image";
+        qWarning() << "file: " << p_path;
+        qWarning() << "error: " << e.what();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include <QString>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+class CMappedFile;
+
+/**
+ * @class CRawFile
+ * @brief File format for raw sensor images
+ *
+ * A RAW file contains an optional header that is skipped
+ * followed by the pixel values of a single channel image, row after row.
+ *
+ * The following layouts are supported:
+ *
+ *  \li unpacked: one byte per pixel (8-bit) or one 16-bit word per pixel,
+ *      the value being stored in the least significant bits (10/12/14/16-bit)
+ *      with a configurable byte order
+ *  \li packed: MIPI CSI-2 layout where the most significant bits of a group of pixels
+ *      are stored first followed by the least significant bits (RAW10: 4 pixels in 5 bytes,
+ *      RAW12: 2 pixels in 3 bytes, RAW14: 4 pixels in 7 bytes)
+ *
+ * Pixels are unpacked to native depth (CV_8U for 8-bit images, CV_16U otherwise)
+ * and optionally demosaiced from a Bayer pattern into a BGR image.
+ */
+class CRawFile
+{
+public:
+    enum Type
+    {
+        Type_Raw16,
+        Type_Raw8,
+        Type_Raw10,
+        Type_Raw10Packed,
+        Type_Raw12,
+        Type_Raw12Packed,
+        Type_Raw14,
+        Type_Raw14Packed
+    };
+
+    enum BayerPattern
+    {
+        Bayer_None,
+        Bayer_RGGB,
+        Bayer_BGGR,
+        Bayer_GRBG,
+        Bayer_GBRG
+    };
+
+    CRawFile();
+    ~CRawFile();
+
+    cv::Mat data() const;
+    void setData(const cv::Mat& p_mat);
+
+    void setType(const int p_type);
+    void setSize(const int p_width, const int p_height);
+    void setLittleEndian(const bool p_value);
+    void setBayerPattern(const int p_pattern);
+    void setHeaderSize(const qint64 p_bytes);
+
+    /*!
+     * Reads the image through a memory mapping of the file.
+     * If \a p_keepMapping is \a true and the layout matches the native layout of CV_16U/CV_8U data,
+     * the matrix points into the mapping (see mapping()) instead of being copied.
+     */
+    bool read(const QString& p_path, const bool p_keepMapping = false);
+    bool write(const QString& p_path) const;
+
+    std::shared_ptr<CMappedFile> mapping() const;
+
+    /// Returns the number of significant bits per pixel of \a p_type.
+    static int bitDepth(const int p_type);
+
+    /// Returns \a true if \a p_type is a MIPI packed layout.
+    static bool isPacked(const int p_type);
+
+    /// Returns the number of bytes of a row of \a p_width pixels.
+    static qint64 rowSize(const int p_type, const int p_width);
+
+    /// Returns the type matching \a p_name (raw8, raw10, raw10p, ...), or -1.
+    static int typeFromName(const QString& p_name);
+
+    /// Returns the Bayer pattern matching \a p_name (rggb, bggr, grbg, gbrg), or -1.
+    static int bayerPatternFromName(const QString& p_name);
+
+private:
+    void unpackRow(const uchar* p_src, uchar* p_dst, const int p_width) const;
+    void packRow(const uchar* p_src, uchar* p_dst, const int p_width) const;
+
+    cv::Mat mosaic(const cv::Mat& p_bgr) const;
+
+private:
+    cv::Mat m_data;
+    std::shared_ptr<CMappedFile> m_mapping;
+
+    int m_type;
+    int m_width;
+    int m_height;
+    bool m_littleEndian;
+    int m_bayerPattern;
+    qint64 m_headerSize;
+};
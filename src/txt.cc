@@ -0,0 +1,482 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#include "txt.hh"
+
+#include "mapped-file.hh"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <vector>
+
+CTxtFile::CTxtFile() : m_data(), m_progressHandler(), m_tokenCount(0), m_rows(0), m_cols(0), m_values(nullptr) { }
+
+CTxtFile::~CTxtFile() { }
+
+cv::Mat CTxtFile::data() const
+{
+    return m_data;
+}
+
+void CTxtFile::setData(const cv::Mat& p_mat)
+{
+    m_data = p_mat;
+}
+
+bool CTxtFile::isSpace(const char p_char)
+{
+    return p_char == ' ' || p_char == '\n' || p_char == '\r' || p_char == '\t' || p_char == '\v' || p_char == '\f';
+}
+
+const char* CTxtFile::nextToken(const char* p_cursor, const char* p_end, const char** p_tokenEnd)
+{
+    while (p_cursor != p_end && isSpace(*p_cursor))
+    {
+        ++p_cursor;
+    }
+
+    const char* token = p_cursor;
+    while (p_cursor != p_end && !isSpace(*p_cursor))
+    {
+        ++p_cursor;
+    }
+
+    *p_tokenEnd = p_cursor;
+    return token;
+}
+
+template <typename T> bool CTxtFile::parseNumber(const char* p_begin, const char* p_end, T& p_value)
+{
+    // std::from_chars does not accept an explicit '+' sign
+    if (p_begin != p_end && *p_begin == '+')
+    {
+        ++p_begin;
+    }
+
+    const std::from_chars_result result = std::from_chars(p_begin, p_end, p_value);
+    return result.ec == std::errc() && result.ptr == p_end;
+}
+
+bool CTxtFile::parseToken(const char* p_begin, const char* p_end)
+{
+    const qint64 index = m_tokenCount++;
+
+    // first tokens contain the number of columns and rows of the matrix
+    if (index < 2)
+    {
+        int& dimension = (index == 0) ? m_cols : m_rows;
+        if (!parseNumber(p_begin, p_end, dimension) || dimension <= 0)
+        {
+            qWarning() << "CTxtFile::read invalid dimension:" << QByteArray(p_begin, static_cast<int>(p_end - p_begin));
+            return false;
+        }
+
+        if (index == 1)
+        {
+            m_data.create(m_rows, m_cols, CV_64FC1);
+            m_values = m_data.ptr<double>();
+        }
+        return true;
+    }
+
+    const qint64 valueIndex = index - 2;
+    if (valueIndex >= static_cast<qint64>(m_rows) * m_cols)
+    {
+        // extra values are ignored
+        return true;
+    }
+
+    if (!parseNumber(p_begin, p_end, m_values[valueIndex]))
+    {
+        qWarning() << "CTxtFile::read invalid value at index" << valueIndex << ":" << QByteArray(p_begin, static_cast<int>(p_end - p_begin));
+        return false;
+    }
+    return true;
+}
+
+bool CTxtFile::read(const QString& p_path)
+{
+    // Below this size, parsing is faster than splitting the work among threads
+    static const qint64 s_parallelSize = 4 << 20;
+
+    m_data.release();
+    m_tokenCount = 0;
+    m_rows       = 0;
+    m_cols       = 0;
+    m_values     = nullptr;
+
+    if (cv::getNumThreads() > 1 && QFileInfo(p_path).size() >= s_parallelSize)
+    {
+        CMappedFile file(p_path);
+        if (file.isValid())
+        {
+            if (!readMapped(file) || !checkTokenCount(p_path))
+            {
+                m_data.release();
+                return false;
+            }
+            return true;
+        }
+    }
+
+    if (!readStream(p_path) || !checkTokenCount(p_path))
+    {
+        m_data.release();
+        return false;
+    }
+    return true;
+}
+
+void CTxtFile::setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler)
+{
+    m_progressHandler = p_handler;
+}
+
+bool CTxtFile::reportProgress(const qint64 p_bytes, const qint64 p_total) const
+{
+    return !m_progressHandler || m_progressHandler(p_bytes, p_total);
+}
+
+bool CTxtFile::probe(const QString& p_path, CMatrixInfo& p_info)
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "CTxtFile::probe unable to open:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    // first tokens contain the number of columns and rows of the matrix
+    const QByteArray head = file.read(256);
+    const char* end       = head.constData() + head.size();
+
+    int dimensions[2]    = {0, 0};
+    const char* tokenEnd = head.constData();
+    for (int& dimension : dimensions)
+    {
+        const char* token = nextToken(tokenEnd, end, &tokenEnd);
+        if (token == tokenEnd || tokenEnd == end || !parseNumber(token, tokenEnd, dimension) || dimension <= 0)
+        {
+            qWarning() << QString("CTxtFile::probe file [%1] should start with COL ROW information").arg(p_path);
+            return false;
+        }
+    }
+
+    p_info.setSize(dimensions[1], dimensions[0]);
+    p_info.setType(CV_64FC1);
+    return true;
+}
+
+bool CTxtFile::readMapped(const CMappedFile& p_file)
+{
+    const char* begin = reinterpret_cast<const char*>(p_file.data());
+    const char* end   = begin + p_file.size();
+
+    try
+    {
+        // first tokens contain the number of columns and rows of the matrix
+        const char* cursor = begin;
+        for (int i = 0; i < 2; ++i)
+        {
+            const char* tokenEnd = nullptr;
+            const char* token    = nextToken(cursor, end, &tokenEnd);
+            if (token == tokenEnd)
+            {
+                return true; // reported by checkTokenCount()
+            }
+
+            if (!parseToken(token, tokenEnd))
+            {
+                return false;
+            }
+            cursor = tokenEnd;
+        }
+
+        // Split the values into byte ranges that start and stop on separators
+        const qint64 length = static_cast<qint64>(end - cursor);
+        const int rangeCount = static_cast<int>(qBound<qint64>(1, length / (1 << 20), cv::getNumThreads() * 4));
+
+        std::vector<const char*> bounds(rangeCount + 1, end);
+        bounds[0] = cursor;
+        for (int i = 1; i < rangeCount; ++i)
+        {
+            const char* bound = std::max(bounds[i - 1], cursor + length * i / rangeCount);
+            while (bound != end && !isSpace(*bound))
+            {
+                ++bound;
+            }
+            bounds[i] = bound;
+        }
+
+        // First pass: count the values of each range
+        std::vector<qint64> counts(rangeCount, 0);
+        cv::parallel_for_(cv::Range(0, rangeCount),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int i = p_range.start; i < p_range.end; ++i)
+                              {
+                                  qint64 count         = 0;
+                                  const char* tokenEnd = nullptr;
+                                  for (const char* token = nextToken(bounds[i], bounds[i + 1], &tokenEnd); token != tokenEnd;
+                                       token             = nextToken(tokenEnd, bounds[i + 1], &tokenEnd))
+                                  {
+                                      ++count;
+                                  }
+                                  counts[i] = count;
+                              }
+                          });
+
+        // Offset of each range in the matrix
+        std::vector<qint64> offsets(rangeCount + 1, 0);
+        for (int i = 0; i < rangeCount; ++i)
+        {
+            offsets[i + 1] = offsets[i] + counts[i];
+        }
+        m_tokenCount += offsets[rangeCount];
+
+        // the first pass reads the whole file once, the second one parses it again
+        if (!reportProgress(p_file.size() / 2, p_file.size()))
+        {
+            return false;
+        }
+
+        // Second pass: parse each range at its offset, ignoring extra values
+        const qint64 total = static_cast<qint64>(m_rows) * m_cols;
+        std::atomic<qint64> invalidIndex(-1);
+        cv::parallel_for_(cv::Range(0, rangeCount),
+                          [&](const cv::Range& p_range)
+                          {
+                              for (int i = p_range.start; i < p_range.end; ++i)
+                              {
+                                  qint64 index         = offsets[i];
+                                  const char* tokenEnd = nullptr;
+                                  for (const char* token = nextToken(bounds[i], bounds[i + 1], &tokenEnd); token != tokenEnd && index < total;
+                                       token             = nextToken(tokenEnd, bounds[i + 1], &tokenEnd))
+                                  {
+                                      if (!parseNumber(token, tokenEnd, m_values[index]))
+                                      {
+                                          invalidIndex = index;
+                                          return;
+                                      }
+                                      ++index;
+                                  }
+                              }
+                          });
+
+        if (invalidIndex >= 0)
+        {
+            qWarning() << "CTxtFile::read invalid value at index" << invalidIndex.load();
+            return false;
+        }
+
+        if (!reportProgress(p_file.size(), p_file.size()))
+        {
+            return false;
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "CTxtFile::read OpenCV error while reading:" << p_file.fileName();
+        qWarning() << " -- OpenCV error:" << e.what();
+        return false;
+    }
+
+    return true;
+}
+
+bool CTxtFile::readStream(const QString& p_path)
+{
+    static const qint64 s_chunkSize = 1 << 20;
+
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "CTxtFile::read unable to open:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    try
+    {
+        // The buffer holds the current chunk plus the incomplete token carried over from the previous one
+        std::vector<char> buffer(s_chunkSize);
+        qint64 size = 0;
+        bool atEnd  = false;
+
+        while (!atEnd)
+        {
+            if (size == static_cast<qint64>(buffer.size()))
+            {
+                // a single token does not fit in the buffer
+                buffer.resize(buffer.size() * 2);
+            }
+
+            const qint64 bytes = file.read(buffer.data() + size, static_cast<qint64>(buffer.size()) - size);
+            if (bytes < 0)
+            {
+                qWarning() << "CTxtFile::read unable to read:" << p_path;
+                qWarning() << "-- error:" << file.errorString();
+                return false;
+            }
+            atEnd = (bytes == 0);
+            size += bytes;
+
+            const char* begin = buffer.data();
+            const char* end   = begin + size;
+
+            // only parse complete tokens: stop at the last whitespace unless the whole file has been read
+            const char* limit = end;
+            if (!atEnd)
+            {
+                while (limit != begin && !isSpace(limit[-1]))
+                {
+                    --limit;
+                }
+            }
+
+            const char* tokenEnd = nullptr;
+            for (const char* token = nextToken(begin, limit, &tokenEnd); token != tokenEnd; token = nextToken(tokenEnd, limit, &tokenEnd))
+            {
+                if (!parseToken(token, tokenEnd))
+                {
+                    return false;
+                }
+            }
+
+            size = static_cast<qint64>(end - limit);
+            std::memmove(buffer.data(), limit, static_cast<size_t>(size));
+
+            if (!reportProgress(file.pos(), file.size()))
+            {
+                return false;
+            }
+        }
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "CTxtFile::read OpenCV error while reading:" << p_path;
+        qWarning() << " -- OpenCV error:" << e.what();
+        return false;
+    }
+
+    return true;
+}
+
+bool CTxtFile::checkTokenCount(const QString& p_path) const
+{
+    if (m_tokenCount < 2)
+    {
+        qWarning() << QString("CTxtFile::read file [%1] should start with COL ROW information").arg(p_path);
+        return false;
+    }
+
+    const qint64 expected = static_cast<qint64>(m_rows) * m_cols;
+    const qint64 values   = m_tokenCount - 2;
+    if (values < expected)
+    {
+        qWarning() << "CTxtFile::read not enough values in:" << p_path;
+        qWarning() << "-- expected" << expected << "values, got" << values;
+        return false;
+    }
+
+    if (values > expected)
+    {
+        qWarning() << "CTxtFile::read ignore" << values - expected << "extra values in:" << p_path;
+    }
+
+    return true;
+}
+
+bool CTxtFile::write(const QString& p_path) const
+{
+    static const size_t s_chunkSize = 1 << 20;
+
+    cv::Mat matrix;
+    try
+    {
+        m_data.convertTo(matrix, CV_64FC1);
+    }
+    catch (cv::Exception& e)
+    {
+        qWarning() << "CTxtFile::write unable to convert matrix to CV_64FC1";
+        qWarning() << " -- OpenCV error:" << e.what();
+        return false;
+    }
+
+    QFile file(p_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "CTxtFile::write unable to open:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    // Shortest representation that reads back to the exact same double
+    // is at most 24 characters, plus the separator
+    static const size_t s_maxTokenSize = 32;
+
+    std::vector<char> buffer(s_chunkSize + s_maxTokenSize);
+    char* cursor         = buffer.data();
+    char* const flushPos = buffer.data() + s_chunkSize;
+
+    auto flush = [&]() -> bool
+    {
+        const qint64 bytes = static_cast<qint64>(cursor - buffer.data());
+        cursor             = buffer.data();
+        return file.write(buffer.data(), bytes) == bytes;
+    };
+
+    // first line contains the number of columns and rows of the matrix
+    cursor    = std::to_chars(cursor, flushPos, matrix.cols).ptr;
+    *cursor++ = ' ';
+    cursor    = std::to_chars(cursor, flushPos, matrix.rows).ptr;
+    *cursor++ = '\n';
+
+    // second line contains matrix values
+    for (int r = 0; r < matrix.rows; ++r)
+    {
+        const double* row = matrix.ptr<double>(r);
+        for (int c = 0; c < matrix.cols; ++c)
+        {
+            cursor    = std::to_chars(cursor, cursor + s_maxTokenSize, row[c]).ptr;
+            *cursor++ = ' ';
+
+            if (cursor >= flushPos && !flush())
+            {
+                qWarning() << "CTxtFile::write unable to write:" << p_path;
+                qWarning() << "-- error:" << file.errorString();
+                return false;
+            }
+        }
+    }
+
+    *cursor++ = '\n';
+    if (!flush())
+    {
+        qWarning() << "CTxtFile::write unable to write:" << p_path;
+        qWarning() << "-- error:" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
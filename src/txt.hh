@@ -0,0 +1,87 @@
+// Copyright (C) 2026, Romain Goffe <romain.goffe@gmail.com>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// 02110-1301, USA.
+//******************************************************************************
+
+#pragma once
+
+#include "matrix-info.hh"
+
+#include <QString>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+class CMappedFile;
+
+/**
+ * @class CTxtFile
+ * @brief File format for matrices stored as plain text
+ *
+ * A TXT file has the following content:
+ *
+ *  \li the number of columns and rows of the matrix
+ *  \li the matrix values in row-major order
+ *
+ * Values are separated by any whitespace and may span several lines.
+ * The file is parsed by fixed-size chunks with std::from_chars,
+ * writing the values directly into the CV_64FC1 matrix buffer.
+ *
+ * Large files are memory mapped and split into byte ranges aligned on separators
+ * that are parsed concurrently (see cv::setNumThreads()):
+ * a first pass counts the values of each range to compute its offset in the matrix,
+ * a second pass parses each range at its offset.
+ */
+class CTxtFile
+{
+public:
+    CTxtFile();
+    ~CTxtFile();
+
+    cv::Mat data() const;
+    void setData(const cv::Mat& p_mat);
+
+    bool read(const QString& p_path);
+    bool write(const QString& p_path) const;
+
+    /// Reads the dimensions of the matrix stored in \a p_path without parsing its values.
+    static bool probe(const QString& p_path, CMatrixInfo& p_info);
+
+    /// Sets the function called with the number of bytes parsed and the file size during read(): returning false cancels the read.
+    void setProgressHandler(const std::function<bool(qint64, qint64)>& p_handler);
+
+private:
+    bool readStream(const QString& p_path);
+    bool readMapped(const CMappedFile& p_file);
+
+    bool parseToken(const char* p_begin, const char* p_end);
+    bool checkTokenCount(const QString& p_path) const;
+    bool reportProgress(const qint64 p_bytes, const qint64 p_total) const;
+
+    static bool isSpace(const char p_char);
+    static const char* nextToken(const char* p_cursor, const char* p_end, const char** p_tokenEnd);
+
+    template <typename T> static bool parseNumber(const char* p_begin, const char* p_end, T& p_value);
+
+private:
+    cv::Mat m_data;
+    std::function<bool(qint64, qint64)> m_progressHandler;
+
+    // parser state
+    qint64 m_tokenCount;
+    int m_rows;
+    int m_cols;
+    double* m_values;
+};